@@ -0,0 +1,640 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// plotBench - Measures the cost of the plotting library against a stand-in PlotGUI
+// that runs in this process (a loopback TCP receiver that just counts bytes).
+//
+// Usage: plotBench [--quick] [--csv]
+//    --quick  Fewer iterations. Good for a smoke test, too noisy for comparing builds.
+//    --csv    Print CSV rather than JSON.
+//
+// Every result is a (benchmark, parameter, value, unit) record, so the output of two
+// builds can be diffed / compared directly.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "smartPlotMessage.h"
+#include "sendMemoryToPlot.h"
+#include "timePlot.h"
+#include "plotMsgPack.h"
+#include "plotStats.h"
+#include "smartPlotTyped.h"
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+typedef struct
+{
+   std::string name;
+   std::string param;
+   double value;
+   const char* unit;
+}tBenchResult;
+
+// Loopback stand-in for the PlotGUI. Accepts any number of connections and counts
+// the bytes received.
+typedef struct
+{
+   int i_listenFd;
+   unsigned short s_port;
+   std::atomic<bool> b_stop;
+   std::atomic<unsigned long long> i_bytesReceived;
+   std::thread t_thread;
+}tBenchSink;
+
+//*****************************************************************************
+// Globals
+//*****************************************************************************
+static std::vector<tBenchResult> gt_results;
+static std::vector<std::string*> gt_names; // smartPlot keeps pointers to the plot / curve names.
+static bool g_quick = false;
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+static void bench_addResult(const std::string& name, const std::string& param, double value, const char* unit)
+{
+   tBenchResult result = {name, param, value, unit};
+   gt_results.push_back(result);
+   fprintf(stderr, "%-28s %-24s %14.3f %s\n", name.c_str(), param.c_str(), value, unit);
+}
+
+static const char* bench_name(const std::string& name)
+{
+   gt_names.push_back(new std::string(name));
+   return gt_names.back()->c_str();
+}
+
+static void bench_sinkThread(tBenchSink* sink)
+{
+   std::vector<struct pollfd> fds;
+   std::vector<char> buff(1 << 20);
+   struct pollfd listenPoll = {sink->i_listenFd, POLLIN, 0};
+   fds.push_back(listenPoll);
+
+   while(!sink->b_stop)
+   {
+      size_t index;
+      if(poll(&fds[0], fds.size(), 50) <= 0)
+      {
+         continue;
+      }
+
+      for(index = fds.size(); index-- > 0; )
+      {
+         if((fds[index].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+         {
+            continue;
+         }
+         if(index == 0)
+         {
+            int newFd = accept(sink->i_listenFd, NULL, NULL);
+            if(newFd >= 0)
+            {
+               struct pollfd newPoll = {newFd, POLLIN, 0};
+               fds.push_back(newPoll);
+            }
+         }
+         else
+         {
+            ssize_t numBytes = recv(fds[index].fd, &buff[0], buff.size(), 0);
+            if(numBytes > 0)
+            {
+               sink->i_bytesReceived += numBytes;
+            }
+            else
+            {
+               close(fds[index].fd);
+               fds.erase(fds.begin() + index);
+            }
+         }
+      }
+   }
+
+   for(size_t index = 0; index < fds.size(); ++index)
+   {
+      close(fds[index].fd);
+   }
+}
+
+static bool bench_sinkStart(tBenchSink* sink)
+{
+   struct sockaddr_in addr;
+   socklen_t addrLen = sizeof(addr);
+
+   sink->b_stop = false;
+   sink->i_bytesReceived = 0;
+   sink->i_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+   if(sink->i_listenFd < 0)
+   {
+      return false;
+   }
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port = 0; // Let the OS pick a port.
+   if( bind(sink->i_listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+       listen(sink->i_listenFd, 1024) != 0 ||
+       getsockname(sink->i_listenFd, (struct sockaddr*)&addr, &addrLen) != 0 )
+   {
+      close(sink->i_listenFd);
+      return false;
+   }
+   sink->s_port = ntohs(addr.sin_port);
+   sink->t_thread = std::thread(bench_sinkThread, sink);
+   return true;
+}
+
+static void bench_sinkStop(tBenchSink* sink)
+{
+   sink->b_stop = true;
+   sink->t_thread.join();
+   close(sink->i_listenFd);
+}
+
+// Waits until the sink has received everything the library has sent.
+static void bench_sinkWait(tBenchSink* sink, unsigned long long numBytes)
+{
+   PLOTTER_UINT_64 startTimeNs = plotStats_getTimeNs();
+   while(sink->i_bytesReceived < numBytes && plotStats_getTimeNs() - startTimeNs < 10000000000ull)
+   {
+      smartPlot_sleep(0.0001f);
+   }
+}
+
+static unsigned long long bench_bytesSent()
+{
+   tSendMemToPlotTotals totals;
+   sendMemoryToPlot_getTotals(&totals);
+   return totals.i_bytesSent;
+}
+
+//*****************************************************************************
+// Benchmarks
+//*****************************************************************************
+// Cost of writing samples into the circular buffers (update size of -1, so nothing is sent).
+static void bench_apiCost()
+{
+   static const int samplesPerCall[] = {1, 64};
+   const int plotSize = 1 << 16;
+   const unsigned int totalSamples = g_quick ? 400000 : 4000000;
+   double inData[2*64];
+   unsigned int callIndex;
+   unsigned int sizeIndex;
+
+   for(callIndex = 0; callIndex < 2*64; ++callIndex)
+   {
+      inData[callIndex] = callIndex;
+   }
+
+   for(sizeIndex = 0; sizeIndex < sizeof(samplesPerCall)/sizeof(samplesPerCall[0]); ++sizeIndex)
+   {
+      int numSamp = samplesPerCall[sizeIndex];
+      unsigned int numCalls = totalSamples / numSamp;
+      std::string param = "samples_per_call=" + std::to_string(numSamp);
+      PLOTTER_UINT_64 startTimeNs;
+
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < numCalls; ++callIndex)
+      {
+         smartPlot_1D(inData, E_FLOAT_64, numSamp, plotSize, -1, "bench", "api1D");
+      }
+      bench_addResult("smartPlot_1D", param, (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      // plotSize is a power of two (indexes wrap with a mask), this one isn't.
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < numCalls; ++callIndex)
+      {
+         smartPlot_1D(inData, E_FLOAT_64, numSamp, plotSize - 1, -1, "bench", "api1DNotPow2");
+      }
+      bench_addResult("smartPlot_1D_not_pow2", param, (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      {
+         smartPlot::Curve1D<double> curve(plotSize, -1, "bench", "apiTyped1D");
+         startTimeNs = plotStats_getTimeNs();
+         for(callIndex = 0; callIndex < numCalls; ++callIndex)
+         {
+            curve.write(inData, numSamp);
+         }
+         bench_addResult("Curve1D<double>::write", param, (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+      }
+
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < numCalls; ++callIndex)
+      {
+         smartPlot_2D(inData, E_FLOAT_64, inData, E_FLOAT_64, numSamp, plotSize, -1, "bench", "api2D");
+      }
+      bench_addResult("smartPlot_2D", param, (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < numCalls; ++callIndex)
+      {
+         smartPlot_interleaved(inData, E_FLOAT_64, numSamp, plotSize, -1, "bench", "apiIntX", "apiIntY");
+      }
+      bench_addResult("smartPlot_interleaved", param, (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      smartPlot_deallocate("bench", "api1D");
+      smartPlot_deallocate("bench", "apiTyped1D");
+      smartPlot_deallocate("bench", "api2D");
+      smartPlot_deallocate_interleaved("bench", "apiIntX", "apiIntY");
+   }
+
+   // The time plots write one sample per call, except for the batch call.
+   {
+      PLOTTER_UINT_64 startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < totalSamples; ++callIndex)
+      {
+         timePlot_1D(plotSize, -1, "bench", "apiTime1D");
+      }
+      bench_addResult("timePlot_1D", "samples_per_call=1", (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      if(smartPlot_enableFastClock(1))
+      {
+         startTimeNs = plotStats_getTimeNs();
+         for(callIndex = 0; callIndex < totalSamples; ++callIndex)
+         {
+            timePlot_1D(plotSize, -1, "bench", "apiFastTime1D");
+         }
+         bench_addResult("timePlot_1D", "fast_clock=1", (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+         smartPlot_enableFastClock(0);
+         smartPlot_deallocate("bench", "apiFastTime1D");
+      }
+
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < totalSamples; ++callIndex)
+      {
+         timePlot_2D(&inData[callIndex & 63], E_FLOAT_64, plotSize, -1, "bench", "apiTime2D");
+      }
+      bench_addResult("timePlot_2D", "samples_per_call=1", (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < totalSamples / 64; ++callIndex)
+      {
+         timePlot_2D_batch(inData, E_FLOAT_64, 64, plotSize, -1, "bench", "apiTimeBatch");
+      }
+      bench_addResult("timePlot_2D_batch", "samples_per_call=64", (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      smartPlot_deallocate("bench", "apiTime1D");
+      smartPlot_deallocate("bench", "apiTime2D");
+      smartPlot_deallocate("bench", "apiTimeBatch");
+   }
+
+   // Scoped timers, compared to just reading the clock twice.
+   {
+      tSmartPlotTime startTime;
+      tSmartPlotTime endTime;
+      PLOTTER_UINT_64 startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < totalSamples; ++callIndex)
+      {
+         smartPlot_getTime(&startTime);
+         smartPlot_getTime(&endTime);
+      }
+      bench_addResult("smartPlot_getTime x2", "samples_per_call=1", (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+
+      startTimeNs = plotStats_getTimeNs();
+      for(callIndex = 0; callIndex < totalSamples; ++callIndex)
+      {
+         TIME_PLOT_SCOPE(plotSize, -1, "bench", "apiScopeTimer");
+      }
+      bench_addResult("TIME_PLOT_SCOPE", "samples_per_call=1", (double)(plotStats_getTimeNs() - startTimeNs) / totalSamples, "ns/sample");
+   }
+}
+
+// First lap through a very large circular buffer (page faults / TLB misses), for each way of
+// allocating the buffer. The allocation is timed separately, since prefaulting moves cost there.
+static void bench_ringMemory()
+{
+   static const int ringMemFlags[] = {-1, SMART_PLOT_RING_MEM_THP, SMART_PLOT_RING_MEM_THP | SMART_PLOT_RING_MEM_POPULATE, SMART_PLOT_RING_MEM_MIRROR | SMART_PLOT_RING_MEM_POPULATE};
+   static const char* ringMemNames[] = {"malloc", "mmap_thp", "mmap_thp_populate", "mirror_populate"};
+   const int plotSize = g_quick ? (1 << 22) : (1 << 24);
+   const int samplesPerCall = 64;
+   double inData[64];
+   unsigned int flagIndex;
+   int sampIndex;
+
+   for(sampIndex = 0; sampIndex < samplesPerCall; ++sampIndex)
+   {
+      inData[sampIndex] = sampIndex;
+   }
+
+   for(flagIndex = 0; flagIndex < sizeof(ringMemFlags)/sizeof(ringMemFlags[0]); ++flagIndex)
+   {
+      std::string param = std::string("mem=") + ringMemNames[flagIndex];
+      PLOTTER_UINT_64 startTimeNs;
+
+      smartPlot_configureRingMemory(ringMemFlags[flagIndex] < 0 ? 0 : 1, ringMemFlags[flagIndex] < 0 ? 0 : ringMemFlags[flagIndex]);
+
+      startTimeNs = plotStats_getTimeNs();
+      smartPlot_1D(inData, E_FLOAT_64, 0, plotSize, -1, "bench", "apiRingMem");
+      bench_addResult("ring_alloc", param, (double)(plotStats_getTimeNs() - startTimeNs) * 1e-6, "ms");
+
+      startTimeNs = plotStats_getTimeNs();
+      for(sampIndex = 0; sampIndex < plotSize; sampIndex += samplesPerCall)
+      {
+         smartPlot_1D(inData, E_FLOAT_64, samplesPerCall, plotSize, -1, "bench", "apiRingMem");
+      }
+      bench_addResult("ring_first_lap", param, (double)(plotStats_getTimeNs() - startTimeNs) / plotSize, "ns/sample");
+
+      startTimeNs = plotStats_getTimeNs();
+      for(sampIndex = 0; sampIndex < plotSize; sampIndex += samplesPerCall)
+      {
+         smartPlot_1D(inData, E_FLOAT_64, samplesPerCall, plotSize, -1, "bench", "apiRingMem");
+      }
+      bench_addResult("ring_second_lap", param, (double)(plotStats_getTimeNs() - startTimeNs) / plotSize, "ns/sample");
+
+      smartPlot_deallocate("bench", "apiRingMem");
+   }
+   smartPlot_configureRingMemory(0, 0);
+}
+
+// Cost of smartPlot_flush_all (one group message) as the number of curves grows.
+static void bench_flushCost(tBenchSink* sink)
+{
+   static const unsigned int curveCounts[] = {1, 10, 100, 1000};
+   const unsigned int numFlushes = g_quick ? 20 : 200;
+   const int samplesPerFlush = 64;
+   float inData[64];
+   unsigned int countIndex;
+
+   memset(inData, 0, sizeof(inData));
+
+   for(countIndex = 0; countIndex < sizeof(curveCounts)/sizeof(curveCounts[0]); ++countIndex)
+   {
+      unsigned int numCurves = curveCounts[countIndex];
+      std::vector<const char*> curveNames;
+      PLOTTER_UINT_64 flushTimeNs = 0;
+      unsigned long long bytesBefore = bench_bytesSent();
+      unsigned long long bytesReceivedBefore = sink->i_bytesReceived;
+      unsigned int flushIndex;
+      unsigned int curveIndex;
+
+      if(g_quick && numCurves > 100)
+      {
+         continue;
+      }
+
+      for(curveIndex = 0; curveIndex < numCurves; ++curveIndex)
+      {
+         curveNames.push_back(bench_name("flush" + std::to_string(curveIndex)));
+      }
+
+      for(flushIndex = 0; flushIndex < numFlushes; ++flushIndex)
+      {
+         PLOTTER_UINT_64 startTimeNs;
+         for(curveIndex = 0; curveIndex < numCurves; ++curveIndex)
+         {
+            smartPlot_1D(inData, E_FLOAT_32, samplesPerFlush, 1024, -1, "benchFlush", curveNames[curveIndex]);
+         }
+         startTimeNs = plotStats_getTimeNs();
+         smartPlot_flush_all();
+         flushTimeNs += plotStats_getTimeNs() - startTimeNs;
+      }
+      bench_sinkWait(sink, bytesReceivedBefore + (bench_bytesSent() - bytesBefore));
+
+      bench_addResult("flush_all", "curves=" + std::to_string(numCurves), (double)flushTimeNs / numFlushes, "ns/flush");
+      bench_addResult("flush_all_per_curve", "curves=" + std::to_string(numCurves), (double)flushTimeNs / numFlushes / numCurves, "ns/curve");
+
+      for(curveIndex = 0; curveIndex < numCurves; ++curveIndex)
+      {
+         smartPlot_deallocate("benchFlush", curveNames[curveIndex]);
+      }
+   }
+}
+
+// Same as bench_flushCost, but the messages go to the null sink, so the time to send
+// them over TCP isn't included.
+static void bench_flushCostNullSink(tBenchSink* sink)
+{
+   const unsigned int numCurves = 100;
+   const unsigned int numFlushes = g_quick ? 20 : 200;
+   const int samplesPerFlush = 64;
+   float inData[64];
+   std::vector<const char*> curveNames;
+   PLOTTER_UINT_64 flushTimeNs = 0;
+   unsigned int flushIndex;
+   unsigned int curveIndex;
+
+   memset(inData, 0, sizeof(inData));
+   smartPlot_networkConfigure("null://", sink->s_port);
+
+   for(curveIndex = 0; curveIndex < numCurves; ++curveIndex)
+   {
+      curveNames.push_back(bench_name("nullSink" + std::to_string(curveIndex)));
+   }
+
+   for(flushIndex = 0; flushIndex < numFlushes; ++flushIndex)
+   {
+      PLOTTER_UINT_64 startTimeNs;
+      for(curveIndex = 0; curveIndex < numCurves; ++curveIndex)
+      {
+         smartPlot_1D(inData, E_FLOAT_32, samplesPerFlush, 1024, -1, "benchNullSink", curveNames[curveIndex]);
+      }
+      startTimeNs = plotStats_getTimeNs();
+      smartPlot_flush_all();
+      flushTimeNs += plotStats_getTimeNs() - startTimeNs;
+   }
+
+   bench_addResult("flush_all_null_sink", "curves=" + std::to_string(numCurves), (double)flushTimeNs / numFlushes, "ns/flush");
+
+   for(curveIndex = 0; curveIndex < numCurves; ++curveIndex)
+   {
+      smartPlot_deallocate("benchNullSink", curveNames[curveIndex]);
+   }
+   smartPlot_networkConfigure("127.0.0.1", sink->s_port);
+}
+
+// Message generation throughput for each data type. The messages are put in a group,
+// so the time to send them is not included (the group is sent outside of the timing).
+static void bench_encoderThroughput(tBenchSink* sink)
+{
+   static const char* typeNames[] = { "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64",
+                                      "float32", "float64", "time64", "time128", "float16", "invalid", "timeNsDelta" };
+   const unsigned int numSamples = 1 << 16;
+   const unsigned int msgsPerGroup = 16;
+   const unsigned long long bytesToEncode = g_quick ? (32ull << 20) : (512ull << 20);
+   int dataType;
+
+   for(dataType = 0; dataType < E_DATA_TYPE_END; ++dataType)
+   {
+      tSendMemToPlot plot;
+      unsigned int memberSize = PLOT_DATA_TYPE_SIZES[dataType];
+      unsigned long long numBytes = 0;
+      PLOTTER_UINT_64 encodeTimeNs = 0;
+      char* mem;
+      if(!isPlotDataTypeValid((ePlotDataTypes)dataType))
+      {
+         continue;
+      }
+      mem = (char*)calloc(numSamples, memberSize);
+      if(mem == NULL)
+      {
+         continue;
+      }
+
+      memset(&plot, 0, sizeof(plot));
+      plot.t_plotMem.b_arrayOfStructs = FALSE;
+      plot.t_plotMem.b_interleaved = FALSE;
+      plot.t_plotMem.e_dataType = (ePlotDataTypes)dataType;
+      plot.t_plotMem.e_plotDim = E_PLOT_1D;
+      plot.t_plotMem.i_bytesBetweenValues = memberSize;
+      plot.t_plotMem.i_dataSizeBytes = memberSize;
+      plot.t_plotMem.i_numSamples = numSamples;
+      plot.t_plotMem.pc_memory = mem;
+      sendMemoryToPlot_Init(&plot, "127.0.0.1", sink->s_port, FALSE, "benchEncode", typeNames[dataType]);
+
+      while(numBytes < bytesToEncode)
+      {
+         PLOTTER_UINT_64 startTimeNs;
+         unsigned int msgIndex;
+
+         plotMsgGroupStart();
+         startTimeNs = plotStats_getTimeNs();
+         for(msgIndex = 0; msgIndex < msgsPerGroup; ++msgIndex)
+         {
+            sendMemoryToPlot_Create1D(&plot);
+         }
+         encodeTimeNs += plotStats_getTimeNs() - startTimeNs;
+         plotMsgGroupEnd();
+
+         numBytes += (unsigned long long)msgsPerGroup * numSamples * memberSize;
+      }
+
+      bench_addResult("encode_create1D", std::string("type=") + typeNames[dataType], (double)numBytes / encodeTimeNs, "GB/s");
+
+      sendMemoryToPlot_Release(&plot);
+      free(mem);
+   }
+}
+
+// Samples written on this thread and sent from this thread over TCP to the sink.
+static void bench_endToEnd(tBenchSink* sink)
+{
+   static const int updateSizes[] = {256, 4096};
+   const unsigned int totalSamples = g_quick ? 2000000 : 32000000;
+   const int samplesPerCall = 256;
+   float inData[256];
+   unsigned int sizeIndex;
+
+   memset(inData, 0, sizeof(inData));
+
+   for(sizeIndex = 0; sizeIndex < sizeof(updateSizes)/sizeof(updateSizes[0]); ++sizeIndex)
+   {
+      const char* curveName = bench_name("e2e" + std::to_string(updateSizes[sizeIndex]));
+      std::string param = "update_size=" + std::to_string(updateSizes[sizeIndex]);
+      unsigned long long bytesBefore = bench_bytesSent();
+      unsigned long long bytesReceivedBefore = sink->i_bytesReceived;
+      unsigned long long numBytes;
+      PLOTTER_UINT_64 startTimeNs = plotStats_getTimeNs();
+      double elapsedSec;
+      unsigned int callIndex;
+
+      for(callIndex = 0; callIndex < totalSamples / samplesPerCall; ++callIndex)
+      {
+         smartPlot_1D(inData, E_FLOAT_32, samplesPerCall, 1 << 16, updateSizes[sizeIndex], "benchE2E", curveName);
+      }
+      smartPlot_flush_all();
+      numBytes = bench_bytesSent() - bytesBefore;
+      bench_sinkWait(sink, bytesReceivedBefore + numBytes);
+      elapsedSec = (plotStats_getTimeNs() - startTimeNs) * 1e-9;
+
+      bench_addResult("tcp_end_to_end", param, totalSamples / elapsedSec * 1e-6, "Msamples/s");
+      bench_addResult("tcp_end_to_end_bytes", param, numBytes / elapsedSec * 1e-6, "MB/s");
+
+      smartPlot_deallocate("benchE2E", curveName);
+   }
+}
+
+static void bench_print(bool csv)
+{
+   size_t index;
+   if(csv)
+   {
+      printf("benchmark,param,value,unit\n");
+      for(index = 0; index < gt_results.size(); ++index)
+      {
+         const tBenchResult* result = &gt_results[index];
+         printf("%s,%s,%.6g,%s\n", result->name.c_str(), result->param.c_str(), result->value, result->unit);
+      }
+   }
+   else
+   {
+      printf("{\n  \"quick\": %s,\n  \"results\": [\n", g_quick ? "true" : "false");
+      for(index = 0; index < gt_results.size(); ++index)
+      {
+         const tBenchResult* result = &gt_results[index];
+         printf( "    {\"benchmark\": \"%s\", \"param\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}%s\n",
+                 result->name.c_str(), result->param.c_str(), result->value, result->unit,
+                 index + 1 < gt_results.size() ? "," : "" );
+      }
+      printf("  ]\n}\n");
+   }
+}
+
+int main(int argc, char** argv)
+{
+   tBenchSink sink;
+   bool csv = false;
+   int argIndex;
+
+   for(argIndex = 1; argIndex < argc; ++argIndex)
+   {
+      if(strcmp(argv[argIndex], "--quick") == 0)
+      {
+         g_quick = true;
+      }
+      else if(strcmp(argv[argIndex], "--csv") == 0)
+      {
+         csv = true;
+      }
+      else
+      {
+         fprintf(stderr, "Usage: %s [--quick] [--csv]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if(!bench_sinkStart(&sink))
+   {
+      fprintf(stderr, "Failed to start the loopback sink\n");
+      return 1;
+   }
+   smartPlot_networkConfigure("127.0.0.1", sink.s_port);
+
+   bench_apiCost();
+   bench_ringMemory();
+   bench_flushCost(&sink);
+   bench_flushCostNullSink(&sink);
+   bench_encoderThroughput(&sink);
+   bench_endToEnd(&sink);
+
+   bench_sinkStop(&sink);
+   bench_print(csv);
+   return 0;
+}
@@ -0,0 +1,534 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// plotMockServer - Stand-in for the PlotGUI. Accepts the plot message wire format
+// (group messages and Create / Update 1D / 2D messages), rebuilds the contents of every
+// curve and reports throughput and message counts. Used for testing transport / encoding
+// changes and as a receiver that will not be the bottleneck when benchmarking the client.
+//
+// Usage: plotMockServer [--port N] [--threads N] [--seconds N] [--report-ms N] [--no-rebuild]
+//    --port       TCP port to listen on (default 2000).
+//    --threads    Number of epoll threads. Connections are spread round robin between them.
+//                 Each thread keeps its own copy of the curves it has received.
+//    --seconds    Exit after this many seconds (default 0, run until SIGINT / SIGTERM).
+//    --report-ms  How often to print throughput to stderr (default 1000, 0 to disable).
+//    --no-rebuild Only decode the messages, do not keep the curve contents.
+//
+// On exit a JSON summary (totals and every curve) is printed to stdout.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "smartPlotMessage.h"
+#include "plotMsgUnpack.h"
+#include "plotStats.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define MOCK_RECV_BUFF_SIZE (4*1024*1024) // Initial receive buffer size for each connection.
+#define MOCK_MAX_MSG_SIZE (1024u*1024u*1024u) // Anything bigger is treated as a corrupt stream.
+#define MOCK_MAX_EVENTS (64)
+#define MOCK_MAX_THREADS (64)
+
+//*****************************************************************************
+// Types
+//*****************************************************************************
+typedef struct
+{
+   std::string plotName;
+   std::string curveName;
+   PLOTTER_BOOL b_is2D;
+   int i_xType;
+   int i_yType;
+   std::vector<char> ac_x; // Only used for 2D curves.
+   std::vector<char> ac_y;
+   unsigned long long i_numCreates;
+   unsigned long long i_numUpdates;
+   unsigned long long i_samplesReceived;
+}tMockCurve;
+
+typedef struct
+{
+   int i_fd;
+   std::vector<char> ac_buff;
+   size_t i_readPos;
+   size_t i_writePos;
+}tMockConn;
+
+typedef struct
+{
+   int i_epollFd;
+   std::thread t_thread;
+   std::unordered_map<std::string, tMockCurve> t_curves;
+
+   // Written by the worker, read by the reporting thread.
+   std::atomic<unsigned long long> i_bytes;
+   std::atomic<unsigned long long> i_groupMsgs;
+   std::atomic<unsigned long long> i_plotMsgs;
+   std::atomic<unsigned long long> i_errors;
+   std::atomic<unsigned long long> i_connections;
+}tMockWorker;
+
+//*****************************************************************************
+// Globals
+//*****************************************************************************
+static volatile sig_atomic_t g_stop = 0;
+static PLOTTER_BOOL g_rebuild = TRUE;
+
+//*****************************************************************************
+// Decoding
+//*****************************************************************************
+static void mock_signalHandler(int sig)
+{
+   (void)sig;
+   g_stop = 1;
+}
+
+// Copies numSamp samples into dst starting at sample startIndex, growing dst if needed.
+// srcStride is the number of bytes between samples in src (i.e. for interleaved data).
+static void mock_writeSamples(std::vector<char>* dst, unsigned int sampSize, unsigned int startIndex, const char* src, unsigned int numSamp, unsigned int srcStride)
+{
+   size_t endByte = (size_t)(startIndex + numSamp) * sampSize;
+   if(dst->size() < endByte)
+   {
+      dst->resize(endByte);
+   }
+   if(srcStride == sampSize)
+   {
+      memcpy(&(*dst)[(size_t)startIndex * sampSize], src, (size_t)numSamp * sampSize);
+   }
+   else
+   {
+      unsigned int sampIndex;
+      for(sampIndex = 0; sampIndex < numSamp; ++sampIndex)
+      {
+         memcpy(&(*dst)[(size_t)(startIndex + sampIndex) * sampSize], src + (size_t)sampIndex * srcStride, sampSize);
+      }
+   }
+}
+
+// Same as mock_writeSamples, for the samples of one axis of a message.
+static void mock_writeAxis(std::vector<char>* dst, ePlotDataTypes dataType, const tPlotMsgView* view, const char* points, unsigned int pointsSize, unsigned int stride)
+{
+   if(isPlotDataTypePacked(dataType))
+   {
+      std::vector<PLOTTER_UINT_64> timesNs(view->numSamp);
+      unpackPlotMsgTimeDeltas(points, pointsSize, view->numSamp, timesNs.data());
+      mock_writeSamples(dst, sizeof(PLOTTER_UINT_64), view->sampleStartIndex, (const char*)timesNs.data(), view->numSamp, sizeof(PLOTTER_UINT_64));
+      return;
+   }
+   mock_writeSamples(dst, PLOT_DATA_TYPE_SIZES[dataType], view->sampleStartIndex, points, view->numSamp, stride);
+}
+
+// Applies a decoded Create / Update message to its curve.
+static void mock_rebuildCurve(tMockWorker* worker, const tPlotMsgView* view)
+{
+   std::string key = std::string(view->plotName) + '\0' + view->curveName;
+   tMockCurve& curve = worker->t_curves[key];
+   PLOTTER_BOOL is2D = view->xPoints != NULL;
+
+   if(curve.plotName.empty() && curve.curveName.empty())
+   {
+      curve.plotName = view->plotName;
+      curve.curveName = view->curveName;
+   }
+   if(view->action == E_CREATE_1D_PLOT || view->action == E_CREATE_2D_PLOT)
+   {
+      // Create replaces the whole curve.
+      curve.ac_x.clear();
+      curve.ac_y.clear();
+      curve.i_numCreates++;
+   }
+   else
+   {
+      curve.i_numUpdates++;
+   }
+   curve.b_is2D = is2D;
+   curve.i_xType = view->xAxisType;
+   curve.i_yType = view->yAxisType;
+   curve.i_samplesReceived += view->numSamp;
+
+   if(is2D)
+   {
+      mock_writeAxis(&curve.ac_x, view->xAxisType, view, view->xPoints, view->xPointsSize, view->xStride);
+   }
+   mock_writeAxis(&curve.ac_y, view->yAxisType, view, view->yPoints, view->yPointsSize, view->yStride);
+}
+
+// Decodes one complete top level message (which may be a group of messages).
+static PLOTTER_BOOL mock_decodeMsg(tMockWorker* worker, const char* msg, unsigned int msgSize)
+{
+   tPlotMsgReader reader;
+   tPlotMsgView view;
+   ePlotUnpackResult result;
+   unsigned long long numPlotMsgs = 0;
+
+   plotMsgReaderInit(&reader, msg, msgSize);
+   while((result = plotMsgReaderNext(&reader, &view)) == E_UNPACK_OK)
+   {
+      numPlotMsgs++;
+      if(g_rebuild)
+      {
+         mock_rebuildCurve(worker, &view);
+      }
+   }
+   worker->i_plotMsgs.fetch_add(numPlotMsgs, std::memory_order_relaxed);
+   worker->i_groupMsgs.fetch_add(reader.numGroups, std::memory_order_relaxed);
+
+   // The whole message was passed in, so running out of messages must be right at the end.
+   return result == E_UNPACK_INCOMPLETE && reader.idx == msgSize;
+}
+
+//*****************************************************************************
+// Networking
+//*****************************************************************************
+static void mock_closeConn(tMockWorker* worker, tMockConn* conn)
+{
+   epoll_ctl(worker->i_epollFd, EPOLL_CTL_DEL, conn->i_fd, NULL);
+   close(conn->i_fd);
+   delete conn;
+}
+
+// Reads everything available on the connection and decodes all the complete messages.
+// Returns FALSE if the connection should be closed.
+static PLOTTER_BOOL mock_readConn(tMockWorker* worker, tMockConn* conn)
+{
+   while(1)
+   {
+      ssize_t numBytes;
+
+      // Make room for more data. Partial messages are moved to the front of the buffer.
+      if(conn->i_writePos == conn->ac_buff.size())
+      {
+         if(conn->i_readPos > 0)
+         {
+            memmove(&conn->ac_buff[0], &conn->ac_buff[conn->i_readPos], conn->i_writePos - conn->i_readPos);
+            conn->i_writePos -= conn->i_readPos;
+            conn->i_readPos = 0;
+         }
+         else
+         {
+            conn->ac_buff.resize(conn->ac_buff.size() * 2);
+         }
+      }
+
+      numBytes = recv(conn->i_fd, &conn->ac_buff[conn->i_writePos], conn->ac_buff.size() - conn->i_writePos, 0);
+      if(numBytes == 0)
+      {
+         return FALSE;
+      }
+      else if(numBytes < 0)
+      {
+         return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+      }
+      conn->i_writePos += numBytes;
+      worker->i_bytes.fetch_add(numBytes, std::memory_order_relaxed);
+
+      // Decode all the complete messages.
+      while(conn->i_writePos - conn->i_readPos >= PLOT_MSG_HEADER_SIZE)
+      {
+         const char* msg = &conn->ac_buff[conn->i_readPos];
+         ePlotAction action;
+         PLOT_MSG_SIZE_TYPE msgSize;
+         if(unpackPlotMsgHeader(msg, PLOT_MSG_HEADER_SIZE, &action, &msgSize) != E_UNPACK_OK || msgSize > MOCK_MAX_MSG_SIZE)
+         {
+            // Can't find the next message boundary. Drop the connection.
+            worker->i_errors.fetch_add(1, std::memory_order_relaxed);
+            return FALSE;
+         }
+         if(conn->i_writePos - conn->i_readPos < msgSize)
+         {
+            if(msgSize > conn->ac_buff.size())
+            {
+               conn->ac_buff.resize(msgSize);
+            }
+            break;
+         }
+         if(!mock_decodeMsg(worker, msg, msgSize))
+         {
+            worker->i_errors.fetch_add(1, std::memory_order_relaxed);
+         }
+         conn->i_readPos += msgSize;
+      }
+      if(conn->i_readPos == conn->i_writePos)
+      {
+         conn->i_readPos = conn->i_writePos = 0;
+      }
+   }
+}
+
+static void mock_workerThread(tMockWorker* worker)
+{
+   struct epoll_event events[MOCK_MAX_EVENTS];
+
+   while(!g_stop)
+   {
+      int numEvents = epoll_wait(worker->i_epollFd, events, MOCK_MAX_EVENTS, 100);
+      int eventIndex;
+      for(eventIndex = 0; eventIndex < numEvents; ++eventIndex)
+      {
+         tMockConn* conn = (tMockConn*)events[eventIndex].data.ptr;
+         if(!mock_readConn(worker, conn))
+         {
+            mock_closeConn(worker, conn);
+         }
+      }
+   }
+}
+
+static int mock_listen(unsigned short port)
+{
+   struct sockaddr_in addr;
+   int reuse = 1;
+   int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+   if(listenFd < 0)
+   {
+      return -1;
+   }
+   setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   addr.sin_port = htons(port);
+   if(bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 1024) != 0)
+   {
+      close(listenFd);
+      return -1;
+   }
+   return listenFd;
+}
+
+//*****************************************************************************
+// Reporting
+//*****************************************************************************
+static unsigned long long mock_sum(tMockWorker* workers, unsigned int numWorkers, std::atomic<unsigned long long> tMockWorker::*counter)
+{
+   unsigned long long total = 0;
+   unsigned int workerIndex;
+   for(workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+   {
+      total += (workers[workerIndex].*counter).load(std::memory_order_relaxed);
+   }
+   return total;
+}
+
+static void mock_printJsonStr(const std::string& str)
+{
+   size_t index;
+   putchar('"');
+   for(index = 0; index < str.size(); ++index)
+   {
+      unsigned char c = (unsigned char)str[index];
+      if(c == '"' || c == '\\')
+         printf("\\%c", c);
+      else if(c < 0x20)
+         printf("\\u%04x", c);
+      else
+         putchar(c);
+   }
+   putchar('"');
+}
+
+static void mock_printSummary(tMockWorker* workers, unsigned int numWorkers, double elapsedSec)
+{
+   unsigned long long numBytes = mock_sum(workers, numWorkers, &tMockWorker::i_bytes);
+   unsigned int workerIndex;
+   PLOTTER_BOOL first = TRUE;
+
+   printf("{\n");
+   printf("  \"seconds\": %.3f,\n", elapsedSec);
+   printf("  \"bytes\": %llu,\n", numBytes);
+   printf("  \"mbPerSec\": %.3f,\n", elapsedSec > 0 ? numBytes / elapsedSec * 1e-6 : 0.0);
+   printf("  \"connections\": %llu,\n", mock_sum(workers, numWorkers, &tMockWorker::i_connections));
+   printf("  \"groupMsgs\": %llu,\n", mock_sum(workers, numWorkers, &tMockWorker::i_groupMsgs));
+   printf("  \"plotMsgs\": %llu,\n", mock_sum(workers, numWorkers, &tMockWorker::i_plotMsgs));
+   printf("  \"errors\": %llu,\n", mock_sum(workers, numWorkers, &tMockWorker::i_errors));
+   printf("  \"curves\": [");
+   for(workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+   {
+      std::unordered_map<std::string, tMockCurve>::const_iterator iter;
+      for(iter = workers[workerIndex].t_curves.begin(); iter != workers[workerIndex].t_curves.end(); ++iter)
+      {
+         const tMockCurve& curve = iter->second;
+         printf("%s\n    {\"plot\": ", first ? "" : ",");
+         mock_printJsonStr(curve.plotName);
+         printf(", \"curve\": ");
+         mock_printJsonStr(curve.curveName);
+         printf( ", \"dims\": %d, \"numSamples\": %llu, \"creates\": %llu, \"updates\": %llu, \"samplesReceived\": %llu}",
+                 curve.b_is2D ? 2 : 1, (unsigned long long)(curve.ac_y.size() / PLOT_DATA_TYPE_SIZES[curve.i_yType]),
+                 curve.i_numCreates, curve.i_numUpdates, curve.i_samplesReceived );
+         first = FALSE;
+      }
+   }
+   printf("\n  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+   unsigned short port = 2000;
+   unsigned int numWorkers = 1;
+   unsigned int runSeconds = 0;
+   unsigned int reportMs = 1000;
+   unsigned int nextWorker = 0;
+   tMockWorker* workers;
+   PLOTTER_UINT_64 startTimeNs;
+   PLOTTER_UINT_64 lastReportNs;
+   unsigned long long lastReportBytes = 0;
+   unsigned long long lastReportMsgs = 0;
+   unsigned int workerIndex;
+   int listenFd;
+   int acceptEpollFd;
+   int argIndex;
+   struct epoll_event listenEvent;
+
+   for(argIndex = 1; argIndex < argc; ++argIndex)
+   {
+      const char* arg = argv[argIndex];
+      const char* val = argIndex + 1 < argc ? argv[argIndex + 1] : NULL;
+      if(strcmp(arg, "--no-rebuild") == 0)
+      {
+         g_rebuild = FALSE;
+         continue;
+      }
+      if(val == NULL)
+      {
+         fprintf(stderr, "Usage: %s [--port N] [--threads N] [--seconds N] [--report-ms N] [--no-rebuild]\n", argv[0]);
+         return 1;
+      }
+      if(strcmp(arg, "--port") == 0)
+         port = (unsigned short)atoi(val);
+      else if(strcmp(arg, "--threads") == 0)
+         numWorkers = (unsigned int)atoi(val);
+      else if(strcmp(arg, "--seconds") == 0)
+         runSeconds = (unsigned int)atoi(val);
+      else if(strcmp(arg, "--report-ms") == 0)
+         reportMs = (unsigned int)atoi(val);
+      else
+      {
+         fprintf(stderr, "Unknown argument %s\n", arg);
+         return 1;
+      }
+      argIndex++;
+   }
+   numWorkers = numWorkers < 1 ? 1 : (numWorkers > MOCK_MAX_THREADS ? MOCK_MAX_THREADS : numWorkers);
+
+   signal(SIGINT, mock_signalHandler);
+   signal(SIGTERM, mock_signalHandler);
+   signal(SIGPIPE, SIG_IGN);
+
+   listenFd = mock_listen(port);
+   if(listenFd < 0)
+   {
+      fprintf(stderr, "Failed to listen on port %u\n", (unsigned int)port);
+      return 1;
+   }
+
+   workers = new tMockWorker[numWorkers];
+   for(workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+   {
+      tMockWorker* worker = &workers[workerIndex];
+      worker->i_epollFd = epoll_create1(0);
+      worker->i_bytes = 0;
+      worker->i_groupMsgs = 0;
+      worker->i_plotMsgs = 0;
+      worker->i_errors = 0;
+      worker->i_connections = 0;
+      worker->t_thread = std::thread(mock_workerThread, worker);
+   }
+
+   acceptEpollFd = epoll_create1(0);
+   listenEvent.events = EPOLLIN;
+   listenEvent.data.fd = listenFd;
+   epoll_ctl(acceptEpollFd, EPOLL_CTL_ADD, listenFd, &listenEvent);
+
+   startTimeNs = lastReportNs = plotStats_getTimeNs();
+   while(!g_stop)
+   {
+      struct epoll_event event;
+      PLOTTER_UINT_64 nowNs;
+
+      if(epoll_wait(acceptEpollFd, &event, 1, 50) > 0)
+      {
+         int connFd = accept(listenFd, NULL, NULL);
+         if(connFd >= 0)
+         {
+            tMockWorker* worker = &workers[nextWorker++ % numWorkers];
+            tMockConn* conn = new tMockConn;
+            struct epoll_event connEvent;
+            int noDelay = 1;
+
+            setsockopt(connFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            fcntl(connFd, F_SETFL, fcntl(connFd, F_GETFL, 0) | O_NONBLOCK);
+            conn->i_fd = connFd;
+            conn->ac_buff.resize(MOCK_RECV_BUFF_SIZE);
+            conn->i_readPos = conn->i_writePos = 0;
+
+            connEvent.events = EPOLLIN | EPOLLRDHUP;
+            connEvent.data.ptr = conn;
+            worker->i_connections.fetch_add(1, std::memory_order_relaxed);
+            epoll_ctl(worker->i_epollFd, EPOLL_CTL_ADD, connFd, &connEvent);
+         }
+      }
+
+      nowNs = plotStats_getTimeNs();
+      if(reportMs > 0 && nowNs - lastReportNs >= reportMs * 1000000ull)
+      {
+         unsigned long long numBytes = mock_sum(workers, numWorkers, &tMockWorker::i_bytes);
+         unsigned long long numMsgs = mock_sum(workers, numWorkers, &tMockWorker::i_plotMsgs);
+         double intervalSec = (nowNs - lastReportNs) * 1e-9;
+         fprintf( stderr, "%8.1f MB/s %10.0f msgs/s   total %llu bytes, %llu msgs, %llu errors\n",
+                  (numBytes - lastReportBytes) / intervalSec * 1e-6, (numMsgs - lastReportMsgs) / intervalSec,
+                  numBytes, numMsgs, mock_sum(workers, numWorkers, &tMockWorker::i_errors) );
+         lastReportBytes = numBytes;
+         lastReportMsgs = numMsgs;
+         lastReportNs = nowNs;
+      }
+      if(runSeconds > 0 && nowNs - startTimeNs >= runSeconds * 1000000000ull)
+      {
+         g_stop = 1;
+      }
+   }
+
+   for(workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+   {
+      workers[workerIndex].t_thread.join();
+   }
+   mock_printSummary(workers, numWorkers, (plotStats_getTimeNs() - startTimeNs) * 1e-9);
+
+   close(acceptEpollFd);
+   close(listenFd);
+   delete[] workers;
+   return 0;
+}
@@ -0,0 +1,102 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef plotClock_h
+#define plotClock_h
+
+// Fast clock for the timePlot functions (see smartPlot_enableFastClock). When enabled,
+// time samples are captured as raw TSC ticks, stored in the tSmartPlotTime slot as
+// { tv_sec = ticks, tv_nsec = PLOT_CLOCK_RAW_TICKS }. They are converted to Monotonic
+// time when the plot message is packed, using a calibration against CLOCK_MONOTONIC
+// that is refreshed every PLOT_CLOCK_RECALIBRATE_NS. E_TIME_NS_DELTA samples are raw
+// ticks when PLOT_CLOCK_RAW_TICKS_NS_FLAG is set (nanosecond times never set it).
+//
+// Define PLOTTER_NO_FAST_CLOCK to compile the fast clock out.
+
+#include "smartPlotMessage.h"
+#include "plotMsgTypes.h"
+
+#if !defined PLOTTER_NO_FAST_CLOCK && (defined __x86_64__ || defined _M_X64)
+   #define PLOTTER_FAST_CLOCK_AVAILABLE
+   #ifdef _MSC_VER
+      #include <intrin.h>
+   #else
+      #include <x86intrin.h>
+      #include <cpuid.h>
+   #endif
+#endif
+
+#define PLOT_CLOCK_RAW_TICKS (-1) // tv_nsec value that marks a time sample as raw ticks.
+#define PLOT_CLOCK_RAW_TICKS_NS_FLAG (1ull << 63)
+#define PLOT_CLOCK_RECALIBRATE_NS (1000000000ull)
+#define PLOT_CLOCK_CALIBRATE_MS (10) // How long the initial calibration measures for.
+
+// Raw ticks need a 64 bit tv_sec.
+#define PLOT_CLOCK_TIME_TYPE_SUPPORTED (sizeof(((tSmartPlotTime*)0)->tv_sec) >= sizeof(PLOTTER_UINT_64))
+
+static inline PLOTTER_BOOL plotClock_isRawTicks(const tSmartPlotTime* pTime)
+{
+   return pTime->tv_nsec == PLOT_CLOCK_RAW_TICKS;
+}
+
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+static inline PLOTTER_UINT_64 plotClock_readTicks()
+{
+   return __rdtsc();
+}
+
+// Invariant TSC: ticks at a constant rate in all P / C states and is synchronized across cores.
+static inline PLOTTER_BOOL plotClock_hasInvariantTsc()
+{
+#ifdef _MSC_VER
+   int regs[4];
+   __cpuid(regs, 0x80000000);
+   if((unsigned int)regs[0] < 0x80000007)
+      return FALSE;
+   __cpuid(regs, 0x80000007);
+   return (regs[3] & (1 << 8)) != 0;
+#else
+   unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+   if(__get_cpuid_max(0x80000000, NULL) < 0x80000007)
+      return FALSE;
+   if(!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+      return FALSE;
+   return (edx & (1 << 8)) != 0;
+#endif
+}
+
+static inline void plotClock_getRawTicks(tSmartPlotTime* pTime)
+{
+   pTime->tv_sec = (PLOTTER_INT_64)plotClock_readTicks();
+   pTime->tv_nsec = PLOT_CLOCK_RAW_TICKS;
+}
+
+static inline PLOTTER_UINT_64 plotClock_getRawTicksNs()
+{
+   return plotClock_readTicks() | PLOT_CLOCK_RAW_TICKS_NS_FLAG;
+}
+#endif
+
+// Converts the raw tick samples in an array of packed tSmartPlotTime values to Monotonic
+// time (samples that aren't raw ticks are left alone). Implemented in smartPlotMessage.cpp.
+void plotClock_convertRawTicks(char* samples, unsigned int numSamp);
+
+// Same for an array of E_TIME_NS_DELTA samples.
+void plotClock_convertRawTicksNs(PLOTTER_UINT_64* timesNs, unsigned int numSamp);
+
+#endif
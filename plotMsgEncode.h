@@ -0,0 +1,216 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef plotMsgEncode_h
+#define plotMsgEncode_h
+
+// C++ (C++11) encoder for the Create / Update messages in plotMsgPack.h. The layout of
+// every message is described once by PlotMsgLayout, and PlotMsgEncoder is instantiated
+// per action, so every field after the Curve Name is stored at a compile time offset
+// with a compile time size. The names are measured once per encoder, so packing both
+// halves of a wrapped circular buffer doesn't strlen them twice.
+//
+// Message layout:
+//    Action | Message Size | Plot Name\0 | Curve Name\0 | Num Samples |
+//    [Sample Start Index (Update)] | [X Axis Type (2D)] | Y Axis Type | [Interleaved (2D)] | Samples
+//
+// Example:
+//    PlotMsgEncoder<E_UPDATE_1D_PLOT> encoder(plotName, curveName, E_FLOAT_32);
+//    char* msg = (char*)malloc(encoder.msgSize(numSamp));
+//    unsigned int dataIndex = encoder.pack(msg, numSamp, sampleStartIndex);
+//    packPlotMsgSamples(msg + dataIndex, samples, numSamp, 4, 4);
+//
+// Packed samples (E_TIME_NS_DELTA) can take less than msgSize(numSamp) bytes. Messages
+// with packed samples are finished with encoder.finish(msg, endOfSamplesIndex).
+
+#include <string.h>
+#include "plotMsgPack.h"
+
+static_assert(sizeof(ePlotAction) == sizeof(PLOTTER_UINT_32), "Actions are packed as 32 bit values");
+static_assert(sizeof(ePlotDataTypes) == sizeof(PLOTTER_UINT_32), "Data Types are packed as 32 bit values");
+
+//*****************************************************************************
+// Message Layouts
+//*****************************************************************************
+template<ePlotAction ACTION>
+struct PlotMsgLayout
+{
+   static_assert( ACTION == E_CREATE_1D_PLOT || ACTION == E_CREATE_2D_PLOT ||
+                  ACTION == E_UPDATE_1D_PLOT || ACTION == E_UPDATE_2D_PLOT,
+                  "PlotMsgLayout is only defined for Create / Update messages" );
+
+   static const bool IS_2D = ACTION == E_CREATE_2D_PLOT || ACTION == E_UPDATE_2D_PLOT;
+   static const bool IS_UPDATE = ACTION == E_UPDATE_1D_PLOT || ACTION == E_UPDATE_2D_PLOT;
+
+   // Offsets from the start of the message.
+   static const unsigned int ACTION_OFFSET = 0;
+   static const unsigned int MSG_SIZE_OFFSET = ACTION_OFFSET + sizeof(PLOTTER_UINT_32);
+   static const unsigned int NAMES_OFFSET = MSG_SIZE_OFFSET + sizeof(PLOT_MSG_SIZE_TYPE);
+
+   // Offsets from the end of the Curve Name.
+   static const unsigned int NUM_SAMP_OFFSET = 0;
+   static const unsigned int START_INDEX_OFFSET = NUM_SAMP_OFFSET + sizeof(PLOTTER_UINT_32);
+   static const unsigned int X_TYPE_OFFSET = START_INDEX_OFFSET + (IS_UPDATE ? sizeof(PLOTTER_UINT_32) : 0);
+   static const unsigned int Y_TYPE_OFFSET = X_TYPE_OFFSET + (IS_2D ? sizeof(PLOTTER_UINT_32) : 0);
+   static const unsigned int INTERLEAVED_OFFSET = Y_TYPE_OFFSET + sizeof(PLOTTER_UINT_32);
+   static const unsigned int FIELDS_SIZE = INTERLEAVED_OFFSET + (IS_2D ? sizeof(char) : 0);
+};
+
+//*****************************************************************************
+// Encoder
+//*****************************************************************************
+static inline void packPlotMsgU32(char* dst, PLOTTER_UINT_32 val)
+{
+   memcpy(dst, &val, sizeof(val)); // Messages are packed, fields are not aligned.
+}
+
+template<ePlotAction ACTION>
+class PlotMsgEncoder
+{
+public:
+   typedef PlotMsgLayout<ACTION> tLayout;
+
+   // 1D messages.
+   PlotMsgEncoder(const char* plotName, const char* curveName, ePlotDataTypes yAxisType) :
+      m_plotName(plotName),
+      m_curveName(curveName),
+      m_plotNameSize((unsigned int)strlen(plotName) + 1),
+      m_curveNameSize((unsigned int)strlen(curveName) + 1),
+      m_xAxisType(E_INVALID_DATA_TYPE),
+      m_yAxisType(yAxisType),
+      m_interleaved(0)
+   {
+      static_assert(!tLayout::IS_2D, "2D messages need an X Axis Type");
+   }
+
+   // 2D messages.
+   PlotMsgEncoder(const char* plotName, const char* curveName, ePlotDataTypes xAxisType, ePlotDataTypes yAxisType, char interleaved) :
+      m_plotName(plotName),
+      m_curveName(curveName),
+      m_plotNameSize((unsigned int)strlen(plotName) + 1),
+      m_curveNameSize((unsigned int)strlen(curveName) + 1),
+      m_xAxisType(xAxisType),
+      m_yAxisType(yAxisType),
+      m_interleaved(interleaved)
+   {
+      static_assert(tLayout::IS_2D, "1D messages don't have an X Axis Type");
+   }
+
+   // Index of the first sample in the message.
+   unsigned int dataIndex() const
+   {
+      return tLayout::NAMES_OFFSET + m_plotNameSize + m_curveNameSize + tLayout::FIELDS_SIZE;
+   }
+
+   // Max size of the message (i.e. the size, unless there are packed samples).
+   PLOT_MSG_SIZE_TYPE msgSize(PLOTTER_UINT_32 numSamp) const
+   {
+      return (PLOT_MSG_SIZE_TYPE)( dataIndex() +
+                                   (tLayout::IS_2D ? getPlotMsgSamplesMaxSize(m_xAxisType, numSamp) : 0) +
+                                   getPlotMsgSamplesMaxSize(m_yAxisType, numSamp) );
+   }
+
+   // Sets the Message Size to the number of bytes that were actually packed.
+   // Returns the Message Size.
+   PLOT_MSG_SIZE_TYPE finish(char* msg, unsigned int msgEndIndex) const
+   {
+      packPlotMsgU32(msg + tLayout::MSG_SIZE_OFFSET, msgEndIndex);
+      return (PLOT_MSG_SIZE_TYPE)msgEndIndex;
+   }
+
+   // Packs everything but the samples. msg must hold msgSize(numSamp) bytes.
+   // Returns the index of the first sample in the message.
+   unsigned int pack(char* msg, PLOTTER_UINT_32 numSamp, PLOTTER_UINT_32 sampleStartIndex = 0) const
+   {
+      char* fields = msg + tLayout::NAMES_OFFSET + m_plotNameSize + m_curveNameSize;
+
+      packPlotMsgU32(msg + tLayout::ACTION_OFFSET, (PLOTTER_UINT_32)ACTION);
+      packPlotMsgU32(msg + tLayout::MSG_SIZE_OFFSET, msgSize(numSamp));
+      memcpy(msg + tLayout::NAMES_OFFSET, m_plotName, m_plotNameSize);
+      memcpy(msg + tLayout::NAMES_OFFSET + m_plotNameSize, m_curveName, m_curveNameSize);
+
+      packPlotMsgU32(fields + tLayout::NUM_SAMP_OFFSET, numSamp);
+      if(tLayout::IS_UPDATE)
+      {
+         packPlotMsgU32(fields + tLayout::START_INDEX_OFFSET, sampleStartIndex);
+      }
+      if(tLayout::IS_2D)
+      {
+         packPlotMsgU32(fields + tLayout::X_TYPE_OFFSET, (PLOTTER_UINT_32)m_xAxisType);
+      }
+      packPlotMsgU32(fields + tLayout::Y_TYPE_OFFSET, (PLOTTER_UINT_32)m_yAxisType);
+      if(tLayout::IS_2D)
+      {
+         fields[tLayout::INTERLEAVED_OFFSET] = m_interleaved;
+      }
+
+      return (unsigned int)(fields - msg) + tLayout::FIELDS_SIZE;
+   }
+
+private:
+   const char*    m_plotName;
+   const char*    m_curveName;
+   unsigned int   m_plotNameSize;  // Includes the null terminator.
+   unsigned int   m_curveNameSize; // Includes the null terminator.
+   ePlotDataTypes m_xAxisType;
+   ePlotDataTypes m_yAxisType;
+   char           m_interleaved;
+};
+
+//*****************************************************************************
+// Samples
+//*****************************************************************************
+template<unsigned int DATA_SIZE>
+static inline void packPlotMsgSamplesFixed(char* dst, const char* src, unsigned int numSamp, unsigned int bytesBetweenValues)
+{
+   for(unsigned int i = 0; i < numSamp; ++i)
+   {
+      memcpy(dst + i*DATA_SIZE, src + i*bytesBetweenValues, DATA_SIZE);
+   }
+}
+
+// Copies numSamp samples of dataSize bytes, that are bytesBetweenValues apart in src,
+// into the message. Contiguous samples are a single copy, strided samples of the sizes
+// in PLOT_DATA_TYPE_SIZES are copied with a loop specialized for that size.
+static inline void packPlotMsgSamples(char* dst, const void* srcArray, unsigned int numSamp, unsigned int dataSize, unsigned int bytesBetweenValues)
+{
+   const char* src = (const char*)srcArray;
+
+   if(bytesBetweenValues == dataSize)
+   {
+      memcpy(dst, src, numSamp * dataSize);
+      return;
+   }
+
+   switch(dataSize)
+   {
+      case 1:  packPlotMsgSamplesFixed<1>(dst, src, numSamp, bytesBetweenValues);  break;
+      case 2:  packPlotMsgSamplesFixed<2>(dst, src, numSamp, bytesBetweenValues);  break;
+      case 4:  packPlotMsgSamplesFixed<4>(dst, src, numSamp, bytesBetweenValues);  break;
+      case 8:  packPlotMsgSamplesFixed<8>(dst, src, numSamp, bytesBetweenValues);  break;
+      case 16: packPlotMsgSamplesFixed<16>(dst, src, numSamp, bytesBetweenValues); break;
+      default:
+         for(unsigned int i = 0; i < numSamp; ++i)
+         {
+            memcpy(dst + i*dataSize, src + i*bytesBetweenValues, dataSize);
+         }
+      break;
+   }
+}
+
+#endif
@@ -50,7 +50,7 @@ typedef enum
 
 static inline int isPlotDataTypeValid(ePlotDataTypes plotDataType)
 {
-   return (plotDataType >= 0 && plotDataType < E_INVALID_DATA_TYPE);
+   return (plotDataType >= 0 && plotDataType < E_DATA_TYPE_END && plotDataType != E_INVALID_DATA_TYPE);
 }
 
 static const int PLOT_DATA_TYPE_SIZES[]=
@@ -67,8 +67,13 @@ static const int PLOT_DATA_TYPE_SIZES[]=
    sizeof(PLOTTER_FLOAT_64),
    sizeof(PLOTTER_UINT_32) + sizeof(PLOTTER_UINT_32), // E_TIME_STRUCT_64
    sizeof(PLOTTER_UINT_64) + sizeof(PLOTTER_UINT_64),  // E_TIME_STRUCT_128
-   sizeof(PLOTTER_UINT_16) // E_FLOAT_16
+   sizeof(PLOTTER_UINT_16), // E_FLOAT_16
+   0,                       // E_INVALID_DATA_TYPE
+   sizeof(PLOTTER_UINT_64)  // E_TIME_NS_DELTA (size in memory, see packPlotMsgTimeDeltas)
 };
+#ifdef __cplusplus
+static_assert(sizeof(PLOT_DATA_TYPE_SIZES) / sizeof(PLOT_DATA_TYPE_SIZES[0]) == E_DATA_TYPE_END, "Missing data type size");
+#endif
 
 
 typedef struct
@@ -382,5 +387,68 @@ static inline unsigned int packUpdate2dPlotMsg_Interleaved_withoutData(const t2d
 
    return idx;
 }
+
+//*****************************************************************************
+// Packed Time Samples (E_TIME_NS_DELTA)
+//*****************************************************************************
+// In memory E_TIME_NS_DELTA samples are PLOTTER_UINT_64 nanosecond times. In a message
+// the samples of an axis are packed as the first sample (PLOTTER_UINT_64) followed by
+// the change from the previous sample for each of the other samples, as a zigzag
+// LEB128 varint. Samples that are ~1 ms apart take 3 bytes each, rather than 16 bytes
+// for E_TIME_STRUCT_128. E_TIME_NS_DELTA axes can't be interleaved.
+#define PLOT_MSG_VARINT_MAX_SIZE (10)
+
+static inline int isPlotDataTypePacked(ePlotDataTypes plotDataType)
+{
+   return plotDataType == E_TIME_NS_DELTA;
+}
+
+// Max number of bytes numSamp samples take in a message.
+static inline unsigned int getPlotMsgSamplesMaxSize(ePlotDataTypes plotDataType, PLOTTER_UINT_32 numSamp)
+{
+   if(isPlotDataTypePacked(plotDataType))
+   {
+      return numSamp > 0 ? (unsigned int)sizeof(PLOTTER_UINT_64) + (numSamp - 1) * PLOT_MSG_VARINT_MAX_SIZE : 0;
+   }
+   return numSamp * PLOT_DATA_TYPE_SIZES[plotDataType];
+}
+
+static inline unsigned int packPlotMsgVarint(char* dst, PLOTTER_UINT_64 val)
+{
+   unsigned int size = 0;
+   while(val >= 0x80)
+   {
+      dst[size++] = (char)(val | 0x80);
+      val >>= 7;
+   }
+   dst[size++] = (char)val;
+   return size;
+}
+
+// Packs numSamp E_TIME_NS_DELTA samples into dst. The samples of one axis can be packed
+// in pieces: isFirstPiece is non-zero for the first piece (which starts with the base
+// time) and *prevTimeNs carries the last sample packed from one piece to the next.
+// Returns the number of bytes packed.
+static inline unsigned int packPlotMsgTimeDeltas(char* dst, const PLOTTER_UINT_64* timesNs, unsigned int numSamp, int isFirstPiece, PLOTTER_UINT_64* prevTimeNs)
+{
+   unsigned int idx = 0;
+   unsigned int sampIndex = 0;
+
+   if(numSamp > 0 && isFirstPiece)
+   {
+      memcpy(dst, &timesNs[0], sizeof(timesNs[0]));
+      idx = sizeof(timesNs[0]);
+      *prevTimeNs = timesNs[0];
+      sampIndex = 1;
+   }
+
+   for(; sampIndex < numSamp; ++sampIndex)
+   {
+      PLOTTER_INT_64 delta = (PLOTTER_INT_64)(timesNs[sampIndex] - *prevTimeNs);
+      idx += packPlotMsgVarint(dst + idx, ((PLOTTER_UINT_64)delta << 1) ^ (PLOTTER_UINT_64)(delta >> 63)); // Zigzag, so small negative deltas stay small.
+      *prevTimeNs = timesNs[sampIndex];
+   }
+   return idx;
+}
 #endif
 
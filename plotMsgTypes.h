@@ -45,4 +45,8 @@ typedef unsigned long long PLOTTER_UINT_64;
 typedef float PLOTTER_FLOAT_32;
 typedef double PLOTTER_FLOAT_64;
 
+// Data that is written by different threads is kept at least this far apart, so the
+// threads don't invalidate each other's cache lines (false sharing).
+#define PLOTTER_CACHE_LINE_SIZE (64)
+
 #endif
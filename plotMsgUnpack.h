@@ -0,0 +1,390 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef plotMsgUnpack_h
+#define plotMsgUnpack_h
+
+// Decoders for the messages packed by plotMsgPack.h. Nothing is copied, the decoded
+// messages point into the buffer that was passed in, so the buffer must outlive them.
+// Every field is bounds checked against the size of the buffer before it is read.
+
+#include "plotMsgPack.h"
+
+#define PLOT_MSG_HEADER_SIZE (sizeof(PLOTTER_UINT_32) + sizeof(PLOT_MSG_SIZE_TYPE)) // Action + Message Size
+#define PLOT_MSG_MAX_GROUP_DEPTH (8) // Max number of group messages inside of group messages.
+
+typedef enum
+{
+   E_UNPACK_OK,
+   E_UNPACK_INCOMPLETE,      // Not enough bytes for the whole message yet.
+   E_UNPACK_BAD_ACTION,
+   E_UNPACK_BAD_SIZE,        // Message size doesn't match its contents / doesn't fit in its group.
+   E_UNPACK_BAD_STRING,      // Plot / Curve Name isn't null terminated.
+   E_UNPACK_BAD_DATA_TYPE,
+   E_UNPACK_GROUP_TOO_DEEP
+}ePlotUnpackResult;
+
+// View of a single Create / Update message. The sample pointers point into the message.
+// Sample n of the X axis is at xPoints + n*xStride (same for Y). xPoints is NULL for 1D.
+// The stride is 0 for packed E_TIME_NS_DELTA samples, use unpackPlotMsgTimeDeltas for those.
+typedef struct
+{
+   ePlotAction     action;
+   PLOTTER_UINT_32 msgSize;
+   const char*     plotName;
+   const char*     curveName;
+   PLOTTER_UINT_32 numSamp;
+   PLOTTER_UINT_32 sampleStartIndex; // 0 for Create messages.
+   ePlotDataTypes  xAxisType;        // E_INVALID_DATA_TYPE for 1D.
+   ePlotDataTypes  yAxisType;
+   char            interleaved;      // Boolean
+   const char*     xPoints;
+   const char*     yPoints;
+   unsigned int    xStride;
+   unsigned int    yStride;
+   unsigned int    xPointsSize;      // Bytes of the X / Y samples in the message.
+   unsigned int    yPointsSize;
+}tPlotMsgView;
+
+// Walks every Create / Update message in a buffer of complete messages, descending into
+// group messages.
+typedef struct
+{
+   const char*  buff;
+   unsigned int buffSize;
+   unsigned int idx;
+   unsigned int groupDepth;
+   unsigned int groupEnd[PLOT_MSG_MAX_GROUP_DEPTH];
+   unsigned int numGroups; // Number of group messages that have been stepped into.
+}tPlotMsgReader;
+
+static inline PLOTTER_UINT_32 unpackPlotMsgU32(const char* src)
+{
+   PLOTTER_UINT_32 val;
+   memcpy(&val, src, sizeof(val)); // Messages are packed, fields are not aligned.
+   return val;
+}
+
+static inline int isPlotActionValid(ePlotAction action)
+{
+   return action == E_MULPITLE_PLOTS ||
+          action == E_CREATE_1D_PLOT || action == E_CREATE_2D_PLOT ||
+          action == E_UPDATE_1D_PLOT || action == E_UPDATE_2D_PLOT;
+}
+
+// Reads the action / size at the start of a message. Use this to find message boundaries
+// in a stream. Returns E_UNPACK_INCOMPLETE if there are less than PLOT_MSG_HEADER_SIZE bytes.
+static inline ePlotUnpackResult unpackPlotMsgHeader(const char* buff, unsigned int buffSize, ePlotAction* action, PLOT_MSG_SIZE_TYPE* msgSize)
+{
+   if(buffSize < PLOT_MSG_HEADER_SIZE)
+   {
+      return E_UNPACK_INCOMPLETE;
+   }
+   *action = (ePlotAction)unpackPlotMsgU32(buff);
+   *msgSize = unpackPlotMsgU32(buff + sizeof(PLOTTER_UINT_32));
+   if(!isPlotActionValid(*action))
+   {
+      return E_UNPACK_BAD_ACTION;
+   }
+   if(*msgSize < PLOT_MSG_HEADER_SIZE)
+   {
+      return E_UNPACK_BAD_SIZE;
+   }
+   return E_UNPACK_OK;
+}
+
+// Returns the null terminated string at msg[*idx] and moves *idx past it. NULL if the
+// string isn't terminated before msgSize.
+static inline const char* unpackPlotMsgString(const char* msg, unsigned int msgSize, unsigned int* idx)
+{
+   const char* str = msg + *idx;
+   const char* strEnd = *idx < msgSize ? (const char*)memchr(str, '\0', msgSize - *idx) : NULL;
+   if(strEnd == NULL)
+   {
+      return NULL;
+   }
+   *idx = (unsigned int)(strEnd - msg) + 1;
+   return str;
+}
+
+// Reads a varint at src. Returns the number of bytes read, 0 if it doesn't end within srcSize bytes.
+static inline unsigned int unpackPlotMsgVarint(const char* src, unsigned int srcSize, PLOTTER_UINT_64* val)
+{
+   unsigned int idx;
+   *val = 0;
+   for(idx = 0; idx < srcSize && idx < PLOT_MSG_VARINT_MAX_SIZE; ++idx)
+   {
+      *val |= (PLOTTER_UINT_64)(src[idx] & 0x7F) << (7 * idx);
+      if((src[idx] & 0x80) == 0)
+      {
+         return idx + 1;
+      }
+   }
+   return 0;
+}
+
+// Finds the number of bytes numSamp samples of plotDataType take in a message.
+// Returns 0 if they don't fit within srcSize bytes.
+static inline int getPlotMsgSamplesSize(const char* src, unsigned int srcSize, PLOTTER_UINT_32 numSamp, ePlotDataTypes plotDataType, unsigned int* size)
+{
+   PLOTTER_UINT_32 sampIndex;
+   PLOTTER_UINT_64 delta;
+   unsigned int idx;
+
+   if(!isPlotDataTypePacked(plotDataType))
+   {
+      if((PLOTTER_UINT_64)numSamp * PLOT_DATA_TYPE_SIZES[plotDataType] > srcSize)
+      {
+         return 0;
+      }
+      *size = numSamp * PLOT_DATA_TYPE_SIZES[plotDataType];
+      return 1;
+   }
+
+   if(numSamp == 0)
+   {
+      *size = 0;
+      return 1;
+   }
+   if(srcSize < sizeof(PLOTTER_UINT_64))
+   {
+      return 0;
+   }
+   idx = sizeof(PLOTTER_UINT_64);
+   for(sampIndex = 1; sampIndex < numSamp; ++sampIndex)
+   {
+      unsigned int varintSize = unpackPlotMsgVarint(src + idx, srcSize - idx, &delta);
+      if(varintSize == 0)
+      {
+         return 0;
+      }
+      idx += varintSize;
+   }
+   *size = idx;
+   return 1;
+}
+
+// Unpacks numSamp E_TIME_NS_DELTA samples (the X / Y Points of a view) into timesNs.
+static inline void unpackPlotMsgTimeDeltas(const char* src, unsigned int srcSize, PLOTTER_UINT_32 numSamp, PLOTTER_UINT_64* timesNs)
+{
+   PLOTTER_UINT_32 sampIndex;
+   PLOTTER_UINT_64 zigzag;
+   unsigned int idx = sizeof(PLOTTER_UINT_64);
+
+   if(numSamp == 0 || srcSize < sizeof(PLOTTER_UINT_64))
+   {
+      return;
+   }
+   memcpy(&timesNs[0], src, sizeof(timesNs[0]));
+   for(sampIndex = 1; sampIndex < numSamp; ++sampIndex)
+   {
+      unsigned int varintSize = unpackPlotMsgVarint(src + idx, srcSize - idx, &zigzag);
+      if(varintSize == 0)
+      {
+         return;
+      }
+      idx += varintSize;
+      timesNs[sampIndex] = timesNs[sampIndex - 1] + ((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+   }
+}
+
+// Decodes a single Create / Update message. msgSize must be the size from the message header.
+static inline ePlotUnpackResult unpackPlotMsg(const char* msg, unsigned int msgSize, tPlotMsgView* view)
+{
+   ePlotAction action;
+   PLOT_MSG_SIZE_TYPE headerMsgSize;
+   ePlotUnpackResult result = unpackPlotMsgHeader(msg, msgSize, &action, &headerMsgSize);
+   unsigned int idx = PLOT_MSG_HEADER_SIZE;
+   unsigned int fieldsSize;
+   unsigned int xSize = 0;
+   unsigned int ySize;
+   unsigned int xBytes = 0;
+   unsigned int yBytes = 0;
+   PLOTTER_UINT_32 xAxisType = E_INVALID_DATA_TYPE;
+   PLOTTER_UINT_32 yAxisType;
+   int is2D;
+   int isUpdate;
+
+   if(result != E_UNPACK_OK)
+   {
+      return result;
+   }
+   if(headerMsgSize != msgSize)
+   {
+      return E_UNPACK_BAD_SIZE;
+   }
+   if(action == E_MULPITLE_PLOTS)
+   {
+      return E_UNPACK_BAD_ACTION; // Groups are walked with tPlotMsgReader.
+   }
+
+   is2D = action == E_CREATE_2D_PLOT || action == E_UPDATE_2D_PLOT;
+   isUpdate = action == E_UPDATE_1D_PLOT || action == E_UPDATE_2D_PLOT;
+
+   view->action = action;
+   view->msgSize = msgSize;
+   view->plotName = unpackPlotMsgString(msg, msgSize, &idx);
+   view->curveName = view->plotName != NULL ? unpackPlotMsgString(msg, msgSize, &idx) : NULL;
+   if(view->curveName == NULL)
+   {
+      return E_UNPACK_BAD_STRING;
+   }
+
+   fieldsSize = sizeof(PLOTTER_UINT_32) + (isUpdate ? sizeof(PLOTTER_UINT_32) : 0) +
+                (is2D ? 2 * sizeof(PLOTTER_UINT_32) + sizeof(char) : sizeof(PLOTTER_UINT_32));
+   if(msgSize - idx < fieldsSize)
+   {
+      return E_UNPACK_BAD_SIZE;
+   }
+
+   view->numSamp = unpackPlotMsgU32(msg + idx);
+   idx += sizeof(PLOTTER_UINT_32);
+   view->sampleStartIndex = 0;
+   if(isUpdate)
+   {
+      view->sampleStartIndex = unpackPlotMsgU32(msg + idx);
+      idx += sizeof(PLOTTER_UINT_32);
+   }
+   if(is2D)
+   {
+      xAxisType = unpackPlotMsgU32(msg + idx);
+      idx += sizeof(PLOTTER_UINT_32);
+   }
+   yAxisType = unpackPlotMsgU32(msg + idx);
+   idx += sizeof(PLOTTER_UINT_32);
+   view->interleaved = 0;
+   if(is2D)
+   {
+      view->interleaved = msg[idx];
+      idx += sizeof(char);
+   }
+
+   // Range check the raw values first, values past the end of ePlotDataTypes can't be stored in it.
+   if(xAxisType >= E_DATA_TYPE_END || yAxisType >= E_DATA_TYPE_END)
+   {
+      return E_UNPACK_BAD_DATA_TYPE;
+   }
+   view->xAxisType = (ePlotDataTypes)xAxisType;
+   view->yAxisType = (ePlotDataTypes)yAxisType;
+   if(!isPlotDataTypeValid(view->yAxisType) || (is2D && !isPlotDataTypeValid(view->xAxisType)))
+   {
+      return E_UNPACK_BAD_DATA_TYPE;
+   }
+   if(is2D && view->interleaved && (isPlotDataTypePacked(view->xAxisType) || isPlotDataTypePacked(view->yAxisType)))
+   {
+      return E_UNPACK_BAD_DATA_TYPE;
+   }
+   ySize = PLOT_DATA_TYPE_SIZES[view->yAxisType];
+   xSize = is2D ? PLOT_DATA_TYPE_SIZES[view->xAxisType] : 0;
+   if( (is2D && !getPlotMsgSamplesSize(msg + idx, msgSize - idx, view->numSamp, view->xAxisType, &xBytes)) ||
+       !getPlotMsgSamplesSize(msg + idx + xBytes, msgSize - idx - xBytes, view->numSamp, view->yAxisType, &yBytes) ||
+       xBytes + yBytes != msgSize - idx )
+   {
+      return E_UNPACK_BAD_SIZE;
+   }
+
+   view->xPointsSize = xBytes;
+   view->yPointsSize = yBytes;
+   if(!is2D)
+   {
+      view->xPoints = NULL;
+      view->xStride = 0;
+      view->yPoints = msg + idx;
+      view->yStride = isPlotDataTypePacked(view->yAxisType) ? 0 : ySize;
+   }
+   else if(view->interleaved)
+   {
+      view->xPoints = msg + idx;
+      view->yPoints = msg + idx + xSize;
+      view->xStride = view->yStride = xSize + ySize;
+   }
+   else
+   {
+      view->xPoints = msg + idx;
+      view->yPoints = msg + idx + xBytes;
+      view->xStride = isPlotDataTypePacked(view->xAxisType) ? 0 : xSize;
+      view->yStride = isPlotDataTypePacked(view->yAxisType) ? 0 : ySize;
+   }
+   return E_UNPACK_OK;
+}
+
+static inline void plotMsgReaderInit(tPlotMsgReader* reader, const char* buff, unsigned int buffSize)
+{
+   reader->buff = buff;
+   reader->buffSize = buffSize;
+   reader->idx = 0;
+   reader->groupDepth = 0;
+   reader->numGroups = 0;
+}
+
+// Gets the next Create / Update message. Returns E_UNPACK_OK with view filled in,
+// E_UNPACK_INCOMPLETE when there are no more messages (a partial message at the end of
+// the buffer is left for the caller, reader->idx is where it starts), or an error.
+// After an error the reader can't continue (the message boundaries are unknown).
+static inline ePlotUnpackResult plotMsgReaderNext(tPlotMsgReader* reader, tPlotMsgView* view)
+{
+   while(1)
+   {
+      ePlotAction action;
+      PLOT_MSG_SIZE_TYPE msgSize;
+      unsigned int end = reader->groupDepth > 0 ? reader->groupEnd[reader->groupDepth - 1] : reader->buffSize;
+      ePlotUnpackResult result;
+
+      // Step out of any groups that have been fully read.
+      if(reader->groupDepth > 0 && reader->idx == end)
+      {
+         reader->groupDepth--;
+         continue;
+      }
+
+      result = unpackPlotMsgHeader(reader->buff + reader->idx, end - reader->idx, &action, &msgSize);
+      if(result == E_UNPACK_INCOMPLETE && reader->groupDepth > 0)
+      {
+         return E_UNPACK_BAD_SIZE; // Partial message inside of a complete group.
+      }
+      if(result != E_UNPACK_OK)
+      {
+         return result;
+      }
+      if(msgSize > end - reader->idx)
+      {
+         return reader->groupDepth > 0 ? E_UNPACK_BAD_SIZE : E_UNPACK_INCOMPLETE;
+      }
+
+      if(action == E_MULPITLE_PLOTS)
+      {
+         if(reader->groupDepth >= PLOT_MSG_MAX_GROUP_DEPTH)
+         {
+            return E_UNPACK_GROUP_TOO_DEEP;
+         }
+         reader->groupEnd[reader->groupDepth++] = reader->idx + msgSize;
+         reader->numGroups++;
+         reader->idx += PLOT_MSG_HEADER_SIZE;
+         continue;
+      }
+
+      result = unpackPlotMsg(reader->buff + reader->idx, msgSize, view);
+      if(result == E_UNPACK_OK)
+      {
+         reader->idx += msgSize;
+      }
+      return result;
+   }
+}
+
+#endif
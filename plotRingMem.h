@@ -0,0 +1,261 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef plotRingMem_h
+#define plotRingMem_h
+
+// Memory for the curves' circular buffers (see smartPlot_configureRingMemory and
+// smartPlot_setRingAllocator). Every buffer starts with a tPlotRingMemHeader that records
+// how it was allocated, so it is freed the same way even if the configuration changes.
+// Large buffers can be mmap'd with huge pages (MAP_HUGETLB, or transparent huge pages
+// via madvise) and prefaulted, so the first lap through the buffer doesn't page fault.
+//
+// Mirrored buffers (SMART_PLOT_RING_MEM_MIRROR) are a memfd mapped twice, back to back,
+// right after a private page that holds the header. Sample i + numSamples is the same
+// memory as sample i, so any run of up to numSamples samples is contiguous.
+//
+// mmap is only used on POSIX builds. Windows builds always malloc (or use the hook).
+// Mirrored buffers need memfd_create (Linux).
+
+#include <stdlib.h>
+#include <string.h>
+#include "smartPlotMessage.h"
+#include "plotMsgTypes.h"
+
+#ifndef PLOTTER_WINDOWS_BUILD
+   #define PLOTTER_MMAP_AVAILABLE
+   #include <sys/mman.h>
+   #include <unistd.h>
+   #if defined __linux__ && defined MFD_CLOEXEC
+      #define PLOTTER_RING_MIRROR_AVAILABLE
+   #endif
+#endif
+
+#define PLOT_RING_MEM_HEADER_SIZE (64) // Keeps the samples cache line aligned in mmap'd buffers.
+#define PLOT_RING_MEM_HUGE_PAGE_SIZE (2*1024*1024) // mmap'd buffers are rounded up to this size.
+
+typedef struct
+{
+   size_t i_numBytes;  // Size of the allocation, including this header.
+   size_t i_mapBytes;  // Size of the mapping if the buffer was mmap'd. 0 otherwise.
+   size_t i_mapOffset; // Offset of this header from the start of the mapping.
+   size_t i_mirrorBytes; // Size of the samples if they are mapped twice. 0 otherwise.
+   tSmartPlotRingFree pf_free; // Hook that allocated the buffer. NULL if it wasn't allocated by a hook.
+   void* p_userData;
+}tPlotRingMemHeader;
+
+static_assert(sizeof(tPlotRingMemHeader) <= PLOT_RING_MEM_HEADER_SIZE, "Ring memory header doesn't fit");
+
+// Touches every page, so the page faults happen now rather than on the first write.
+static inline void plotRingMem_prefault(char* mem, size_t numBytes)
+{
+#if defined PLOTTER_MMAP_AVAILABLE && defined MADV_POPULATE_WRITE
+   if(madvise(mem, numBytes, MADV_POPULATE_WRITE) == 0)
+      return;
+#endif
+   {
+      size_t pageSize = 4096;
+      size_t offset;
+      for(offset = 0; offset < numBytes; offset += pageSize)
+      {
+         ((volatile char*)mem)[offset] = 0;
+      }
+   }
+}
+
+#ifdef PLOTTER_MMAP_AVAILABLE
+// Returns the mapping, or NULL if it couldn't be mapped. *mapBytes is set to the size of the mapping.
+static inline char* plotRingMem_map(size_t numBytes, int flags, size_t* mapBytes)
+{
+   void* mem = MAP_FAILED;
+   PLOTTER_BOOL prefaulted = FALSE;
+
+   // Only round up to a whole huge page if huge pages were asked for, a small buffer would waste most of it.
+   size_t pageSize = (flags & (SMART_PLOT_RING_MEM_HUGETLB | SMART_PLOT_RING_MEM_THP)) ?
+                     PLOT_RING_MEM_HUGE_PAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+   *mapBytes = (numBytes + pageSize - 1) / pageSize * pageSize;
+
+#ifdef MAP_HUGETLB
+   if(flags & SMART_PLOT_RING_MEM_HUGETLB)
+   {
+      // Only works if huge pages have been reserved (vm.nr_hugepages). Falls back to transparent huge pages.
+      int populate = (flags & SMART_PLOT_RING_MEM_POPULATE) ? MAP_POPULATE : 0;
+      mem = mmap(NULL, *mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+      prefaulted = mem != MAP_FAILED && populate != 0;
+   }
+#endif
+
+   if(mem == MAP_FAILED)
+   {
+      mem = mmap(NULL, *mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(mem == MAP_FAILED)
+         return NULL;
+
+#ifdef MADV_HUGEPAGE
+      // Has to be done before the pages are faulted in, so prefaulting is done separately.
+      if(flags & (SMART_PLOT_RING_MEM_HUGETLB | SMART_PLOT_RING_MEM_THP))
+      {
+         madvise(mem, *mapBytes, MADV_HUGEPAGE);
+      }
+#endif
+   }
+
+   if((flags & SMART_PLOT_RING_MEM_POPULATE) && !prefaulted)
+   {
+      plotRingMem_prefault((char*)mem, numBytes);
+   }
+
+   return (char*)mem;
+}
+
+#ifdef PLOTTER_RING_MIRROR_AVAILABLE
+// Maps numSampBytes bytes of samples twice, after a page for the header. numSampBytes has to be
+// a multiple of the page size. Returns the location of the header, or NULL if it couldn't be mapped.
+static inline char* plotRingMem_mapMirrored(size_t numSampBytes, int flags, tPlotRingMemHeader* header)
+{
+   size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+   char* mem = (char*)MAP_FAILED;
+   int fd;
+
+   if(numSampBytes == 0 || numSampBytes % pageSize != 0)
+      return NULL;
+
+   fd = memfd_create("plotRing", MFD_CLOEXEC);
+   if(fd < 0)
+      return NULL;
+
+   if(ftruncate(fd, (off_t)numSampBytes) == 0)
+   {
+      // Reserve the whole range first, then put the 2 views of the memfd over the end of it.
+      mem = (char*)mmap(NULL, pageSize + 2*numSampBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if( mem != MAP_FAILED &&
+          ( mmap(mem + pageSize, numSampBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(mem + pageSize + numSampBytes, numSampBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ) )
+      {
+         munmap(mem, pageSize + 2*numSampBytes);
+         mem = (char*)MAP_FAILED;
+      }
+   }
+   close(fd); // The mappings keep the memory alive.
+
+   if(mem == MAP_FAILED)
+      return NULL;
+
+   if(flags & SMART_PLOT_RING_MEM_POPULATE)
+   {
+      plotRingMem_prefault(mem + pageSize, numSampBytes);
+   }
+
+   header->i_mapBytes = pageSize + 2*numSampBytes;
+   header->i_mapOffset = pageSize - PLOT_RING_MEM_HEADER_SIZE;
+   header->i_mirrorBytes = numSampBytes;
+   return mem + header->i_mapOffset;
+}
+#endif
+#endif
+
+// Allocates numSampBytes bytes for samples. Buffers of at least mmapThresholdBytes are mmap'd
+// with the flags (0 means never). Returns a pointer to the samples, NULL on failure.
+static inline char* plotRingMem_alloc( size_t numSampBytes,
+                                       size_t mmapThresholdBytes,
+                                       int flags,
+                                       tSmartPlotRingAlloc allocFunc,
+                                       tSmartPlotRingFree freeFunc,
+                                       void* userData )
+{
+   size_t numBytes = numSampBytes + PLOT_RING_MEM_HEADER_SIZE;
+   char* mem = NULL;
+   tPlotRingMemHeader header;
+
+   memset(&header, 0, sizeof(header));
+   header.i_numBytes = numBytes;
+
+   if(allocFunc != NULL && freeFunc != NULL)
+   {
+      mem = (char*)allocFunc(numBytes, userData);
+      header.pf_free = freeFunc;
+      header.p_userData = userData;
+   }
+#ifdef PLOTTER_MMAP_AVAILABLE
+   else if(mmapThresholdBytes > 0 && numSampBytes >= mmapThresholdBytes)
+   {
+#ifdef PLOTTER_RING_MIRROR_AVAILABLE
+      if(flags & SMART_PLOT_RING_MEM_MIRROR)
+      {
+         mem = plotRingMem_mapMirrored(numSampBytes, flags, &header);
+      }
+      if(mem == NULL)
+#endif
+      {
+         mem = plotRingMem_map(numBytes, flags, &header.i_mapBytes);
+      }
+   }
+#endif
+   else
+   {
+      mem = (char*)malloc(numBytes);
+   }
+
+   if(mem == NULL)
+      return NULL;
+
+   memcpy(mem, &header, sizeof(header));
+   return mem + PLOT_RING_MEM_HEADER_SIZE;
+}
+
+// Frees a buffer from plotRingMem_alloc. samples can be NULL.
+static inline void plotRingMem_free(char* samples)
+{
+   char* mem;
+   tPlotRingMemHeader header;
+
+   if(samples == NULL)
+      return;
+
+   mem = samples - PLOT_RING_MEM_HEADER_SIZE;
+   memcpy(&header, mem, sizeof(header));
+
+   if(header.pf_free != NULL)
+   {
+      header.pf_free(mem, header.i_numBytes, header.p_userData);
+   }
+#ifdef PLOTTER_MMAP_AVAILABLE
+   else if(header.i_mapBytes > 0)
+   {
+      munmap(mem - header.i_mapOffset, header.i_mapBytes);
+   }
+#endif
+   else
+   {
+      free(mem);
+   }
+}
+
+// Returns TRUE if sample i + numSamples of a buffer from plotRingMem_alloc is the same memory as sample i.
+static inline PLOTTER_BOOL plotRingMem_isMirrored(const char* samples)
+{
+   tPlotRingMemHeader header;
+
+   if(samples == NULL)
+      return FALSE;
+
+   memcpy(&header, samples - PLOT_RING_MEM_HEADER_SIZE, sizeof(header));
+   return header.i_mirrorBytes > 0;
+}
+
+#endif
@@ -0,0 +1,192 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef plotSink_h
+#define plotSink_h
+
+// The sinks that are built in to the library (see smartPlot_registerSink). The sink is
+// picked by the scheme at the start of the host name:
+//    tcp://<host>  - The PlotGUI at <host>:<port>. Host names without a scheme use this.
+//    file://<path> - Appends the messages to a file. The port is ignored.
+//    null://       - Throws the messages away. For measuring the cost of generating them.
+
+#include <string.h>
+#include "smartPlotMessage.h"
+#include "plotMsgTypes.h"
+#include "sendTCPPacket.h"
+
+#ifdef PLOTTER_WINDOWS_BUILD
+   #include <io.h>
+   #include <fcntl.h>
+   #include <sys/stat.h>
+#else
+   #include <fcntl.h>
+   #include <unistd.h>
+   #include <sys/uio.h>
+#endif
+
+#define PLOT_SINK_SCHEME_SEPARATOR "://"
+#define PLOT_SINK_DEFAULT_SCHEME "tcp"
+
+static_assert(SMART_PLOT_SINK_MAX_BUFFS <= SEND_TCP_MAX_BUFFS, "TCP sink can't send that many buffers at once");
+
+// Splits a host name into its scheme and address. Host names without a scheme are
+// PLOT_SINK_DEFAULT_SCHEME. Returns the address, *schemeSize is the length of the scheme.
+static inline const char* plotSink_parseHostName(const char* hostName, const char** scheme, unsigned int* schemeSize)
+{
+   const char* separator = strstr(hostName, PLOT_SINK_SCHEME_SEPARATOR);
+   if(separator == NULL)
+   {
+      *scheme = PLOT_SINK_DEFAULT_SCHEME;
+      *schemeSize = (unsigned int)strlen(PLOT_SINK_DEFAULT_SCHEME);
+      return hostName;
+   }
+   *scheme = hostName;
+   *schemeSize = (unsigned int)(separator - hostName);
+   return separator + strlen(PLOT_SINK_SCHEME_SEPARATOR);
+}
+
+//*****************************************************************************
+// TCP
+//*****************************************************************************
+static inline int plotSink_tcpOpen(const char* address, unsigned short port, void* userData)
+{
+   (void)userData;
+   return sendTCPPacket_init(address, port);
+}
+
+static inline int plotSink_tcpSend(int conn, const tSmartPlotSinkBuff* buffs, unsigned int numBuffs, void* userData)
+{
+   tSendTCPBuff tcpBuffs[SMART_PLOT_SINK_MAX_BUFFS];
+   unsigned int buffIndex;
+
+   (void)userData;
+   if(numBuffs > SMART_PLOT_SINK_MAX_BUFFS)
+      return -1;
+
+   for(buffIndex = 0; buffIndex < numBuffs; ++buffIndex)
+   {
+      tcpBuffs[buffIndex].pc_data = buffs[buffIndex].data;
+      tcpBuffs[buffIndex].i_size = buffs[buffIndex].size;
+   }
+   return sendTCPPacket_sendv(conn, tcpBuffs, numBuffs);
+}
+
+static inline void plotSink_tcpClose(int conn, void* userData)
+{
+   (void)userData;
+   sendTCPPacket_close(conn);
+}
+
+static inline int plotSink_tcpIsOpen(int conn, void* userData)
+{
+   (void)userData;
+   return sendTCPPacket_isOpen(conn);
+}
+
+//*****************************************************************************
+// File
+//*****************************************************************************
+static inline int plotSink_fileOpen(const char* address, unsigned short port, void* userData)
+{
+   (void)port;
+   (void)userData;
+#ifdef PLOTTER_WINDOWS_BUILD
+   return _open(address, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+   return open(address, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+}
+
+static inline int plotSink_fileSend(int conn, const tSmartPlotSinkBuff* buffs, unsigned int numBuffs, void* userData)
+{
+   unsigned int totalSize = 0;
+   unsigned int buffIndex;
+
+   (void)userData;
+   if(numBuffs > SMART_PLOT_SINK_MAX_BUFFS)
+      return -1;
+
+#ifdef PLOTTER_WINDOWS_BUILD
+   for(buffIndex = 0; buffIndex < numBuffs; ++buffIndex)
+   {
+      if(_write(conn, buffs[buffIndex].data, buffs[buffIndex].size) != (int)buffs[buffIndex].size)
+         return -1;
+      totalSize += buffs[buffIndex].size;
+   }
+#else
+   {
+      // One write per message, so messages from other connections to the same file don't end up in the middle of it.
+      struct iovec vec[SMART_PLOT_SINK_MAX_BUFFS];
+      for(buffIndex = 0; buffIndex < numBuffs; ++buffIndex)
+      {
+         vec[buffIndex].iov_base = (void*)buffs[buffIndex].data;
+         vec[buffIndex].iov_len = buffs[buffIndex].size;
+         totalSize += buffs[buffIndex].size;
+      }
+      if(writev(conn, vec, (int)numBuffs) != (ssize_t)totalSize)
+         return -1;
+   }
+#endif
+   return (int)totalSize;
+}
+
+static inline void plotSink_fileClose(int conn, void* userData)
+{
+   (void)userData;
+#ifdef PLOTTER_WINDOWS_BUILD
+   _close(conn);
+#else
+   close(conn);
+#endif
+}
+
+//*****************************************************************************
+// Null
+//*****************************************************************************
+#define PLOT_SINK_NULL_CONN (1) // Any valid connection value will do, nothing is opened.
+
+static inline int plotSink_nullOpen(const char* address, unsigned short port, void* userData)
+{
+   (void)address;
+   (void)port;
+   (void)userData;
+   return PLOT_SINK_NULL_CONN;
+}
+
+static inline int plotSink_nullSend(int conn, const tSmartPlotSinkBuff* buffs, unsigned int numBuffs, void* userData)
+{
+   unsigned int totalSize = 0;
+   unsigned int buffIndex;
+
+   (void)conn;
+   (void)userData;
+   for(buffIndex = 0; buffIndex < numBuffs; ++buffIndex)
+   {
+      totalSize += buffs[buffIndex].size;
+   }
+   return (int)totalSize;
+}
+
+static inline void plotSink_nullClose(int conn, void* userData)
+{
+   (void)conn;
+   (void)userData;
+}
+
+#endif
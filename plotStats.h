@@ -0,0 +1,211 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef plotStats_h
+#define plotStats_h
+
+#include <string.h>
+#include "plotMsgTypes.h"
+#include "plotThreading.h"
+#include "smartPlotMessage.h" // defines tSmartPlotTime, smartPlot_getTime and the public stats types
+
+#if defined PLOTTER_WINDOWS_BUILD && !defined __cplusplus
+   #ifndef inline
+      #define inline __inline
+   #endif
+#endif
+
+static inline PLOTTER_UINT_64 plotStats_timeToNs(const tSmartPlotTime* pTime)
+{
+   return (PLOTTER_UINT_64)pTime->tv_sec * 1000000000ull + (PLOTTER_UINT_64)pTime->tv_nsec;
+}
+
+// Monotonic time in nanoseconds. Used for measuring how long library operations take.
+static inline PLOTTER_UINT_64 plotStats_getTimeNs()
+{
+   tSmartPlotTime nowTime;
+   smartPlot_getTime(&nowTime);
+   return plotStats_timeToNs(&nowTime);
+}
+
+// Define PLOTTER_NO_STATS to compile out the stats counters and timing.
+#ifdef PLOTTER_NO_STATS
+   #define PLOT_STATS_TIME_NS() (0)
+#else
+   #define PLOT_STATS_TIME_NS() plotStats_getTimeNs()
+#endif
+
+//*****************************************************************************
+// Counters
+//*****************************************************************************
+// Counters for a single curve. All updates are relaxed atomics, they are only
+// read when someone asks for the stats.
+typedef struct plotCurveStats
+{
+   // Counted by the thread that writes the samples.
+   tPlotAtomicU64 i_samplesWritten;
+   tPlotAtomicU64 i_samplesOverwritten; // Samples that were overwritten in the circular buffer before being sent.
+
+   char ac_pad[PLOTTER_CACHE_LINE_SIZE];
+
+   // Counted by the thread that sends the messages.
+   tPlotAtomicU64 i_msgsGenerated;
+   tPlotAtomicU64 i_bytesGenerated;
+}tPlotCurveStats;
+
+static inline void plotStats_count(tPlotAtomicU64* counter, PLOTTER_UINT_64 addVal)
+{
+#ifndef PLOTTER_NO_STATS
+   plotThreading_atomicAdd(counter, addVal);
+#else
+   (void)counter;
+   (void)addVal;
+#endif
+}
+
+// Copies a name into a fixed size stats array, truncating if needed.
+static inline void plotStats_copyName(char* dst, size_t dstSize, const char* src)
+{
+   size_t srcLen = src != NULL ? strlen(src) : 0;
+   if(srcLen >= dstSize)
+      srcLen = dstSize - 1;
+   if(srcLen > 0)
+      memcpy(dst, src, srcLen);
+   dst[srcLen] = '\0';
+}
+
+static inline void plotStats_curveStatsInit(tPlotCurveStats* stats)
+{
+   plotThreading_atomicStore(&stats->i_samplesWritten, 0);
+   plotThreading_atomicStore(&stats->i_samplesOverwritten, 0);
+   plotThreading_atomicStore(&stats->i_msgsGenerated, 0);
+   plotThreading_atomicStore(&stats->i_bytesGenerated, 0);
+}
+
+//*****************************************************************************
+// Latency Histogram
+//*****************************************************************************
+// HDR style histogram. Each power of 2 is split into PLOT_HIST_SUB_COUNT linear
+// buckets, so every value is recorded with ~12% precision over the full 64 bit range.
+#define PLOT_HIST_SUB_BITS (3)
+#define PLOT_HIST_SUB_COUNT (1 << PLOT_HIST_SUB_BITS)
+#define PLOT_HIST_NUM_BUCKETS ((64 - PLOT_HIST_SUB_BITS + 1) * PLOT_HIST_SUB_COUNT)
+
+typedef struct
+{
+   tPlotAtomicU64 i_count;
+   tPlotAtomicU64 i_sumNs;
+   tPlotAtomicU64 ai_buckets[PLOT_HIST_NUM_BUCKETS];
+}tPlotLatencyHist;
+
+static inline unsigned int plotStats_msb(PLOTTER_UINT_64 val)
+{
+#if defined __GNUC__
+   return 63 - __builtin_clzll(val);
+#else
+   unsigned int msb = 0;
+   while(val >>= 1)
+   {
+      msb++;
+   }
+   return msb;
+#endif
+}
+
+static inline unsigned int plotStats_histBucket(PLOTTER_UINT_64 valueNs)
+{
+   unsigned int msb;
+   if(valueNs < PLOT_HIST_SUB_COUNT)
+   {
+      return (unsigned int)valueNs;
+   }
+   msb = plotStats_msb(valueNs);
+   return (msb - PLOT_HIST_SUB_BITS + 1) * PLOT_HIST_SUB_COUNT + (unsigned int)((valueNs >> (msb - PLOT_HIST_SUB_BITS)) & (PLOT_HIST_SUB_COUNT - 1));
+}
+
+// Smallest value that is recorded in the bucket.
+static inline PLOTTER_UINT_64 plotStats_histBucketStart(unsigned int bucket)
+{
+   unsigned int group = bucket / PLOT_HIST_SUB_COUNT;
+   unsigned int sub = bucket % PLOT_HIST_SUB_COUNT;
+   if(group == 0)
+   {
+      return sub;
+   }
+   return (PLOTTER_UINT_64)(PLOT_HIST_SUB_COUNT + sub) << (group - 1);
+}
+
+static inline void plotStats_histAdd(tPlotLatencyHist* hist, PLOTTER_UINT_64 valueNs)
+{
+#ifndef PLOTTER_NO_STATS
+   plotThreading_atomicAdd(&hist->ai_buckets[plotStats_histBucket(valueNs)], 1);
+   plotThreading_atomicAdd(&hist->i_count, 1);
+   plotThreading_atomicAdd(&hist->i_sumNs, valueNs);
+#else
+   (void)hist;
+   (void)valueNs;
+#endif
+}
+
+// Summarizes the histogram. Percentiles are reported as the last value in the bucket the
+// percentile falls in (i.e. they are never under reported).
+static inline void plotStats_histSummary(const tPlotLatencyHist* hist, tSmartPlotLatencyStats* summary)
+{
+   static const double percentiles[] = {0.5, 0.9, 0.99};
+   unsigned long long* summaryPercentiles[] = {&summary->p50Ns, &summary->p90Ns, &summary->p99Ns};
+   PLOTTER_UINT_64 bucketCounts[PLOT_HIST_NUM_BUCKETS];
+   PLOTTER_UINT_64 total = 0;
+   PLOTTER_UINT_64 count;
+   PLOTTER_UINT_64 runningTotal = 0;
+   unsigned int percentileIndex = 0;
+   unsigned int bucket;
+
+   memset(summary, 0, sizeof(*summary));
+
+   // Take a snapshot of the buckets, so the percentiles are self consistent.
+   for(bucket = 0; bucket < PLOT_HIST_NUM_BUCKETS; ++bucket)
+   {
+      bucketCounts[bucket] = plotThreading_atomicLoad(&hist->ai_buckets[bucket]);
+      total += bucketCounts[bucket];
+   }
+   if(total == 0)
+   {
+      return;
+   }
+
+   count = plotThreading_atomicLoad(&hist->i_count);
+   summary->count = total;
+   summary->meanNs = plotThreading_atomicLoad(&hist->i_sumNs) / (count > 0 ? count : total);
+
+   for(bucket = 0; bucket < PLOT_HIST_NUM_BUCKETS; ++bucket)
+   {
+      PLOTTER_UINT_64 bucketEnd = bucket + 1 < PLOT_HIST_NUM_BUCKETS ? plotStats_histBucketStart(bucket + 1) - 1 : ~0ull;
+      if(bucketCounts[bucket] == 0)
+      {
+         continue;
+      }
+      runningTotal += bucketCounts[bucket];
+      while(percentileIndex < sizeof(percentiles)/sizeof(percentiles[0]) && runningTotal >= percentiles[percentileIndex] * total)
+      {
+         *summaryPercentiles[percentileIndex++] = bucketEnd;
+      }
+      summary->maxNs = bucketEnd;
+   }
+}
+
+#endif
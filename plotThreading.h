@@ -37,6 +37,17 @@ typedef void *(*plotThreading_threadCallback)(void *);
    #endif
 #endif
 
+// Thread local storage.
+#ifndef PLOT_THREAD_LOCAL
+   #if defined _MSC_VER
+      #define PLOT_THREAD_LOCAL __declspec(thread)
+   #elif defined __cplusplus && __cplusplus >= 201103L
+      #define PLOT_THREAD_LOCAL thread_local
+   #else
+      #define PLOT_THREAD_LOCAL __thread
+   #endif
+#endif
+
 // Struct that defines some settings for the Plotting Background Thread.
 typedef struct
 {
@@ -44,6 +55,7 @@ typedef struct
    int setPriorityPolicy;
    int priority;
    int policy;
+   void* userData;
 }tPlotThreadParams;
 
 #ifdef PLOT_THREADING_USE_CPP11_TYPES
@@ -56,8 +68,11 @@ typedef struct
    #include <thread>
    #include <mutex>
 
+   #include <atomic>
+
    typedef std::recursive_mutex tPlotMutex;
    typedef std::thread tPlotThread;
+   typedef std::atomic<PLOTTER_UINT_64> tPlotAtomicU64;
 
    #define CREATE_PLOT_MUTEX(variableName) tPlotMutex variableName
 
@@ -66,6 +81,17 @@ typedef struct
       tPlotThreadParams* threadParams = new tPlotThreadParams;
       threadParams->timeBetweenMs = timeBetweenMs;
       threadParams->setPriorityPolicy = 0;
+      threadParams->userData = NULL;
+
+      return new tPlotThread(threadCallback, threadParams);
+   }
+
+   static inline tPlotThread* plotThreading_createNewThread_withUserData(plotThreading_threadCallback threadCallback, unsigned int timeBetweenMs, void* userData)
+   {
+      tPlotThreadParams* threadParams = new tPlotThreadParams;
+      threadParams->timeBetweenMs = timeBetweenMs;
+      threadParams->setPriorityPolicy = 0;
+      threadParams->userData = userData;
 
       return new tPlotThread(threadCallback, threadParams);
    }
@@ -81,6 +107,7 @@ typedef struct
       threadParams->setPriorityPolicy = 1;
       threadParams->priority = priority;
       threadParams->policy = policy;
+      threadParams->userData = NULL;
 
       return new tPlotThread(threadCallback, threadParams);
    }
@@ -93,6 +120,53 @@ typedef struct
    {
       mutex->unlock();
    }
+
+   // Relaxed atomics. These are only used for counters, so no ordering is needed.
+   static inline void plotThreading_atomicAdd(tPlotAtomicU64* atomicVal, PLOTTER_UINT_64 addVal)
+   {
+      atomicVal->fetch_add(addVal, std::memory_order_relaxed);
+   }
+   static inline PLOTTER_UINT_64 plotThreading_atomicLoad(const tPlotAtomicU64* atomicVal)
+   {
+      return atomicVal->load(std::memory_order_relaxed);
+   }
+   static inline void plotThreading_atomicStore(tPlotAtomicU64* atomicVal, PLOTTER_UINT_64 newVal)
+   {
+      atomicVal->store(newVal, std::memory_order_relaxed);
+   }
+
+   // Acquire load of an index that another thread stores (with release) after writing
+   // the data the index refers to.
+   static inline unsigned int plotThreading_acquireLoadU32(const volatile unsigned int* val)
+   {
+      unsigned int loadedVal = *val;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return loadedVal;
+   }
+   static inline void plotThreading_releaseStoreU32(volatile unsigned int* val, unsigned int newVal)
+   {
+      std::atomic_thread_fence(std::memory_order_release);
+      *val = newVal;
+   }
+
+   // Same as above, for a pointer to data that is filled in before the pointer is stored.
+   static inline void* plotThreading_acquireLoadPtr(void* const volatile* ptr)
+   {
+      void* loadedPtr = *ptr;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return loadedPtr;
+   }
+   static inline void plotThreading_releaseStorePtr(void* volatile* ptr, void* newPtr)
+   {
+      std::atomic_thread_fence(std::memory_order_release);
+      *ptr = newPtr;
+   }
+
+   // Orders all loads / stores before the fence with all loads / stores after it.
+   static inline void plotThreading_fullFence()
+   {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+   }
 #else
    // Use pthreads.
    #include <assert.h>
@@ -100,6 +174,7 @@ typedef struct
    #include "sched.h"
    typedef pthread_mutex_t tPlotMutex;
    typedef pthread_t tPlotThread;
+   typedef volatile PLOTTER_UINT_64 tPlotAtomicU64;
 
    #define CREATE_PLOT_MUTEX(variableName) tPlotMutex variableName = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 
@@ -110,6 +185,24 @@ typedef struct
 
       threadParams->timeBetweenMs = timeBetweenMs;
       threadParams->setPriorityPolicy = 0;
+      threadParams->userData = NULL;
+
+      if(newThread != NULL)
+      {
+         pthread_create(newThread, NULL, threadCallback, threadParams);
+      }
+
+      return newThread;
+   }
+
+   static inline tPlotThread* plotThreading_createNewThread_withUserData(plotThreading_threadCallback threadCallback, unsigned int timeBetweenMs, void* userData)
+   {
+      tPlotThread* newThread = (tPlotThread*)malloc(sizeof(tPlotThread));
+      tPlotThreadParams* threadParams = (tPlotThreadParams*)malloc(sizeof(tPlotThreadParams));
+
+      threadParams->timeBetweenMs = timeBetweenMs;
+      threadParams->setPriorityPolicy = 0;
+      threadParams->userData = userData;
 
       if(newThread != NULL)
       {
@@ -132,6 +225,7 @@ typedef struct
       threadParams->setPriorityPolicy = 1;
       threadParams->priority = priority;
       threadParams->policy = policy;
+      threadParams->userData = NULL;
 
       if(newThread != NULL)
       {
@@ -159,6 +253,47 @@ typedef struct
       pthread_mutex_unlock(mutex);
    }
 
+   // Relaxed atomics. These are only used for counters, so no ordering is needed.
+   static inline void plotThreading_atomicAdd(tPlotAtomicU64* atomicVal, PLOTTER_UINT_64 addVal)
+   {
+      __atomic_fetch_add(atomicVal, addVal, __ATOMIC_RELAXED);
+   }
+   static inline PLOTTER_UINT_64 plotThreading_atomicLoad(const tPlotAtomicU64* atomicVal)
+   {
+      return __atomic_load_n(atomicVal, __ATOMIC_RELAXED);
+   }
+   static inline void plotThreading_atomicStore(tPlotAtomicU64* atomicVal, PLOTTER_UINT_64 newVal)
+   {
+      __atomic_store_n(atomicVal, newVal, __ATOMIC_RELAXED);
+   }
+
+   // Acquire load of an index that another thread stores (with release) after writing
+   // the data the index refers to.
+   static inline unsigned int plotThreading_acquireLoadU32(const volatile unsigned int* val)
+   {
+      return __atomic_load_n(val, __ATOMIC_ACQUIRE);
+   }
+   static inline void plotThreading_releaseStoreU32(volatile unsigned int* val, unsigned int newVal)
+   {
+      __atomic_store_n(val, newVal, __ATOMIC_RELEASE);
+   }
+
+   // Same as above, for a pointer to data that is filled in before the pointer is stored.
+   static inline void* plotThreading_acquireLoadPtr(void* const volatile* ptr)
+   {
+      return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+   }
+   static inline void plotThreading_releaseStorePtr(void* volatile* ptr, void* newPtr)
+   {
+      __atomic_store_n(ptr, newPtr, __ATOMIC_RELEASE);
+   }
+
+   // Orders all loads / stores before the fence with all loads / stores after it.
+   static inline void plotThreading_fullFence()
+   {
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   }
+
 #endif
 
 
@@ -22,7 +22,22 @@
 #include <assert.h>
 #include "sendMemoryToPlot.h"
 #include "plotThreading.h"
-#include "sendTCPPacket.h"
+#include "plotSink.h"
+#include "plotStats.h"
+#include "plotMsgEncode.h"
+#include "plotClock.h"
+
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+#define GROUP_MSG_HEADER_SIZE (8)
+#define GROUP_MSG_WHOLE_GROUP (2) // isGroupFinalMsg value for a group message from plotMsgGroupSend.
+#define MAX_PLOT_DEST_CONNS (2*MAX_PLOT_DESTINATIONS) // Process wide destinations + the plot's own.
+#define MAX_PLOT_ENDPOINTS (64) // Max number of PlotGUI host / port combinations stats are kept for.
+#define MAX_IDLE_CONNS_PER_ENDPOINT (8) // Connections beyond this are closed when they are released.
+#define MAX_PLOT_SINKS (16) // Built in sinks plus the ones added with smartPlot_registerSink.
+#define PLOT_SINK_SCHEME_SIZE (16)
+
 
 //*****************************************************************************
 // Types
@@ -31,21 +46,88 @@
 // each time a plot message is being generated and sent.
 typedef void (*tPlotMsgCallback)(tSendMemToPlot*);
 
+// A sink and the host name scheme that picks it.
+typedef struct
+{
+   char ac_scheme[PLOT_SINK_SCHEME_SIZE];
+   tSmartPlotSink t_sink;
+}tPlotSinkEntry;
 
-//*****************************************************************************
-// Constants
-//*****************************************************************************
-#define GROUP_MSG_HEADER_SIZE (8)
+// Everything that is known about a PlotGUI host / port. Endpoints are created the
+// first time a message is sent to them and are never freed.
+typedef struct plotEndpoint
+{
+   char ac_ipAddr[MAX_IP_ADDR_STRING_SIZE];
+   unsigned short s_ipPort;
+
+   // Where the messages go. The sink is copied when the endpoint is created, so it never changes under a sender.
+   PLOTTER_BOOL b_hasSink; // FALSE if the host name's scheme isn't a registered sink.
+   tSmartPlotSink t_sink;
+   const char* pc_sinkAddr; // ac_ipAddr without the scheme.
+
+   // Connections that aren't being used, ready for the next send. Guarded by gt_connPool_mutex.
+   int ai_idleConns[MAX_IDLE_CONNS_PER_ENDPOINT];
+   unsigned int i_numIdleConns;
+   tPlotAtomicU64 i_connsReused;
+
+   tPlotAtomicU64 i_msgsSent;
+   tPlotAtomicU64 i_bytesSent;
+   tPlotAtomicU64 i_sendErrors;
+   tPlotAtomicU64 i_connects;
+   tPlotAtomicU64 i_connectFailures;
+   tPlotLatencyHist t_sendHist;
+   tPlotLatencyHist t_connectHist;
+}tPlotEndpoint;
+
+// A connection a plot holds to one of its extra destinations, so all of the plot's
+// messages to that destination go in order on the same connection.
+typedef struct plotDestConn
+{
+   tPlotEndpoint* p_endpoint; // NULL if this slot is free.
+   int i_conn;
+}tPlotDestConn;
+
+// A list of destinations. Senders read the lists without locking, so a list is never changed once
+// it has been published. Adding / removing a destination publishes a new copy of the list. The old
+// copies are kept (a sender might still be part way through one), linked from the newer copy.
+typedef struct plotDestList
+{
+   unsigned int i_numDests;
+   tPlotEndpoint* ap_dests[MAX_PLOT_DESTINATIONS];
+   struct plotDestList* p_prevList;
+}tPlotDestList;
 
 
 //*****************************************************************************
 // Local Variables
 //*****************************************************************************
-static int g_groupPlotMsgs = 0;
-static char* g_groupPlot_memory = NULL;
-static int g_groupPlot_curSize = 0;
-static tSendMemToPlot* g_groupSendMemToPlotPtr = NULL;
-static CREATE_PLOT_MUTEX(gt_sendMemToPlot_mutex);
+// Group message state is per thread, so grouping on one thread never blocks another.
+static PLOT_THREAD_LOCAL unsigned int g_groupPlotDepth = 0;
+static PLOT_THREAD_LOCAL tPlotMsgGroup gt_groupPlot; // Used by plotMsgGroupStart / plotMsgGroupEnd.
+static PLOT_THREAD_LOCAL tPlotMsgGroup* gt_selectedGroup = NULL; // Group that new plot messages are added to.
+
+static tPlotAtomicU64 g_totalMsgsSent;
+static tPlotAtomicU64 g_totalBytesSent;
+static tPlotAtomicU64 g_totalSendTimeNs;
+static PLOT_THREAD_LOCAL tSendMemToPlotTotals gt_threadTotals; // What the calling thread has sent.
+static tPlotLatencyHist gt_encodeHist;
+
+static tPlotEndpoint* gt_endpoints[MAX_PLOT_ENDPOINTS];
+static unsigned int g_numEndpoints = 0;
+static CREATE_PLOT_MUTEX(gt_endpoints_mutex);
+static CREATE_PLOT_MUTEX(gt_connPool_mutex);
+
+// Guarded by gt_endpoints_mutex.
+static tPlotSinkEntry gt_sinks[MAX_PLOT_SINKS] =
+{
+   {"tcp",  {plotSink_tcpOpen,  plotSink_tcpSend,  NULL, plotSink_tcpClose,  plotSink_tcpIsOpen, NULL}},
+   {"file", {plotSink_fileOpen, plotSink_fileSend, NULL, plotSink_fileClose, NULL,               NULL}},
+   {"null", {plotSink_nullOpen, plotSink_nullSend, NULL, plotSink_nullClose, NULL,               NULL}},
+};
+static unsigned int g_numSinks = 3;
+
+// Destinations that get a copy of every message. Changed with gt_endpoints_mutex locked, senders read it without it.
+static tPlotDestList* volatile gp_destList = NULL;
 
 
 //*****************************************************************************
@@ -62,6 +144,7 @@ static CREATE_PLOT_MUTEX(gt_sendMemToPlot_mutex);
 // Local Function Prototypes
 //*****************************************************************************
 static int sendPlotPacket(tSendMemToPlot* _this, const char* msg, unsigned int msgSize, int isGroupFinalMsg);
+static int sendPlotPacketv(tSendMemToPlot* _this, const tSmartPlotSinkBuff* buffs, unsigned int numBuffs, int isGroupFinalMsg);
 static tPlotMsgCallback determinePlotMsgGenCallback(tSendMemToPlot* _this);
 
 
@@ -70,53 +153,83 @@ static tPlotMsgCallback determinePlotMsgGenCallback(tSendMemToPlot* _this);
 //*****************************************************************************
 void plotMsgGroupStart()
 {
-   plotThreading_mutexLock(&gt_sendMemToPlot_mutex);
-   g_groupPlotMsgs = 1;
+   // If this thread already has a group selected (e.g. this is a flush worker), the
+   // messages are already being grouped. Just nest inside the selected group.
+   if(g_groupPlotDepth == 0 && gt_selectedGroup == NULL)
+   {
+      plotMsgGroupInit(&gt_groupPlot, NULL);
+      gt_selectedGroup = &gt_groupPlot;
+   }
+   g_groupPlotDepth++;
 }
 
 void plotMsgGroupEnd()
 {
-   if(g_groupPlotMsgs)
+   if(g_groupPlotDepth > 0)
    {
-      if(g_groupPlot_memory != NULL)
+      g_groupPlotDepth--;
+      if(g_groupPlotDepth == 0 && gt_selectedGroup == &gt_groupPlot)
       {
-         unsigned int plotMsgId = E_MULPITLE_PLOTS;
-         unsigned int plotMsgSize = GROUP_MSG_HEADER_SIZE + g_groupPlot_curSize;
+         gt_selectedGroup = NULL;
+         plotMsgGroupSend(&gt_groupPlot);
+      }
+   }
+}
+
+void plotMsgGroupInit(tPlotMsgGroup* group, tSendMemToPlot* sendVia)
+{
+   group->pc_memory = NULL;
+   group->i_curSize = 0;
+   group->i_capacity = 0;
+   group->p_sendVia = sendVia;
+   group->p_sendMem = NULL;
+}
 
-         // Error Checking.
-         assert(g_groupPlot_curSize > 0);
-         assert(g_groupSendMemToPlotPtr != NULL);
+void plotMsgGroupSelect(tPlotMsgGroup* group)
+{
+   gt_selectedGroup = group;
+}
 
-         // Pack the Header.
-         memcpy(&g_groupPlot_memory[0], &plotMsgId, 4);
-         memcpy(&g_groupPlot_memory[4], &plotMsgSize, 4);
+void plotMsgGroupSend(tPlotMsgGroup* group)
+{
+   if(group->pc_memory != NULL)
+   {
+      unsigned int plotMsgId = E_MULPITLE_PLOTS;
+      unsigned int plotMsgSize = GROUP_MSG_HEADER_SIZE + group->i_curSize;
 
-         // Send the message to the plotter.
-         sendPlotPacket(g_groupSendMemToPlotPtr, g_groupPlot_memory, plotMsgSize, 1);
-         free(g_groupPlot_memory);
-      }
+      // Error Checking.
+      assert(group->i_curSize > 0);
+      assert(group->p_sendMem != NULL);
+
+      // Pack the Header.
+      memcpy(&group->pc_memory[0], &plotMsgId, 4);
+      memcpy(&group->pc_memory[4], &plotMsgSize, 4);
 
-      g_groupPlot_memory = NULL;
-      g_groupPlot_curSize = 0;
-      g_groupSendMemToPlotPtr = NULL;
-      g_groupPlotMsgs = 0;
-      plotThreading_mutexUnlock(&gt_sendMemToPlot_mutex);
+      // Send the message to the plotter.
+      sendPlotPacket(group->p_sendMem, group->pc_memory, plotMsgSize, GROUP_MSG_WHOLE_GROUP);
+      free(group->pc_memory);
    }
+
+   group->pc_memory = NULL;
+   group->i_curSize = 0;
+   group->i_capacity = 0;
+   group->p_sendMem = NULL;
 }
 
-static void plotMsgGroupAdd(tSendMemToPlot* _this, const char* msg, unsigned int size)
+static void plotMsgGroupAdd(tPlotMsgGroup* group, tSendMemToPlot* _this, const char* msg, unsigned int size)
 {
-   char* newGroupMsgMem = NULL;
    ePlotAction readPlotActionType = E_INVALID_PLOT_ACTION;
+   unsigned int newSize;
 
    // Check if this is the first message being added to a group message.
-   if(g_groupPlot_memory == NULL)
+   if(group->pc_memory == NULL)
    {
       // Error Checking.
-      assert(g_groupPlot_curSize == 0);
-      assert(g_groupSendMemToPlotPtr == NULL);
+      assert(group->i_curSize == 0);
+      assert(group->p_sendMem == NULL);
 
-      g_groupSendMemToPlotPtr = _this; // Just use the first messages parameters.
+      // Use the group's connection if it has one, otherwise just use the first messages parameters.
+      group->p_sendMem = group->p_sendVia != NULL ? group->p_sendVia : _this;
    }
 
    // If the message passed in is already a group message, strip the
@@ -128,42 +241,74 @@ static void plotMsgGroupAdd(tSendMemToPlot* _this, const char* msg, unsigned int
       size -= GROUP_MSG_HEADER_SIZE;
    }
 
-   // Allocate a buffer that can hold all the old messages and the new one.
-   newGroupMsgMem = (char*)malloc(GROUP_MSG_HEADER_SIZE + g_groupPlot_curSize + size);
-
-   // Move the message from the old buffer to the new buffer (if there was an old buffer).
-   if(g_groupPlot_memory != NULL)
+   // Make sure the buffer can hold all the old messages and the new one. Grow the buffer
+   // geometrically so adding many messages doesn't re-copy the group over and over.
+   newSize = GROUP_MSG_HEADER_SIZE + group->i_curSize + size;
+   if(newSize > group->i_capacity)
    {
-      memcpy(newGroupMsgMem+GROUP_MSG_HEADER_SIZE, g_groupPlot_memory+GROUP_MSG_HEADER_SIZE, g_groupPlot_curSize);
-      free(g_groupPlot_memory);
+      unsigned int newCapacity = group->i_capacity * 2;
+      char* newGroupMsgMem;
+      if(newCapacity < newSize)
+      {
+         newCapacity = newSize;
+      }
+      newGroupMsgMem = (char*)realloc(group->pc_memory, newCapacity);
+      if(NULL == newGroupMsgMem)
+         return;
+      group->pc_memory = newGroupMsgMem;
+      group->i_capacity = newCapacity;
    }
 
    // Copy the new message into the group plot memory.
-   g_groupPlot_memory = newGroupMsgMem;
-   memcpy(g_groupPlot_memory+GROUP_MSG_HEADER_SIZE+g_groupPlot_curSize, msg, size);
+   memcpy(group->pc_memory+GROUP_MSG_HEADER_SIZE+group->i_curSize, msg, size);
 
-   g_groupPlot_curSize += size;
+   group->i_curSize += size;
 }
 
-static inline void packArrayOfStructs( void* dest,
-                                       void* srcArray,
-                                       unsigned int numSamples,
-                                       unsigned int dataSize,
-                                       unsigned int bytesBetweenValues )
+#define PLOT_TIME_DELTA_CHUNK_SIZE (256) // Samples converted from raw ticks at a time.
+
+// Packs E_TIME_NS_DELTA samples as a base time + deltas. Returns the packed size.
+static unsigned int packPlotMemTimeDeltas(char* dst, const char* src, unsigned int numSamp, unsigned int bytesBetweenValues)
 {
-   char* pc_dst = (char*)dest;
-   char* pc_src = ((char*)srcArray);
-   unsigned int packIndex = 0;
+   PLOTTER_UINT_64 timesNs[PLOT_TIME_DELTA_CHUNK_SIZE];
+   PLOTTER_UINT_64 prevTimeNs = 0;
+   unsigned int packedSize = 0;
+   unsigned int sampIndex = 0;
 
-   // copy the data into the message
-   for(packIndex = 0; packIndex < numSamples; ++packIndex)
+   while(sampIndex < numSamp)
    {
-      memcpy( &pc_dst[packIndex*dataSize],
-              &pc_src[bytesBetweenValues*packIndex],
-              dataSize);
+      unsigned int chunkSize = numSamp - sampIndex < PLOT_TIME_DELTA_CHUNK_SIZE ? numSamp - sampIndex : PLOT_TIME_DELTA_CHUNK_SIZE;
+      packPlotMsgSamples((char*)timesNs, src + sampIndex*bytesBetweenValues, chunkSize, sizeof(PLOTTER_UINT_64), bytesBetweenValues);
+      plotClock_convertRawTicksNs(timesNs, chunkSize);
+      packedSize += packPlotMsgTimeDeltas(dst + packedSize, timesNs, chunkSize, sampIndex == 0, &prevTimeNs);
+      sampIndex += chunkSize;
    }
+   return packedSize;
 }
 
+// Packs numSamp samples of mem, starting at sample startIndex. Time samples that were
+// captured as raw fast clock ticks are converted to Monotonic time in the message.
+// Returns the number of bytes packed.
+static inline unsigned int packPlotMemSamples(char* dst, const tPlotMemory* mem, unsigned int startIndex, unsigned int numSamp)
+{
+   const char* src = mem->pc_memory + (mem->i_bytesBetweenValues*startIndex);
+
+   if(mem->e_dataType == E_TIME_NS_DELTA && mem->i_dataSizeBytes == (unsigned int)PLOT_DATA_TYPE_SIZES[E_TIME_NS_DELTA])
+   {
+      return packPlotMemTimeDeltas(dst, src, numSamp, mem->i_bytesBetweenValues);
+   }
+
+   packPlotMsgSamples(dst, src, numSamp, mem->i_dataSizeBytes, mem->i_bytesBetweenValues);
+
+   if(mem->e_dataType == E_TIME_STRUCT_128 && mem->i_dataSizeBytes == (unsigned int)PLOT_DATA_TYPE_SIZES[E_TIME_STRUCT_128])
+   {
+      plotClock_convertRawTicks(dst, numSamp);
+   }
+   return numSamp * mem->i_dataSizeBytes;
+}
+
+
+
 static tPlotMsgCallback determinePlotMsgGenCallback(tSendMemToPlot* _this)
 {
    tPlotMsgCallback callback = sendMemoryToPlot_Create1D;
@@ -221,6 +366,12 @@ void sendMemoryToPlot_Init( tSendMemToPlot* _this,
    _this->i_writeIndex = 0;
    _this->b_closeSocketAfterSend = FALSE;
    _this->i_tcpSocketFd = 0; // Initialize to invalid value.
+   _this->p_curveStats = NULL;
+   _this->p_endpoint = NULL;
+   _this->p_destList = NULL;
+   _this->p_destConns = NULL;
+   _this->p_destConnsProcessList = NULL;
+   _this->p_destConnsPlotList = NULL;
 
    if(plotterIpAddr != NULL)
    {
@@ -228,7 +379,7 @@ void sendMemoryToPlot_Init( tSendMemToPlot* _this,
       _this->pc_ipAddr = _this->ac_ipAddr;
    }
 
-   if(plotterIpPort != 0)
+   if(plotterIpPort != 0 || plotterIpAddr != NULL) // Sinks that aren't TCP don't need a port.
    {
       _this->s_ipPort = plotterIpPort;
    }
@@ -255,36 +406,24 @@ void sendMemoryToPlot(tSendMemToPlot* _this)
 void sendMemoryToPlot_Create1D(tSendMemToPlot* _this)
 {
    char* msg = NULL;
-   t1dPlot plot;
    unsigned int plotMsgSize = 0;
+   unsigned int dataStartIndex = 0;
+   unsigned int dataEndIndex = 0;
+   unsigned int numSamp = _this->t_plotMem.i_numSamples;
+   PLOTTER_UINT_64 encodeStartNs = PLOT_STATS_TIME_NS();
+   PlotMsgEncoder<E_CREATE_1D_PLOT> encoder(_this->pc_plotName, _this->pc_curveName, _this->t_plotMem.e_dataType);
 
-   plot.curveName = _this->pc_curveName;
-   plot.plotName = _this->pc_plotName;
-   plot.yAxisType = _this->t_plotMem.e_dataType;
-   plot.numSamp = _this->t_plotMem.i_numSamples;
-
-   plotMsgSize = getCreatePlot1dMsgSize(&plot);
+   plotMsgSize = encoder.msgSize(numSamp);
    msg = (char*)malloc(plotMsgSize);
    if(NULL == msg)
       return;
 
-   if(!_this->t_plotMem.b_arrayOfStructs)
-   {
-      packCreate1dPlotMsg(&plot, _this->t_plotMem.pc_memory, msg);
-   }
-   else
-   {
-      unsigned int dataStartIndex = 0;
-
-      dataStartIndex = packCreate1dPlotMsg_withoutData(&plot, msg);
+   dataStartIndex = encoder.pack(msg, numSamp);
 
-      packArrayOfStructs( msg+dataStartIndex,
-                          _this->t_plotMem.pc_memory,
-                          plot.numSamp,
-                          _this->t_plotMem.i_dataSizeBytes,
-                          _this->t_plotMem.i_bytesBetweenValues );
-   }
+   dataEndIndex = dataStartIndex + packPlotMemSamples(msg+dataStartIndex, &_this->t_plotMem, 0, numSamp);
+   plotMsgSize = encoder.finish(msg, dataEndIndex);
 
+   plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
    sendPlotPacket(_this, msg, plotMsgSize, 0);
 
    free(msg);
@@ -294,42 +433,28 @@ void sendMemoryToPlot_Create1D(tSendMemToPlot* _this)
 void sendMemoryToPlot_Create2D(tSendMemToPlot* _this)
 {
    char* msg = NULL;
-   t2dPlot plot;
    unsigned int plotMsgSize = 0;
-
-   plot.curveName = _this->pc_curveName;
-   plot.plotName = _this->pc_plotName;
-   plot.numSamp = _this->t_plotMem.i_numSamples;
-   plot.xAxisType = _this->t_plotMem.e_dataType;
-   plot.yAxisType = _this->t_plotMem_separateYAxis.e_dataType;
-
-   plotMsgSize = getCreatePlot2dMsgSize(&plot);
+   unsigned int dataStartIndex = 0;
+   unsigned int dataEndIndex = 0;
+   unsigned int numSamp = _this->t_plotMem.i_numSamples;
+   PLOTTER_UINT_64 encodeStartNs = PLOT_STATS_TIME_NS();
+   PlotMsgEncoder<E_CREATE_2D_PLOT> encoder( _this->pc_plotName, _this->pc_curveName,
+                                             _this->t_plotMem.e_dataType, _this->t_plotMem_separateYAxis.e_dataType,
+                                             0 ); // 0 = Not Interleaved
+
+   plotMsgSize = encoder.msgSize(numSamp);
    msg = (char*)malloc(plotMsgSize);
    if(NULL == msg)
       return;
 
-   if(!_this->t_plotMem.b_arrayOfStructs && !_this->t_plotMem_separateYAxis.b_arrayOfStructs)
-   {
-      packCreate2dPlotMsg(&plot, _this->t_plotMem.pc_memory, _this->t_plotMem_separateYAxis.pc_memory, msg);
-   }
-   else
-   {
-      unsigned int dataStartIndex = 0;
-      dataStartIndex = packCreate2dPlotMsg_withoutData(&plot, msg);
+   dataStartIndex = encoder.pack(msg, numSamp);
 
-      packArrayOfStructs( msg+dataStartIndex,
-                          _this->t_plotMem.pc_memory,
-                          plot.numSamp,
-                          _this->t_plotMem.i_dataSizeBytes,
-                          _this->t_plotMem.i_bytesBetweenValues );
+   dataEndIndex = dataStartIndex + packPlotMemSamples(msg+dataStartIndex, &_this->t_plotMem, 0, numSamp);
 
-      packArrayOfStructs( msg+dataStartIndex + (PLOT_DATA_TYPE_SIZES[_this->t_plotMem.e_dataType]*plot.numSamp),
-                          _this->t_plotMem_separateYAxis.pc_memory,
-                          plot.numSamp,
-                          _this->t_plotMem_separateYAxis.i_dataSizeBytes,
-                          _this->t_plotMem_separateYAxis.i_bytesBetweenValues );
-   }
+   dataEndIndex += packPlotMemSamples(msg+dataEndIndex, &_this->t_plotMem_separateYAxis, 0, numSamp);
+   plotMsgSize = encoder.finish(msg, dataEndIndex);
 
+   plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
    sendPlotPacket(_this, msg, plotMsgSize, 0);
 
    free(msg);
@@ -338,22 +463,23 @@ void sendMemoryToPlot_Create2D(tSendMemToPlot* _this)
 void sendMemoryToPlot_Create2D_Interleaved(tSendMemToPlot* _this)
 {
    char* msg = NULL;
-   t2dPlot plot;
    unsigned int plotMsgSize = 0;
-
-   plot.curveName = _this->pc_curveName;
-   plot.plotName = _this->pc_plotName;
-   plot.numSamp = _this->t_plotMem.i_numSamples;
-   plot.xAxisType = _this->t_plotMem.e_dataType;
-   plot.yAxisType = _this->t_plotMem.e_dataType;
-
-   plotMsgSize = getCreatePlot2dMsgSize(&plot);
+   unsigned int dataStartIndex = 0;
+   unsigned int numSamp = _this->t_plotMem.i_numSamples;
+   PLOTTER_UINT_64 encodeStartNs = PLOT_STATS_TIME_NS();
+   PlotMsgEncoder<E_CREATE_2D_PLOT> encoder( _this->pc_plotName, _this->pc_curveName,
+                                             _this->t_plotMem.e_dataType, _this->t_plotMem.e_dataType,
+                                             1 ); // 1 = Interleaved
+
+   plotMsgSize = encoder.msgSize(numSamp);
    msg = (char*)malloc(plotMsgSize);
    if(NULL == msg)
       return;
 
-   packCreate2dPlotMsg_Interleaved(&plot, _this->t_plotMem.pc_memory, msg);
+   dataStartIndex = encoder.pack(msg, numSamp);
+   memcpy(msg+dataStartIndex, _this->t_plotMem.pc_memory, plotMsgSize - dataStartIndex);
 
+   plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
    sendPlotPacket(_this, msg, plotMsgSize, 0);
 
    free(msg);
@@ -365,6 +491,7 @@ void sendMemoryToPlot_Update1D(tSendMemToPlot* _this)
    unsigned int readIndex = _this->i_readIndex;
    if(writeIndex != readIndex)
    {
+      PLOTTER_UINT_64 encodeStartNs = PLOT_STATS_TIME_NS();
       char* msg1 = NULL;
       char* msg2 = NULL;
 
@@ -377,10 +504,8 @@ void sendMemoryToPlot_Update1D(tSendMemToPlot* _this)
       PLOTTER_BOOL bContiguous = FALSE;
       unsigned int stopIndexMsg1 = 0;
 
-      t1dPlot plot;
-      plot.curveName = _this->pc_curveName;
-      plot.plotName = _this->pc_plotName;
-      plot.yAxisType = _this->t_plotMem.e_dataType;
+      unsigned int numSamp = 0;
+      PlotMsgEncoder<E_UPDATE_1D_PLOT> encoder(_this->pc_plotName, _this->pc_curveName, _this->t_plotMem.e_dataType);
 
       if(writeIndex > readIndex)
       {
@@ -393,48 +518,35 @@ void sendMemoryToPlot_Update1D(tSendMemToPlot* _this)
          stopIndexMsg1 = _this->t_plotMem.i_numSamples;
       }
 
-      plot.numSamp = stopIndexMsg1 - readIndex;
-      plotMsgSize1 = getUpdatePlot1dMsgSize(&plot);
-      msg1 = (char*)malloc(plotMsgSize1);
+      // When the unsent samples wrap, the 2nd message (the samples at the start of the circular
+      // buffer) is packed right after the 1st one, so both messages go out with one send.
+      numSamp = stopIndexMsg1 - readIndex;
+      plotMsgSize1 = encoder.msgSize(numSamp);
+      if(!bContiguous)
+         plotMsgSize2 = encoder.msgSize(writeIndex);
+      msg1 = (char*)malloc(plotMsgSize1 + plotMsgSize2);
       if(NULL == msg1)
          return;
-      dataIndex1 = packUpdate1dPlotMsg_withoutData(&plot, readIndex, msg1);
+      dataIndex1 = encoder.pack(msg1, numSamp, readIndex);
 
-      packArrayOfStructs( msg1+dataIndex1,
-                          _this->t_plotMem.pc_memory + (_this->t_plotMem.i_bytesBetweenValues*readIndex),
-                          plot.numSamp,
-                          _this->t_plotMem.i_dataSizeBytes,
-                          _this->t_plotMem.i_bytesBetweenValues );
+      dataIndex1 += packPlotMemSamples(msg1+dataIndex1, &_this->t_plotMem, readIndex, numSamp);
+      plotMsgSize1 = encoder.finish(msg1, dataIndex1);
 
       if(!bContiguous)
       {
-         plot.numSamp = writeIndex;
-         plotMsgSize2 = getUpdatePlot1dMsgSize(&plot);
-         msg2 = (char*)malloc(plotMsgSize2);
-         if(NULL == msg2)
-            return;
-         dataIndex2 = packUpdate1dPlotMsg_withoutData(&plot, 0, msg2);
+         numSamp = writeIndex;
+         msg2 = msg1 + plotMsgSize1;
+         dataIndex2 = encoder.pack(msg2, numSamp, 0);
 
-         packArrayOfStructs( msg2+dataIndex2,
-                             _this->t_plotMem.pc_memory,
-                             plot.numSamp,
-                             _this->t_plotMem.i_dataSizeBytes,
-                             _this->t_plotMem.i_bytesBetweenValues );
+         dataIndex2 += packPlotMemSamples(msg2+dataIndex2, &_this->t_plotMem, 0, numSamp);
+         plotMsgSize2 = encoder.finish(msg2, dataIndex2);
       }
 
       _this->i_readIndex = writeIndex;
+      plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
 
-      if(msg1 != NULL)
-      {
-         sendPlotPacket(_this, msg1, plotMsgSize1, 0);
-         free(msg1);
-      }
-
-      if(msg2 != NULL)
-      {
-         sendPlotPacket(_this, msg2, plotMsgSize2, 0);
-         free(msg2);
-      }
+      sendPlotPacket(_this, msg1, plotMsgSize1 + plotMsgSize2, 0);
+      free(msg1);
    }
 }
 
@@ -444,6 +556,7 @@ void sendMemoryToPlot_Update2D(tSendMemToPlot* _this)
    unsigned int readIndex = _this->i_readIndex;
    if(writeIndex != readIndex)
    {
+      PLOTTER_UINT_64 encodeStartNs = PLOT_STATS_TIME_NS();
       char* msg1 = NULL;
       char* msg2 = NULL;
 
@@ -456,13 +569,10 @@ void sendMemoryToPlot_Update2D(tSendMemToPlot* _this)
       PLOTTER_BOOL bContiguous = FALSE;
       unsigned int stopIndexMsg1 = 0;
 
-      t2dPlot plot;
-      plot.curveName = _this->pc_curveName;
-      plot.plotName = _this->pc_plotName;
-      plot.interleaved = _this->t_plotMem.b_interleaved;
-
-      plot.xAxisType = _this->t_plotMem.e_dataType;
-      plot.yAxisType = _this->t_plotMem_separateYAxis.e_dataType;
+      unsigned int numSamp = 0;
+      PlotMsgEncoder<E_UPDATE_2D_PLOT> encoder( _this->pc_plotName, _this->pc_curveName,
+                                                _this->t_plotMem.e_dataType, _this->t_plotMem_separateYAxis.e_dataType,
+                                                0 ); // 0 = Not Interleaved
 
       if(writeIndex > readIndex)
       {
@@ -475,63 +585,41 @@ void sendMemoryToPlot_Update2D(tSendMemToPlot* _this)
          stopIndexMsg1 = _this->t_plotMem.i_numSamples;
       }
 
-      plot.numSamp = stopIndexMsg1 - readIndex;
-      plotMsgSize1 = getUpdatePlot2dMsgSize(&plot);
-      msg1 = (char*)malloc(plotMsgSize1);
+      // When the unsent samples wrap, the 2nd message (the samples at the start of the circular
+      // buffer) is packed right after the 1st one, so both messages go out with one send.
+      numSamp = stopIndexMsg1 - readIndex;
+      plotMsgSize1 = encoder.msgSize(numSamp);
+      if(!bContiguous)
+         plotMsgSize2 = encoder.msgSize(writeIndex);
+      msg1 = (char*)malloc(plotMsgSize1 + plotMsgSize2);
       if(NULL == msg1)
          return;
 
-      dataIndex1 = packUpdate2dPlotMsg_withoutData(&plot, readIndex, msg1);
+      dataIndex1 = encoder.pack(msg1, numSamp, readIndex);
 
-      packArrayOfStructs( msg1+dataIndex1,
-                          _this->t_plotMem.pc_memory + (_this->t_plotMem.i_bytesBetweenValues*readIndex),
-                          plot.numSamp,
-                          _this->t_plotMem.i_dataSizeBytes,
-                          _this->t_plotMem.i_bytesBetweenValues );
+      dataIndex1 += packPlotMemSamples(msg1+dataIndex1, &_this->t_plotMem, readIndex, numSamp);
 
-      packArrayOfStructs( msg1+dataIndex1 + (PLOT_DATA_TYPE_SIZES[_this->t_plotMem.e_dataType]*plot.numSamp),
-                          _this->t_plotMem_separateYAxis.pc_memory + (_this->t_plotMem_separateYAxis.i_bytesBetweenValues*readIndex),
-                          plot.numSamp,
-                          _this->t_plotMem_separateYAxis.i_dataSizeBytes,
-                          _this->t_plotMem_separateYAxis.i_bytesBetweenValues );
+      dataIndex1 += packPlotMemSamples(msg1+dataIndex1, &_this->t_plotMem_separateYAxis, readIndex, numSamp);
+      plotMsgSize1 = encoder.finish(msg1, dataIndex1);
 
       if(!bContiguous)
       {
-         plot.numSamp = writeIndex;
-         plotMsgSize2 = getUpdatePlot2dMsgSize(&plot);
-         msg2 = (char*)malloc(plotMsgSize2);
-         if(NULL == msg2)
-            return;
+         numSamp = writeIndex;
+         msg2 = msg1 + plotMsgSize1;
 
-         dataIndex2 = packUpdate2dPlotMsg_withoutData(&plot, 0, msg2);
+         dataIndex2 = encoder.pack(msg2, numSamp, 0);
 
-         packArrayOfStructs( msg2+dataIndex2,
-                             _this->t_plotMem.pc_memory,
-                             plot.numSamp,
-                             _this->t_plotMem.i_dataSizeBytes,
-                             _this->t_plotMem.i_bytesBetweenValues );
+         dataIndex2 += packPlotMemSamples(msg2+dataIndex2, &_this->t_plotMem, 0, numSamp);
 
-         packArrayOfStructs( msg2+dataIndex2 + (PLOT_DATA_TYPE_SIZES[_this->t_plotMem.e_dataType]*plot.numSamp),
-                             _this->t_plotMem_separateYAxis.pc_memory,
-                             plot.numSamp,
-                             _this->t_plotMem_separateYAxis.i_dataSizeBytes,
-                             _this->t_plotMem_separateYAxis.i_bytesBetweenValues );
+         dataIndex2 += packPlotMemSamples(msg2+dataIndex2, &_this->t_plotMem_separateYAxis, 0, numSamp);
+         plotMsgSize2 = encoder.finish(msg2, dataIndex2);
       }
 
       _this->i_readIndex = writeIndex;
+      plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
 
-      if(msg1 != NULL)
-      {
-
-         sendPlotPacket(_this, msg1, plotMsgSize1, 0);
-         free(msg1);
-      }
-
-      if(msg2 != NULL)
-      {
-         sendPlotPacket(_this, msg2, plotMsgSize2, 0);
-         free(msg2);
-      }
+      sendPlotPacket(_this, msg1, plotMsgSize1 + plotMsgSize2, 0);
+      free(msg1);
    }
 }
 
@@ -541,6 +629,7 @@ void sendMemoryToPlot_Update2D_Interleaved(tSendMemToPlot* _this)
    unsigned int readIndex = _this->i_readIndex;
    if(writeIndex != readIndex)
    {
+      PLOTTER_UINT_64 encodeStartNs = PLOT_STATS_TIME_NS();
       char* msg1 = NULL;
       char* msg2 = NULL;
 
@@ -553,13 +642,10 @@ void sendMemoryToPlot_Update2D_Interleaved(tSendMemToPlot* _this)
       PLOTTER_BOOL bContiguous = FALSE;
       unsigned int stopIndexMsg1 = 0;
 
-      t2dPlot plot;
-      plot.curveName = _this->pc_curveName;
-      plot.plotName = _this->pc_plotName;
-      plot.interleaved = _this->t_plotMem.b_interleaved;
-
-      plot.xAxisType = _this->t_plotMem.e_dataType;
-      plot.yAxisType = _this->t_plotMem.e_dataType;
+      unsigned int numSamp = 0;
+      PlotMsgEncoder<E_UPDATE_2D_PLOT> encoder( _this->pc_plotName, _this->pc_curveName,
+                                                _this->t_plotMem.e_dataType, _this->t_plotMem.e_dataType,
+                                                1 ); // 1 = Interleaved
 
       if(writeIndex > readIndex)
       {
@@ -572,105 +658,759 @@ void sendMemoryToPlot_Update2D_Interleaved(tSendMemToPlot* _this)
          stopIndexMsg1 = _this->t_plotMem.i_numSamples;
       }
 
-      plot.numSamp = stopIndexMsg1 - readIndex;
-      plotMsgSize1 = getUpdatePlot2dMsgSize(&plot);
-      msg1 = (char*)malloc(plotMsgSize1);
+      // When the unsent samples wrap, the 2nd message (the samples at the start of the circular
+      // buffer) is packed right after the 1st one, so both messages go out with one send.
+      numSamp = stopIndexMsg1 - readIndex;
+      plotMsgSize1 = encoder.msgSize(numSamp);
+      if(!bContiguous)
+         plotMsgSize2 = encoder.msgSize(writeIndex);
+      msg1 = (char*)malloc(plotMsgSize1 + plotMsgSize2);
       if(NULL == msg1)
          return;
 
-      dataIndex1 = packUpdate2dPlotMsg_Interleaved_withoutData(&plot, readIndex, msg1);
+      dataIndex1 = encoder.pack(msg1, numSamp, readIndex);
 
-      packArrayOfStructs( msg1+dataIndex1,
-                          _this->t_plotMem.pc_memory + (_this->t_plotMem.i_bytesBetweenValues*readIndex),
-                          plot.numSamp,
-                          _this->t_plotMem.i_dataSizeBytes,
-                          _this->t_plotMem.i_bytesBetweenValues );
+      packPlotMemSamples(msg1+dataIndex1, &_this->t_plotMem, readIndex, numSamp);
 
       if(!bContiguous)
       {
-         plot.numSamp = writeIndex;
-         plotMsgSize2 = getUpdatePlot2dMsgSize(&plot);
-         msg2 = (char*)malloc(plotMsgSize2);
-         if(NULL == msg2)
-            return;
+         numSamp = writeIndex;
+         msg2 = msg1 + plotMsgSize1;
 
-         dataIndex2 = packUpdate2dPlotMsg_Interleaved_withoutData(&plot, 0, msg2);
+         dataIndex2 = encoder.pack(msg2, numSamp, 0);
 
-         packArrayOfStructs( msg2+dataIndex2,
-                             _this->t_plotMem.pc_memory,
-                             plot.numSamp,
-                             _this->t_plotMem.i_dataSizeBytes,
-                             _this->t_plotMem.i_bytesBetweenValues );
+         packPlotMemSamples(msg2+dataIndex2, &_this->t_plotMem, 0, numSamp);
       }
 
       _this->i_readIndex = writeIndex;
+      plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
 
-      if(msg1 != NULL)
-      {
+      sendPlotPacket(_this, msg1, plotMsgSize1 + plotMsgSize2, 0);
+      free(msg1);
+   }
+}
 
-         sendPlotPacket(_this, msg1, plotMsgSize1, 0);
-         free(msg1);
+int sendMemoryToPlot_Borrowed(tSendMemToPlot* _this)
+{
+   char header[PlotMsgLayout<E_CREATE_2D_PLOT>::NAMES_OFFSET + 2*MAX_PLOT_CURVE_STRING_SIZE + PlotMsgLayout<E_CREATE_2D_PLOT>::FIELDS_SIZE];
+   char* msgHeader = header;
+   tSmartPlotSinkBuff buffs[3];
+   unsigned int numBuffs = 0;
+   unsigned int numSamp = _this->t_plotMem.i_numSamples;
+   unsigned int headerSize = 0;
+   int retVal;
+   PLOTTER_UINT_64 encodeStartNs;
+
+   // Samples that aren't contiguous or aren't sent as they are in memory have to be packed into a message buffer.
+   if(_this->t_plotMem.b_arrayOfStructs || isPlotDataTypePacked(_this->t_plotMem.e_dataType) ||
+      (_this->t_plotMem.e_plotDim == E_PLOT_2D && !_this->t_plotMem.b_interleaved &&
+       (_this->t_plotMem_separateYAxis.b_arrayOfStructs || isPlotDataTypePacked(_this->t_plotMem_separateYAxis.e_dataType))))
+   {
+      sendMemoryToPlot(_this);
+      return 0;
+   }
+
+   encodeStartNs = PLOT_STATS_TIME_NS();
+   if(_this->t_plotMem.e_plotDim == E_PLOT_1D)
+   {
+      PlotMsgEncoder<E_CREATE_1D_PLOT> encoder(_this->pc_plotName, _this->pc_curveName, _this->t_plotMem.e_dataType);
+      headerSize = encoder.dataIndex();
+      if(headerSize > sizeof(header))
+         msgHeader = (char*)malloc(headerSize);
+      if(NULL == msgHeader)
+         return -1;
+      encoder.pack(msgHeader, numSamp);
+
+      buffs[1].data = _this->t_plotMem.pc_memory;
+      buffs[1].size = numSamp * PLOT_DATA_TYPE_SIZES[_this->t_plotMem.e_dataType];
+      numBuffs = 2;
+   }
+   else
+   {
+      ePlotDataTypes yAxisType = _this->t_plotMem.b_interleaved ? _this->t_plotMem.e_dataType : _this->t_plotMem_separateYAxis.e_dataType;
+      PlotMsgEncoder<E_CREATE_2D_PLOT> encoder( _this->pc_plotName, _this->pc_curveName,
+                                                _this->t_plotMem.e_dataType, yAxisType,
+                                                _this->t_plotMem.b_interleaved ? 1 : 0 );
+      headerSize = encoder.dataIndex();
+      if(headerSize > sizeof(header))
+         msgHeader = (char*)malloc(headerSize);
+      if(NULL == msgHeader)
+         return -1;
+      encoder.pack(msgHeader, numSamp);
+
+      buffs[1].data = _this->t_plotMem.pc_memory;
+      if(_this->t_plotMem.b_interleaved)
+      {
+         buffs[1].size = encoder.msgSize(numSamp) - headerSize;
+         numBuffs = 2;
+      }
+      else
+      {
+         buffs[1].size = numSamp * PLOT_DATA_TYPE_SIZES[_this->t_plotMem.e_dataType];
+         buffs[2].data = _this->t_plotMem_separateYAxis.pc_memory;
+         buffs[2].size = numSamp * PLOT_DATA_TYPE_SIZES[yAxisType];
+         numBuffs = 3;
       }
+   }
+   buffs[0].data = msgHeader;
+   buffs[0].size = headerSize;
+   plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
+
+   // Count the message for the curve here, it is sent as if it were the final message of
+   // a group so it goes out right away, even if this thread is grouping messages.
+   if(_this->p_curveStats != NULL)
+   {
+      plotStats_count(&_this->p_curveStats->i_msgsGenerated, 1);
+      plotStats_count(&_this->p_curveStats->i_bytesGenerated, headerSize + buffs[1].size + (numBuffs > 2 ? buffs[2].size : 0));
+   }
+   retVal = sendPlotPacketv(_this, buffs, numBuffs, 1);
 
-      if(msg2 != NULL)
+   if(msgHeader != header)
+      free(msgHeader);
+   return retVal < 0 ? -1 : 0;
+}
+
+// Looks up the sink for a host name. Returns FALSE if its scheme hasn't been registered.
+static PLOTTER_BOOL sendMemoryToPlot_findSink(const char* hostName, tSmartPlotSink* sink, const char** address)
+{
+   const char* scheme;
+   unsigned int schemeSize;
+   unsigned int sinkIndex;
+   PLOTTER_BOOL found = FALSE;
+
+   *address = plotSink_parseHostName(hostName, &scheme, &schemeSize);
+
+   plotThreading_mutexLock(&gt_endpoints_mutex);
+   for(sinkIndex = 0; sinkIndex < g_numSinks; ++sinkIndex)
+   {
+      if(strlen(gt_sinks[sinkIndex].ac_scheme) == schemeSize && memcmp(gt_sinks[sinkIndex].ac_scheme, scheme, schemeSize) == 0)
       {
-         sendPlotPacket(_this, msg2, plotMsgSize2, 0);
-         free(msg2);
+         *sink = gt_sinks[sinkIndex].t_sink;
+         found = TRUE;
+         break;
       }
    }
+   plotThreading_mutexUnlock(&gt_endpoints_mutex);
+
+   return found;
 }
 
-static int sendPlotPacket(tSendMemToPlot* _this, const char* msg, unsigned int msgSize, int isGroupFinalMsg)
+int sendMemoryToPlot_registerSink(const char* scheme, const tSmartPlotSink* sink)
 {
    int retVal = -1;
-   const char* ipAddr = _this->pc_ipAddr;
-   unsigned short ipPort = _this->s_ipPort;
+   unsigned int sinkIndex;
 
-   plotThreading_mutexLock(&gt_sendMemToPlot_mutex); // If this is on the group plot thread, the recursive mutex will return immediately. On an other thread this will return when the group plot thread is done.
+   if( scheme == NULL || sink == NULL || strlen(scheme) == 0 || strlen(scheme) >= PLOT_SINK_SCHEME_SIZE ||
+       sink->open == NULL || sink->send == NULL || sink->close == NULL )
+   {
+      return -1;
+   }
 
-   if(g_groupPlotMsgs && !isGroupFinalMsg)
+   plotThreading_mutexLock(&gt_endpoints_mutex);
+   for(sinkIndex = 0; sinkIndex < g_numSinks; ++sinkIndex)
    {
-      plotMsgGroupAdd(_this, msg, msgSize); // This is being called from the group plot thread and this isn't the final message, so just queue it up.
-      plotThreading_mutexUnlock(&gt_sendMemToPlot_mutex); // Unlock before early return.
-      return 0;
+      if(strcmp(gt_sinks[sinkIndex].ac_scheme, scheme) == 0)
+         break;
    }
-   plotThreading_mutexUnlock(&gt_sendMemToPlot_mutex); // Unlock now that we know this isn't an early return.
+   if(sinkIndex < MAX_PLOT_SINKS)
+   {
+      strToArray(gt_sinks[sinkIndex].ac_scheme, scheme);
+      gt_sinks[sinkIndex].t_sink = *sink;
+      if(sinkIndex == g_numSinks)
+         g_numSinks++;
+      retVal = 0;
+   }
+   plotThreading_mutexUnlock(&gt_endpoints_mutex);
 
-   if(_this->b_closeSocketAfterSend)
+   return retVal;
+}
+
+// Returns the endpoint for a host / port, creating it if this is the first time it is used.
+// Returns NULL if there are too many endpoints.
+static tPlotEndpoint* sendMemoryToPlot_findEndpoint(const char* ipAddr, unsigned short ipPort)
+{
+   tPlotEndpoint* endpoint = NULL;
+   unsigned int endpointIndex;
+
+   plotThreading_mutexLock(&gt_endpoints_mutex);
+   for(endpointIndex = 0; endpointIndex < g_numEndpoints; ++endpointIndex)
    {
-      retVal = sendTCPPacket(ipAddr, ipPort, msg, msgSize);
+      if( gt_endpoints[endpointIndex]->s_ipPort == ipPort &&
+          strcmp(gt_endpoints[endpointIndex]->ac_ipAddr, ipAddr) == 0 )
+      {
+         endpoint = gt_endpoints[endpointIndex];
+         break;
+      }
+   }
+
+   if(endpoint == NULL && g_numEndpoints < MAX_PLOT_ENDPOINTS)
+   {
+      tPlotEndpoint* newEndpoint = (tPlotEndpoint*)calloc(1, sizeof(tPlotEndpoint));
+      if(newEndpoint != NULL)
+      {
+         strToArray(newEndpoint->ac_ipAddr, ipAddr);
+         newEndpoint->s_ipPort = ipPort;
+         newEndpoint->b_hasSink = sendMemoryToPlot_findSink(newEndpoint->ac_ipAddr, &newEndpoint->t_sink, &newEndpoint->pc_sinkAddr);
+         gt_endpoints[g_numEndpoints++] = newEndpoint;
+         endpoint = newEndpoint;
+      }
+   }
+   plotThreading_mutexUnlock(&gt_endpoints_mutex);
+
+   return endpoint;
+}
+
+static tPlotEndpoint* sendMemoryToPlot_getEndpoint(tSendMemToPlot* _this)
+{
+   if(_this->p_endpoint == NULL)
+   {
+      _this->p_endpoint = sendMemoryToPlot_findEndpoint(_this->pc_ipAddr, _this->s_ipPort);
+   }
+   return _this->p_endpoint;
+}
+
+// Returns the sink the plot's messages go to, NULL if there isn't one. Plots that don't have an
+// endpoint (there are too many of them) look the sink up every time, into unlistedSink.
+static const tSmartPlotSink* sendMemoryToPlot_getSink(tSendMemToPlot* _this, tPlotEndpoint* endpoint, tSmartPlotSink* unlistedSink, const char** address)
+{
+   if(endpoint != NULL)
+   {
+      *address = endpoint->pc_sinkAddr;
+      return endpoint->b_hasSink ? &endpoint->t_sink : NULL;
+   }
+   return sendMemoryToPlot_findSink(_this->pc_ipAddr, unlistedSink, address) ? unlistedSink : NULL;
+}
+
+static int sendMemoryToPlot_connect(tPlotEndpoint* endpoint, const tSmartPlotSink* sink, const char* address, unsigned short port)
+{
+   PLOTTER_UINT_64 connectStartNs = PLOT_STATS_TIME_NS();
+   int conn = sink->open(address, port, sink->userData);
+   if(endpoint != NULL)
+   {
+      plotStats_histAdd(&endpoint->t_connectHist, PLOT_STATS_TIME_NS() - connectStartNs);
+      plotStats_count(conn > 0 ? &endpoint->i_connects : &endpoint->i_connectFailures, 1);
+   }
+   return conn;
+}
+
+// Takes an idle connection out of the endpoint's pool, or makes a new one if there aren't any.
+// *newConn is set if a new connection was made. Returns the connection, <= 0 if there isn't one.
+static int sendMemoryToPlot_acquireConn(tPlotEndpoint* endpoint, const tSmartPlotSink* sink, const char* address, unsigned short port, PLOTTER_BOOL* newConn)
+{
+   int conn = 0;
+
+   while(endpoint != NULL && conn <= 0)
+   {
+      plotThreading_mutexLock(&gt_connPool_mutex);
+      if(endpoint->i_numIdleConns == 0)
+      {
+         plotThreading_mutexUnlock(&gt_connPool_mutex);
+         break;
+      }
+      conn = endpoint->ai_idleConns[--endpoint->i_numIdleConns];
+      plotThreading_mutexUnlock(&gt_connPool_mutex);
+
+      // The PlotGUI might have closed it while it was idle.
+      if(sink->isOpen != NULL && !sink->isOpen(conn, sink->userData))
+      {
+         sink->close(conn, sink->userData);
+         conn = 0;
+      }
+   }
+
+   if(conn > 0)
+   {
+      plotStats_count(&endpoint->i_connsReused, 1);
+      *newConn = FALSE;
    }
    else
    {
-      PLOTTER_BOOL b_newConnection = FALSE;
-      if( (int)_this->i_tcpSocketFd <= 0 ) // Consider FD of 0 as invalid
+      conn = sendMemoryToPlot_connect(endpoint, sink, address, port);
+      *newConn = TRUE;
+   }
+   return conn;
+}
+
+// Puts a connection back in the endpoint's pool. It is closed if the pool is full.
+static void sendMemoryToPlot_releaseConn(tPlotEndpoint* endpoint, const tSmartPlotSink* sink, int conn)
+{
+   PLOTTER_BOOL pooled = FALSE;
+
+   if(conn <= 0 || sink == NULL)
+      return;
+
+   if(sink->flush != NULL)
+   {
+      sink->flush(conn, sink->userData);
+   }
+
+   if(endpoint != NULL)
+   {
+      plotThreading_mutexLock(&gt_connPool_mutex);
+      if(endpoint->i_numIdleConns < MAX_IDLE_CONNS_PER_ENDPOINT)
       {
-         // Need to init
-         _this->i_tcpSocketFd = sendTCPPacket_init(ipAddr, ipPort);
-         b_newConnection = TRUE;
+         endpoint->ai_idleConns[endpoint->i_numIdleConns++] = conn;
+         pooled = TRUE;
       }
-      if( (int)_this->i_tcpSocketFd > 0 )
+      plotThreading_mutexUnlock(&gt_connPool_mutex);
+   }
+
+   if(!pooled)
+   {
+      sink->close(conn, sink->userData);
+   }
+}
+
+static const tPlotDestList* sendMemoryToPlot_loadDestList(tPlotDestList* const volatile* destList)
+{
+   return (const tPlotDestList*)plotThreading_acquireLoadPtr((void* const volatile*)destList);
+}
+
+static PLOTTER_BOOL sendMemoryToPlot_isInDestList(const tPlotDestList* destList, const tPlotEndpoint* endpoint)
+{
+   unsigned int destIndex;
+   if(destList != NULL)
+   {
+      for(destIndex = 0; destIndex < destList->i_numDests; ++destIndex)
       {
-         // Is valid FD, send packet
-         retVal = sendTCPPacket_send(_this->i_tcpSocketFd, msg, msgSize);
-         if(retVal < 0 && b_newConnection == FALSE)
+         if(destList->ap_dests[destIndex] == endpoint)
+            return TRUE;
+      }
+   }
+   return FALSE;
+}
+
+// Returns a new copy of the destination list (NULL is an empty list), without skipEndpoint.
+static tPlotDestList* sendMemoryToPlot_copyDestList(tPlotDestList* destList, const tPlotEndpoint* skipEndpoint)
+{
+   tPlotDestList* newList = (tPlotDestList*)malloc(sizeof(tPlotDestList));
+   unsigned int destIndex;
+
+   if(newList == NULL)
+      return NULL;
+
+   newList->i_numDests = 0;
+   newList->p_prevList = destList;
+   if(destList != NULL)
+   {
+      for(destIndex = 0; destIndex < destList->i_numDests; ++destIndex)
+      {
+         if(destList->ap_dests[destIndex] != skipEndpoint)
+         {
+            newList->ap_dests[newList->i_numDests++] = destList->ap_dests[destIndex];
+         }
+      }
+   }
+   return newList;
+}
+
+// Frees a destination list and all the older copies of it.
+static void sendMemoryToPlot_freeDestLists(tPlotDestList* destList)
+{
+   while(destList != NULL)
+   {
+      tPlotDestList* prevList = destList->p_prevList;
+      free(destList);
+      destList = prevList;
+   }
+}
+
+void sendMemoryToPlot_Release(tSendMemToPlot* _this)
+{
+   if(_this->i_tcpSocketFd > 0) // FD of 0 is the invalid value (see sendMemoryToPlot_Init)
+   {
+      tSmartPlotSink unlistedSink;
+      const char* address;
+      const tSmartPlotSink* sink = sendMemoryToPlot_getSink(_this, _this->p_endpoint, &unlistedSink, &address);
+      sendMemoryToPlot_releaseConn(_this->p_endpoint, sink, _this->i_tcpSocketFd);
+   }
+   _this->i_tcpSocketFd = 0;
+
+   if(_this->p_destConns != NULL)
+   {
+      unsigned int connIndex;
+      for(connIndex = 0; connIndex < MAX_PLOT_DEST_CONNS; ++connIndex)
+      {
+         tPlotEndpoint* dest = _this->p_destConns[connIndex].p_endpoint;
+         if(dest != NULL)
          {
-            // Bad send. Close, init and try to send again
-            sendTCPPacket_close(_this->i_tcpSocketFd);
+            sendMemoryToPlot_releaseConn(dest, &dest->t_sink, _this->p_destConns[connIndex].i_conn);
+         }
+      }
+      free(_this->p_destConns);
+      _this->p_destConns = NULL;
+   }
+
+   // Nothing is sending for the plot anymore, so its old destination lists can go too.
+   sendMemoryToPlot_freeDestLists(_this->p_destList);
+   _this->p_destList = NULL;
+}
+
+// Returns the connection the plot holds to an extra destination. NULL if the plot borrows a
+// connection from the pool for every message (i.e. b_closeSocketAfterSend).
+static int* sendMemoryToPlot_getDestConn(tSendMemToPlot* _this, tPlotEndpoint* dest)
+{
+   unsigned int connIndex;
 
-            _this->i_tcpSocketFd = sendTCPPacket_init(ipAddr, ipPort);
-            if( (int)_this->i_tcpSocketFd > 0 )
+   if(_this->b_closeSocketAfterSend)
+      return NULL;
+
+   if(_this->p_destConns == NULL)
+   {
+      _this->p_destConns = (tPlotDestConn*)calloc(MAX_PLOT_DEST_CONNS, sizeof(tPlotDestConn));
+      if(_this->p_destConns == NULL)
+         return NULL;
+   }
+
+   for(connIndex = 0; connIndex < MAX_PLOT_DEST_CONNS; ++connIndex)
+   {
+      tPlotDestConn* destConn = &_this->p_destConns[connIndex];
+      if(destConn->p_endpoint == NULL)
+      {
+         destConn->p_endpoint = dest;
+         destConn->i_conn = 0;
+      }
+      if(destConn->p_endpoint == dest)
+      {
+         return &destConn->i_conn;
+      }
+   }
+   return NULL; // Destinations have been removed and added until every slot is used. Borrow from the pool.
+}
+
+static int sendPlotPacket(tSendMemToPlot* _this, const char* msg, unsigned int msgSize, int isGroupFinalMsg)
+{
+   tSmartPlotSinkBuff buff;
+   buff.data = msg;
+   buff.size = msgSize;
+   return sendPlotPacketv(_this, &buff, 1, isGroupFinalMsg);
+}
+
+// Sends a message to an endpoint. If heldConn is NULL, a connection is borrowed from the
+// endpoint's pool for just this message. Otherwise *heldConn is the connection to send on
+// (<= 0 to get one), and it is updated if the connection has to be replaced.
+// Returns the number of bytes sent, < 0 on error.
+static int sendMemoryToPlot_sendToEndpoint( tPlotEndpoint* endpoint,
+                                            const tSmartPlotSink* sink,
+                                            const char* address,
+                                            unsigned short port,
+                                            int* heldConn,
+                                            const tSmartPlotSinkBuff* buffs,
+                                            unsigned int numBuffs,
+                                            unsigned int msgSize )
+{
+   int retVal = -1;
+   PLOTTER_UINT_64 sendStartTimeNs = plotStats_getTimeNs();
+   PLOTTER_UINT_64 sendTimeNs = 0;
+   int conn = heldConn != NULL ? *heldConn : 0;
+   PLOTTER_BOOL b_newConnection = FALSE;
+
+   if( conn <= 0 && sink != NULL ) // Consider FD of 0 as invalid
+   {
+      conn = sendMemoryToPlot_acquireConn(endpoint, sink, address, port, &b_newConnection);
+   }
+   if( conn > 0 )
+   {
+      // Is valid FD, send packet
+      retVal = sink->send(conn, buffs, numBuffs, sink->userData);
+      if(retVal < 0)
+      {
+         // Bad send. Close, init and try to send again
+         sink->close(conn, sink->userData);
+         conn = 0;
+
+         if(b_newConnection == FALSE)
+         {
+            conn = sendMemoryToPlot_connect(endpoint, sink, address, port);
+            if( conn > 0 )
             {
-               retVal = sendTCPPacket_send(_this->i_tcpSocketFd, msg, msgSize);
+               retVal = sink->send(conn, buffs, numBuffs, sink->userData);
             }
          }
       }
+   }
 
+   if(heldConn == NULL)
+   {
+      if(retVal >= 0)
+         sendMemoryToPlot_releaseConn(endpoint, sink, conn);
+      else if(conn > 0)
+         sink->close(conn, sink->userData);
+   }
+   else
+   {
+      *heldConn = conn;
+   }
+
+   sendTimeNs = plotStats_getTimeNs() - sendStartTimeNs;
+   plotThreading_atomicAdd(&g_totalSendTimeNs, sendTimeNs);
+   gt_threadTotals.i_sendTimeNs += sendTimeNs;
+   if(retVal >= 0)
+   {
+      plotThreading_atomicAdd(&g_totalMsgsSent, 1);
+      plotThreading_atomicAdd(&g_totalBytesSent, msgSize);
+      gt_threadTotals.i_msgsSent++;
+      gt_threadTotals.i_bytesSent += msgSize;
+   }
+
+   if(endpoint != NULL)
+   {
+      plotStats_histAdd(&endpoint->t_sendHist, sendTimeNs);
+      if(retVal >= 0)
+      {
+         plotStats_count(&endpoint->i_msgsSent, 1);
+         plotStats_count(&endpoint->i_bytesSent, msgSize);
+      }
+      else
+      {
+         plotStats_count(&endpoint->i_sendErrors, 1);
+      }
    }
 
    return retVal;
 }
 
+// Closes the plot's connections to destinations that have been removed, so they don't stay open
+// (and keep their slot) until the plot is released. Only checked when a destination list has changed.
+static void sendMemoryToPlot_pruneDestConns( tSendMemToPlot* _this,
+                                             const tPlotDestList* processDests,
+                                             const tPlotDestList* plotDests )
+{
+   unsigned int connIndex;
+
+   if( _this->p_destConns == NULL ||
+       (processDests == _this->p_destConnsProcessList && plotDests == _this->p_destConnsPlotList) )
+   {
+      return;
+   }
+
+   for(connIndex = 0; connIndex < MAX_PLOT_DEST_CONNS; ++connIndex)
+   {
+      tPlotDestConn* destConn = &_this->p_destConns[connIndex];
+      tPlotEndpoint* dest = destConn->p_endpoint;
+      if( dest != NULL &&
+          !sendMemoryToPlot_isInDestList(processDests, dest) &&
+          !sendMemoryToPlot_isInDestList(plotDests, dest) )
+      {
+         if(destConn->i_conn > 0)
+         {
+            dest->t_sink.close(destConn->i_conn, dest->t_sink.userData);
+         }
+         destConn->p_endpoint = NULL;
+         destConn->i_conn = 0;
+      }
+   }
+   _this->p_destConnsProcessList = processDests;
+   _this->p_destConnsPlotList = plotDests;
+}
+
+// Sends a message that has already been sent to the plot's own endpoint (primary) to the extra
+// destinations as well. Every destination is sent the same buffers, the message isn't re-encoded.
+static void sendMemoryToPlot_fanOut( tSendMemToPlot* _this,
+                                     const tPlotEndpoint* primary,
+                                     PLOTTER_BOOL toProcessDests,
+                                     PLOTTER_BOOL toPlotDests,
+                                     const tSmartPlotSinkBuff* buffs,
+                                     unsigned int numBuffs,
+                                     unsigned int msgSize )
+{
+   // Every destination is read from the same copy of each list, even if a destination is added /
+   // removed part way through. So no destination is skipped or sent the message twice.
+   const tPlotDestList* processDests = sendMemoryToPlot_loadDestList(&gp_destList);
+   const tPlotDestList* plotDests = sendMemoryToPlot_loadDestList(&_this->p_destList);
+   unsigned int destIndex;
+
+   sendMemoryToPlot_pruneDestConns(_this, processDests, plotDests);
+
+   if(toProcessDests && processDests != NULL)
+   {
+      for(destIndex = 0; destIndex < processDests->i_numDests; ++destIndex)
+      {
+         tPlotEndpoint* dest = processDests->ap_dests[destIndex];
+         if(dest != primary && dest->b_hasSink)
+         {
+            sendMemoryToPlot_sendToEndpoint( dest, &dest->t_sink, dest->pc_sinkAddr, dest->s_ipPort,
+                                             sendMemoryToPlot_getDestConn(_this, dest), buffs, numBuffs, msgSize );
+         }
+      }
+   }
+
+   if(toPlotDests && plotDests != NULL)
+   {
+      for(destIndex = 0; destIndex < plotDests->i_numDests; ++destIndex)
+      {
+         // Process wide destinations get every message already.
+         tPlotEndpoint* dest = plotDests->ap_dests[destIndex];
+         if(dest != primary && dest->b_hasSink && !sendMemoryToPlot_isInDestList(processDests, dest))
+         {
+            sendMemoryToPlot_sendToEndpoint( dest, &dest->t_sink, dest->pc_sinkAddr, dest->s_ipPort,
+                                             sendMemoryToPlot_getDestConn(_this, dest), buffs, numBuffs, msgSize );
+         }
+      }
+   }
+}
+
+// Sends a message that is split across multiple buffers (e.g. a header followed by
+// samples that are still in the caller's memory) without copying it into one buffer.
+static int sendPlotPacketv(tSendMemToPlot* _this, const tSmartPlotSinkBuff* buffs, unsigned int numBuffs, int isGroupFinalMsg)
+{
+   int retVal;
+   tPlotEndpoint* endpoint = NULL;
+   tSmartPlotSink unlistedSink;
+   const tSmartPlotSink* sink;
+   const char* address;
+   unsigned int msgSize = 0;
+   unsigned int buffIndex;
+
+   for(buffIndex = 0; buffIndex < numBuffs; ++buffIndex)
+   {
+      msgSize += buffs[buffIndex].size;
+   }
+
+   if(!isGroupFinalMsg && _this->p_curveStats != NULL)
+   {
+      plotStats_count(&_this->p_curveStats->i_msgsGenerated, 1);
+      plotStats_count(&_this->p_curveStats->i_bytesGenerated, msgSize);
+   }
+
+   if(gt_selectedGroup != NULL && !isGroupFinalMsg)
+   {
+      // This thread is grouping messages and this isn't the final message, so just queue it up.
+      assert(numBuffs == 1);
+      plotMsgGroupAdd(gt_selectedGroup, _this, buffs[0].data, msgSize);
+
+      // The group might be sent via another plot, so this plot's own destinations get the message now.
+      if(sendMemoryToPlot_loadDestList(&_this->p_destList) != NULL)
+      {
+         sendMemoryToPlot_fanOut(_this, sendMemoryToPlot_getEndpoint(_this), FALSE, TRUE, buffs, numBuffs, msgSize);
+      }
+      return 0;
+   }
+
+   endpoint = sendMemoryToPlot_getEndpoint(_this);
+   sink = sendMemoryToPlot_getSink(_this, endpoint, &unlistedSink, &address);
+
+   // Plots that close the socket after every send borrow a connection from the endpoint's pool
+   // for just this message. Otherwise the plot holds on to its connection until it is released.
+   retVal = sendMemoryToPlot_sendToEndpoint( endpoint, sink, address, _this->s_ipPort,
+                                             _this->b_closeSocketAfterSend ? NULL : &_this->i_tcpSocketFd,
+                                             buffs, numBuffs, msgSize );
+
+   // The plots in a group were sent to their own destinations when they were added to the group.
+   sendMemoryToPlot_fanOut(_this, endpoint, TRUE, isGroupFinalMsg != GROUP_MSG_WHOLE_GROUP, buffs, numBuffs, msgSize);
+
+   return retVal;
+}
+
+int sendMemoryToPlot_addDestination(tSendMemToPlot* _this, const char* hostName, unsigned short port)
+{
+   tPlotDestList* volatile* destList = _this != NULL ? &_this->p_destList : &gp_destList;
+   tPlotEndpoint* endpoint;
+   int retVal = -1;
+
+   if(hostName == NULL)
+      return -1;
+
+   endpoint = sendMemoryToPlot_findEndpoint(hostName, port);
+   if(endpoint == NULL)
+      return -1;
+
+   plotThreading_mutexLock(&gt_endpoints_mutex);
+   if(sendMemoryToPlot_isInDestList(*destList, endpoint))
+   {
+      retVal = 0; // Already a destination.
+   }
+   else if(*destList == NULL || (*destList)->i_numDests < MAX_PLOT_DESTINATIONS)
+   {
+      tPlotDestList* newList = sendMemoryToPlot_copyDestList(*destList, NULL);
+      if(newList != NULL)
+      {
+         // Senders read the list without the lock. Fill in the new copy before they can see it.
+         newList->ap_dests[newList->i_numDests++] = endpoint;
+         plotThreading_releaseStorePtr((void* volatile*)destList, newList);
+         retVal = 0;
+      }
+   }
+   plotThreading_mutexUnlock(&gt_endpoints_mutex);
+
+   return retVal;
+}
+
+int sendMemoryToPlot_removeDestination(tSendMemToPlot* _this, const char* hostName, unsigned short port)
+{
+   tPlotDestList* volatile* destList = _this != NULL ? &_this->p_destList : &gp_destList;
+   unsigned int destIndex;
+   int retVal = -1;
+
+   if(hostName == NULL)
+      return -1;
+
+   plotThreading_mutexLock(&gt_endpoints_mutex);
+   for(destIndex = 0; *destList != NULL && destIndex < (*destList)->i_numDests; ++destIndex)
+   {
+      tPlotEndpoint* dest = (*destList)->ap_dests[destIndex];
+      if(dest->s_ipPort == port && strcmp(dest->ac_ipAddr, hostName) == 0)
+      {
+         // The plots close their connections to the removed destination the next time they send.
+         tPlotDestList* newList = sendMemoryToPlot_copyDestList(*destList, dest);
+         if(newList != NULL)
+         {
+            plotThreading_releaseStorePtr((void* volatile*)destList, newList);
+            retVal = 0;
+         }
+         break;
+      }
+   }
+   plotThreading_mutexUnlock(&gt_endpoints_mutex);
+
+   return retVal;
+}
+
+void sendMemoryToPlot_getTotals(tSendMemToPlotTotals* totals)
+{
+   totals->i_msgsSent = plotThreading_atomicLoad(&g_totalMsgsSent);
+   totals->i_bytesSent = plotThreading_atomicLoad(&g_totalBytesSent);
+   totals->i_sendTimeNs = plotThreading_atomicLoad(&g_totalSendTimeNs);
+}
+
+void sendMemoryToPlot_getThreadTotals(tSendMemToPlotTotals* totals)
+{
+   *totals = gt_threadTotals;
+}
+
+void sendMemoryToPlot_getEncodeLatency(tSmartPlotLatencyStats* encodeLatency)
+{
+   plotStats_histSummary(&gt_encodeHist, encodeLatency);
+}
+
+unsigned int sendMemoryToPlot_getEndpointStats(tSmartPlotEndpointStats* endpoints, unsigned int maxEndpoints)
+{
+   unsigned int numEndpoints;
+   unsigned int endpointIndex;
+
+   plotThreading_mutexLock(&gt_endpoints_mutex);
+   numEndpoints = g_numEndpoints;
+   for(endpointIndex = 0; endpointIndex < numEndpoints && endpointIndex < maxEndpoints; ++endpointIndex)
+   {
+      const tPlotEndpoint* endpoint = gt_endpoints[endpointIndex];
+      tSmartPlotEndpointStats* stats = &endpoints[endpointIndex];
+
+      strToArray(stats->hostName, endpoint->ac_ipAddr);
+      stats->port = endpoint->s_ipPort;
+      stats->msgsSent = plotThreading_atomicLoad(&endpoint->i_msgsSent);
+      stats->bytesSent = plotThreading_atomicLoad(&endpoint->i_bytesSent);
+      stats->sendErrors = plotThreading_atomicLoad(&endpoint->i_sendErrors);
+      stats->connects = plotThreading_atomicLoad(&endpoint->i_connects);
+      stats->connectFailures = plotThreading_atomicLoad(&endpoint->i_connectFailures);
+      stats->connsReused = plotThreading_atomicLoad(&endpoint->i_connsReused);
+      plotStats_histSummary(&endpoint->t_sendHist, &stats->sendLatency);
+      plotStats_histSummary(&endpoint->t_connectHist, &stats->connectLatency);
+   }
+   plotThreading_mutexUnlock(&gt_endpoints_mutex);
+
+   return numEndpoints;
+}
+
 void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot* yAxis)
 {
    tSendMemToPlot* xAxis_sendMem = xAxis;
@@ -678,7 +1418,8 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
    unsigned int xAxis_readIndex = xAxis_sendMem->i_readIndex;
    PLOTTER_BOOL xAxis_contiguous = FALSE;
    unsigned int xAxis_stopIndexMsg1 = 0;
-   t1dPlot xAxis_plot;
+   unsigned int xAxis_numSamp = 0;
+   PlotMsgEncoder<E_UPDATE_1D_PLOT> xAxis_encoder(xAxis_sendMem->pc_plotName, xAxis_sendMem->pc_curveName, xAxis_sendMem->t_plotMem.e_dataType);
    unsigned int xAxis_plotMsg1Size = 0;
    unsigned int xAxis_plotMsg2Size = 0;
 
@@ -687,7 +1428,8 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
    unsigned int yAxis_readIndex = yAxis_sendMem->i_readIndex;
    PLOTTER_BOOL yAxis_contiguous = FALSE;
    unsigned int yAxis_stopIndexMsg1 = 0;
-   t1dPlot yAxis_plot;
+   unsigned int yAxis_numSamp = 0;
+   PlotMsgEncoder<E_UPDATE_1D_PLOT> yAxis_encoder(yAxis_sendMem->pc_plotName, yAxis_sendMem->pc_curveName, yAxis_sendMem->t_plotMem.e_dataType);
    unsigned int yAxis_plotMsg1Size = 0;
    unsigned int yAxis_plotMsg2Size = 0;
 
@@ -700,12 +1442,14 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
 
    unsigned int xAxis_dataToUseEndIndex = xAxis->i_writeIndex;
    unsigned int yAxis_dataToUseEndIndex = yAxis->i_writeIndex;
+   PLOTTER_UINT_64 encodeStartNs;
 
    // If there is no data to plot, return early.
    if(xAxis_numSampAvailable == 0 || yAxis_numSampAvailable == 0)
    {
       return;
    }
+   encodeStartNs = PLOT_STATS_TIME_NS();
 
    // Only plot min(numXSampAvailable, numYSampAvailable) number of samples.
    if(xAxis_numSampAvailable > yAxis_numSampAvailable)
@@ -730,10 +1474,6 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
    yAxis_writeIndex = yAxis_dataToUseEndIndex;
 
    // Determine the size of the X-Axis message(s)
-   xAxis_plot.curveName = xAxis_sendMem->pc_curveName;
-   xAxis_plot.plotName = xAxis_sendMem->pc_plotName;
-   xAxis_plot.yAxisType = xAxis_sendMem->t_plotMem.e_dataType;
-
    if(xAxis_writeIndex > xAxis_readIndex)
    {
       xAxis_contiguous = TRUE;
@@ -745,20 +1485,16 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
       xAxis_stopIndexMsg1 = xAxis_sendMem->t_plotMem.i_numSamples;
    }
 
-   xAxis_plot.numSamp = xAxis_stopIndexMsg1 - xAxis_readIndex;
-   xAxis_plotMsg1Size = getUpdatePlot1dMsgSize(&xAxis_plot);
+   xAxis_numSamp = xAxis_stopIndexMsg1 - xAxis_readIndex;
+   xAxis_plotMsg1Size = xAxis_encoder.msgSize(xAxis_numSamp);
 
    if(!xAxis_contiguous)
    {
-      xAxis_plot.numSamp = xAxis_writeIndex;
-      xAxis_plotMsg2Size = getUpdatePlot1dMsgSize(&xAxis_plot);
+      xAxis_numSamp = xAxis_writeIndex;
+      xAxis_plotMsg2Size = xAxis_encoder.msgSize(xAxis_numSamp);
    }
 
    // Determine the size of the Y-Axis message(s)
-   yAxis_plot.curveName = yAxis_sendMem->pc_curveName;
-   yAxis_plot.plotName = yAxis_sendMem->pc_plotName;
-   yAxis_plot.yAxisType = yAxis_sendMem->t_plotMem.e_dataType;
-
    if(yAxis_writeIndex > yAxis_readIndex)
    {
       yAxis_contiguous = TRUE;
@@ -770,19 +1506,20 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
       yAxis_stopIndexMsg1 = yAxis_sendMem->t_plotMem.i_numSamples;
    }
 
-   yAxis_plot.numSamp = yAxis_stopIndexMsg1 - yAxis_readIndex;
-   yAxis_plotMsg1Size = getUpdatePlot1dMsgSize(&yAxis_plot);
+   yAxis_numSamp = yAxis_stopIndexMsg1 - yAxis_readIndex;
+   yAxis_plotMsg1Size = yAxis_encoder.msgSize(yAxis_numSamp);
 
    if(!yAxis_contiguous)
    {
-      yAxis_plot.numSamp = yAxis_writeIndex;
-      yAxis_plotMsg2Size = getUpdatePlot1dMsgSize(&yAxis_plot);
+      yAxis_numSamp = yAxis_writeIndex;
+      yAxis_plotMsg2Size = yAxis_encoder.msgSize(yAxis_numSamp);
    }
 
    // Pack and send the final message.
    {
+      // Max size. Packed samples can make the messages smaller, so each message is packed right after the previous one.
       unsigned int newMsgSize = GROUP_MSG_HEADER_SIZE + xAxis_plotMsg1Size + xAxis_plotMsg2Size + yAxis_plotMsg1Size + yAxis_plotMsg2Size;
-      char *msgX1, *msgX2, *msgY1, *msgY2;
+      char* msgPtr;
 
       unsigned int dataIndex = 0;
       int temp = E_MULPITLE_PLOTS;
@@ -791,58 +1528,45 @@ void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot*
       if(NULL == multiPlotMsg)
          return;
 
-      msgX1 = multiPlotMsg + GROUP_MSG_HEADER_SIZE;
-      msgX2 = msgX1 + xAxis_plotMsg1Size;
-      msgY1 = msgX2 + xAxis_plotMsg2Size;
-      msgY2 = msgY1 + yAxis_plotMsg1Size;
-
-      // Pack the Header.
-      memcpy(&multiPlotMsg[0], &temp, 4);
-      memcpy(&multiPlotMsg[4], &newMsgSize, 4);
+      msgPtr = multiPlotMsg + GROUP_MSG_HEADER_SIZE;
 
       // Pack X-Axis
-      xAxis_plot.numSamp = xAxis_stopIndexMsg1 - xAxis_readIndex;
-      dataIndex = packUpdate1dPlotMsg_withoutData(&xAxis_plot, xAxis_readIndex, msgX1);
-      packArrayOfStructs( msgX1+dataIndex,
-                          xAxis_sendMem->t_plotMem.pc_memory + (xAxis_sendMem->t_plotMem.i_bytesBetweenValues*xAxis_readIndex),
-                          xAxis_plot.numSamp,
-                          xAxis_sendMem->t_plotMem.i_dataSizeBytes,
-                          xAxis_sendMem->t_plotMem.i_bytesBetweenValues );
+      xAxis_numSamp = xAxis_stopIndexMsg1 - xAxis_readIndex;
+      dataIndex = xAxis_encoder.pack(msgPtr, xAxis_numSamp, xAxis_readIndex);
+      dataIndex += packPlotMemSamples(msgPtr+dataIndex, &xAxis_sendMem->t_plotMem, xAxis_readIndex, xAxis_numSamp);
+      msgPtr += xAxis_encoder.finish(msgPtr, dataIndex);
 
       if(xAxis_plotMsg2Size > 0)
       {
-         xAxis_plot.numSamp = xAxis_writeIndex;
-         dataIndex = packUpdate1dPlotMsg_withoutData(&xAxis_plot, 0, msgX2);
-         packArrayOfStructs( msgX2+dataIndex,
-                             xAxis_sendMem->t_plotMem.pc_memory,
-                             xAxis_plot.numSamp,
-                             xAxis_sendMem->t_plotMem.i_dataSizeBytes,
-                             xAxis_sendMem->t_plotMem.i_bytesBetweenValues );
+         xAxis_numSamp = xAxis_writeIndex;
+         dataIndex = xAxis_encoder.pack(msgPtr, xAxis_numSamp, 0);
+         dataIndex += packPlotMemSamples(msgPtr+dataIndex, &xAxis_sendMem->t_plotMem, 0, xAxis_numSamp);
+         msgPtr += xAxis_encoder.finish(msgPtr, dataIndex);
       }
       xAxis_sendMem->i_readIndex = xAxis_writeIndex;
 
 
       // Pack Y-Axis
-      yAxis_plot.numSamp = yAxis_stopIndexMsg1 - yAxis_readIndex;
-      dataIndex = packUpdate1dPlotMsg_withoutData(&yAxis_plot, yAxis_readIndex, msgY1);
-      packArrayOfStructs( msgY1+dataIndex,
-                          yAxis_sendMem->t_plotMem.pc_memory + (yAxis_sendMem->t_plotMem.i_bytesBetweenValues*yAxis_readIndex),
-                          yAxis_plot.numSamp,
-                          yAxis_sendMem->t_plotMem.i_dataSizeBytes,
-                          yAxis_sendMem->t_plotMem.i_bytesBetweenValues );
+      yAxis_numSamp = yAxis_stopIndexMsg1 - yAxis_readIndex;
+      dataIndex = yAxis_encoder.pack(msgPtr, yAxis_numSamp, yAxis_readIndex);
+      dataIndex += packPlotMemSamples(msgPtr+dataIndex, &yAxis_sendMem->t_plotMem, yAxis_readIndex, yAxis_numSamp);
+      msgPtr += yAxis_encoder.finish(msgPtr, dataIndex);
 
       if(yAxis_plotMsg2Size > 0)
       {
-         yAxis_plot.numSamp = yAxis_writeIndex;
-         dataIndex = packUpdate1dPlotMsg_withoutData(&yAxis_plot, 0, msgY2);
-         packArrayOfStructs( msgY2+dataIndex,
-                             yAxis_sendMem->t_plotMem.pc_memory,
-                             yAxis_plot.numSamp,
-                             yAxis_sendMem->t_plotMem.i_dataSizeBytes,
-                             yAxis_sendMem->t_plotMem.i_bytesBetweenValues );
+         yAxis_numSamp = yAxis_writeIndex;
+         dataIndex = yAxis_encoder.pack(msgPtr, yAxis_numSamp, 0);
+         dataIndex += packPlotMemSamples(msgPtr+dataIndex, &yAxis_sendMem->t_plotMem, 0, yAxis_numSamp);
+         msgPtr += yAxis_encoder.finish(msgPtr, dataIndex);
       }
       yAxis_sendMem->i_readIndex = yAxis_writeIndex;
 
+      // Pack the Header.
+      newMsgSize = (unsigned int)(msgPtr - multiPlotMsg);
+      memcpy(&multiPlotMsg[0], &temp, 4);
+      memcpy(&multiPlotMsg[4], &newMsgSize, 4);
+
+      plotStats_histAdd(&gt_encodeHist, PLOT_STATS_TIME_NS() - encodeStartNs);
       sendPlotPacket(xAxis, multiPlotMsg, newMsgSize, 0);
 
       free(multiPlotMsg);
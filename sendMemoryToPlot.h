@@ -25,7 +25,8 @@
 //*****************************************************************************
 // Constants
 //*****************************************************************************
-#define MAX_IP_ADDR_STRING_SIZE (50) // Enough for IPv6. If not enough for string names it can be increased
+#define MAX_PLOT_DESTINATIONS (8) // Max number of extra destinations for a plot (and for the whole process).
+#define MAX_IP_ADDR_STRING_SIZE (128) // Enough for IPv6 and short file:// paths. If not enough for string names it can be increased
 #define MAX_PLOT_CURVE_STRING_SIZE (50)
 
 
@@ -45,6 +46,8 @@ typedef struct
 
    PLOTTER_BOOL   b_arrayOfStructs;
    unsigned int   i_bytesBetweenValues;
+
+   PLOTTER_BOOL   b_mirrored; // Sample i + i_numSamples is the same memory as sample i (see plotRingMem.h).
 }tPlotMemory;
 
 // tSendMemToPlot defines all the information about creating plot messages.
@@ -52,14 +55,16 @@ typedef struct
 // the actual data to be plotted (tPlotMemory), and infomation such as the
 // IP/port of the plotting GUI, Plot Name, Curve Name, circular buffer pointers
 // (if used) and timer information (if the plot is to be updated on an interval).
+//
+// The samples are usually written by one thread and sent by another, so the write
+// index and the state the sender changes are on cache lines of their own, away from
+// the configuration that both threads only read.
 typedef struct
 {
    tPlotMemory t_plotMem; // Y axis for 1D, X & Y axis for 2D interleaved, X axis for 2D non-interleaved
    tPlotMemory t_plotMem_separateYAxis; // Y axis for 2D non-interleaved
 
    PLOTTER_BOOL b_useReadWriteIndex;
-   unsigned int i_readIndex;
-   unsigned int i_writeIndex;
 
    const char* pc_ipAddr;
    unsigned short s_ipPort;
@@ -67,17 +72,58 @@ typedef struct
    const char* pc_plotName;
    const char* pc_curveName;
 
+   // Don't hold on to a connection between messages. Each message borrows an idle connection
+   // to the PlotGUI from a pool that is shared by every plot, so this doesn't mean a new
+   // connection per message.
    PLOTTER_BOOL b_closeSocketAfterSend;
 
-   int i_tcpSocketFd;
+   // Stats. The curve stats are optional, set after sendMemoryToPlot_Init to count this curve's messages.
+   struct plotCurveStats* p_curveStats;
+
+   // Extra PlotGUIs / sinks that get a copy of this plot's messages. See sendMemoryToPlot_addDestination.
+   // NULL until the first one is added.
+   struct plotDestList* volatile p_destList;
 
    // Full copys of the strings. Usefull when using printf to generate string values.
    char ac_ipAddr[MAX_IP_ADDR_STRING_SIZE];
    char ac_plotName[MAX_PLOT_CURVE_STRING_SIZE];
    char ac_curveName[MAX_PLOT_CURVE_STRING_SIZE];
 
+   // Written by the thread that writes the samples.
+   char ac_padWriter[PLOTTER_CACHE_LINE_SIZE];
+   unsigned int i_writeIndex;
+
+   // Written by the thread that sends the messages. The endpoint is looked up the first time a message is sent.
+   char ac_padSender[PLOTTER_CACHE_LINE_SIZE];
+   unsigned int i_readIndex;
+   int i_tcpSocketFd;
+   struct plotEndpoint* p_endpoint;
+   struct plotDestConn* p_destConns; // Connections to the extra destinations. Allocated on the first send to one.
+   const struct plotDestList* p_destConnsProcessList; // The destination lists p_destConns was last checked against.
+   const struct plotDestList* p_destConnsPlotList;
 }tSendMemToPlot;
 
+// tSendMemToPlotTotals holds running totals of everything that has actually been
+// handed to the TCP layer (grouped messages are counted once, when the group is sent).
+typedef struct
+{
+   PLOTTER_UINT_64 i_msgsSent;
+   PLOTTER_UINT_64 i_bytesSent;
+   PLOTTER_UINT_64 i_sendTimeNs; // Total time spent in connect / send calls.
+}tSendMemToPlotTotals;
+
+// tPlotMsgGroup holds plot messages that are being combined into one big group
+// message. The group message is sent via p_sendVia (i.e. its host / port and TCP
+// socket). If p_sendVia is NULL, the connection of the first message added is used.
+typedef struct
+{
+   char*           pc_memory;
+   unsigned int    i_curSize;
+   unsigned int    i_capacity;
+   tSendMemToPlot* p_sendVia;
+   tSendMemToPlot* p_sendMem;
+}tPlotMsgGroup;
+
 //*****************************************************************************
 // Prototypes
 //*****************************************************************************
@@ -102,9 +148,44 @@ void sendMemoryToPlot_Update2D(tSendMemToPlot* _this);
 void sendMemoryToPlot_Update2D_Interleaved(tSendMemToPlot* _this);
 void sendMemoryToPlot_Interleaved1DPlots(tSendMemToPlot* xAxis, tSendMemToPlot* yAxis);
 
+// Sends a Create message for all of the plot memory, straight from that memory (the
+// samples are never copied into a message buffer, unless they are an array of structs).
+// The message is never grouped, and this doesn't return until the samples have been
+// handed to the socket, so the memory can be reused as soon as it returns.
+// Returns 0 on success.
+int sendMemoryToPlot_Borrowed(tSendMemToPlot* _this);
+
+// Hands the plot's connection back to the pool, so another plot sending to the same
+// PlotGUI can use it. Call this instead of closing i_tcpSocketFd when done with the plot.
+void sendMemoryToPlot_Release(tSendMemToPlot* _this);
+
+// See smartPlot_registerSink.
+int sendMemoryToPlot_registerSink(const char* scheme, const tSmartPlotSink* sink);
+
+// Sends a copy of every message the plot sends to another host / port as well (_this NULL
+// means every plot). The message is encoded once and the same bytes go to every destination.
+// Returns 0 on success.
+int sendMemoryToPlot_addDestination(tSendMemToPlot* _this, const char* hostName, unsigned short port);
+int sendMemoryToPlot_removeDestination(tSendMemToPlot* _this, const char* hostName, unsigned short port);
+
+// Group messages are per thread. Between plotMsgGroupStart and plotMsgGroupEnd, the plot
+// messages generated on the calling thread are grouped together. Other threads are not
+// affected. Calls can be nested, the group is sent by the outermost plotMsgGroupEnd.
 void plotMsgGroupStart();
 void plotMsgGroupEnd();
 
+// Groups that are owned by a specific thread (e.g. a flush worker). Selecting a group
+// routes all plot messages generated on the calling thread into that group.
+// Select NULL to go back to normal sending.
+void plotMsgGroupInit(tPlotMsgGroup* group, tSendMemToPlot* sendVia);
+void plotMsgGroupSelect(tPlotMsgGroup* group);
+void plotMsgGroupSend(tPlotMsgGroup* group);
+
+void sendMemoryToPlot_getTotals(tSendMemToPlotTotals* totals);
+void sendMemoryToPlot_getThreadTotals(tSendMemToPlotTotals* totals); // Only what the calling thread has sent.
+void sendMemoryToPlot_getEncodeLatency(tSmartPlotLatencyStats* encodeLatency);
+unsigned int sendMemoryToPlot_getEndpointStats(tSmartPlotEndpointStats* endpoints, unsigned int maxEndpoints);
+
 #ifdef __cplusplus
 }
 #endif
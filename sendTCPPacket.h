@@ -51,6 +51,7 @@
    #include <sys/types.h>
    #include <netinet/in.h>
    #include <sys/socket.h>
+   #include <sys/uio.h>
 
    #ifndef SOCKET
       #define SOCKET int
@@ -61,6 +62,15 @@
 #endif
 
 
+#define SEND_TCP_MAX_BUFFS (8) // Max number of buffers in a single sendTCPPacket_sendv call.
+
+// A piece of a message for scatter / gather sends.
+typedef struct
+{
+   const char*  pc_data;
+   unsigned int i_size;
+}tSendTCPBuff;
+
 // Define Macro for determining if a Socket FD is valid.
 #ifndef IS_VALID_SOCKET_FD
 #define IS_VALID_SOCKET_FD(socketFd) ((signed)socketFd >= 0)
@@ -154,11 +164,100 @@ static inline int sendTCPPacket_send(SOCKET sockfd, const char* msg, unsigned in
    return send(sockfd, msg, msgSize, 0);
 }
 
+// Sends the buffers back to back as one message, straight from the caller's memory.
+// Doesn't return until every byte has been handed to the socket (or there is an error).
+// Returns the number of bytes sent, -1 on error.
+static inline int sendTCPPacket_sendv(SOCKET sockfd, const tSendTCPBuff* buffs, unsigned int numBuffs)
+{
+   unsigned int buffIndex = 0;
+   unsigned int buffOffset = 0; // Bytes of buffs[buffIndex] that have already been sent.
+   unsigned int totalSent = 0;
+
+   if(numBuffs > SEND_TCP_MAX_BUFFS)
+   {
+      return -1;
+   }
+
+   while(buffIndex < numBuffs)
+   {
+      unsigned int numVec = 0;
+      unsigned int i;
+#ifdef SEND_MSG_TCP_WIN_BUILD
+      WSABUF vec[SEND_TCP_MAX_BUFFS];
+      DWORD numSent = 0;
+      for(i = buffIndex; i < numBuffs; ++i, ++numVec)
+      {
+         unsigned int offset = i == buffIndex ? buffOffset : 0;
+         vec[numVec].buf = (char*)buffs[i].pc_data + offset;
+         vec[numVec].len = buffs[i].i_size - offset;
+      }
+      if(WSASend(sockfd, vec, numVec, &numSent, 0, NULL, NULL) != 0)
+      {
+         return -1;
+      }
+#else
+      struct iovec vec[SEND_TCP_MAX_BUFFS];
+      struct msghdr msg;
+      ssize_t numSent;
+      for(i = buffIndex; i < numBuffs; ++i, ++numVec)
+      {
+         unsigned int offset = i == buffIndex ? buffOffset : 0;
+         vec[numVec].iov_base = (void*)(buffs[i].pc_data + offset);
+         vec[numVec].iov_len = buffs[i].i_size - offset;
+      }
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = vec;
+      msg.msg_iovlen = numVec;
+#ifdef MSG_NOSIGNAL
+      numSent = sendmsg(sockfd, &msg, MSG_NOSIGNAL); // A closed connection is an error, not a SIGPIPE.
+#else
+      numSent = sendmsg(sockfd, &msg, 0);
+#endif
+      if(numSent < 0)
+      {
+         return -1;
+      }
+#endif
+      totalSent += (unsigned int)numSent;
+
+      // Step past everything that was sent (a blocking socket can still send less than asked for).
+      buffOffset += (unsigned int)numSent;
+      while(buffIndex < numBuffs && buffOffset >= buffs[buffIndex].i_size)
+      {
+         buffOffset -= buffs[buffIndex].i_size;
+         buffIndex++;
+      }
+   }
+   return (int)totalSent;
+}
+
 static inline int sendTCPPacket_close(SOCKET sockfd)
 {
    return closesocket(sockfd);
 }
 
+// Checks if a connection that has been sitting idle was closed by the other end.
+// Doesn't block. Returns 0 if the connection is closed (or broken).
+static inline int sendTCPPacket_isOpen(SOCKET sockfd)
+{
+   fd_set readFds;
+   struct timeval timeout;
+   char peekByte;
+
+   FD_ZERO(&readFds);
+   FD_SET(sockfd, &readFds);
+   timeout.tv_sec = 0;
+   timeout.tv_usec = 0;
+
+   if(select((int)sockfd + 1, &readFds, NULL, NULL, &timeout) <= 0)
+   {
+      return 1; // Nothing to read, so nothing has closed it.
+   }
+
+   // Readable means closed, unless the other end sent something.
+   return recv(sockfd, &peekByte, 1, MSG_PEEK) > 0;
+}
+
 static inline int sendTCPPacket(const char* hostName, unsigned short port, const char* msg, unsigned int msgSize)
 {
    int success = 0;
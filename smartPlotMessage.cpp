@@ -17,6 +17,7 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -24,7 +25,9 @@
 #include "smartPlotMessage.h"
 #include "timePlot.h" // Some functions are defined in this header.
 #include "plotThreading.h"
-#include "sendTCPPacket.h"
+#include "plotStats.h"
+#include "plotClock.h"
+#include "plotRingMem.h"
 
 #ifdef TIME_PLOT_WINDOWS
 #include <windows.h>
@@ -38,19 +41,132 @@
 //*****************************************************************************
 #define GROUP_INTERLEAVED_PLOT_MSGS
 
+//*****************************************************************************
+// Constants
+//*****************************************************************************
+// Tuning for the adaptive flush period. The period is lengthened when a flush sends
+// at least ADAPTIVE_FLUSH_BUSY_BYTES and the cost of sending each byte is rising
+// (i.e. the link / PlotGUI is starting to back up). The period is shortened when a
+// flush sends less than ADAPTIVE_FLUSH_IDLE_BYTES.
+#define ADAPTIVE_FLUSH_BUSY_BYTES (256*1024)
+#define ADAPTIVE_FLUSH_IDLE_BYTES (16*1024)
+#define ADAPTIVE_FLUSH_RISE_RATIO (1.1) // Newest measurement must be 10% above the smoothed value to count as rising.
+#define ADAPTIVE_FLUSH_SMOOTHING  (0.25) // Weight of the newest measurement in the smoothed values.
+#define ADAPTIVE_FLUSH_MIN_PERIOD_MS (1) // A period of 0 would busy-spin the flush thread.
+
+#define MAX_FLUSH_WORKER_ENDPOINTS (8) // Max number of PlotGUIs a single flush worker will keep connections to.
+
+#define MAX_TELEMETRY_ENDPOINTS (8) // Max number of PlotGUIs telemetry curves are published for.
+#define TELEMETRY_CURVE_NAME_SIZE (SMART_PLOT_STATS_NAME_SIZE + 32)
+
+#define NAME_HASH_INIT  (2166136261u) // FNV-1a offset basis
+#define NAME_HASH_PRIME (16777619u)   // FNV-1a prime
+
+#define SMART_PLOT_NOT_REGISTERED (0xFFFFFFFFu) // Registry index of a curve the flush threads don't visit.
+#define SMART_PLOT_REGISTRY_MIN_CAPACITY (64)
+
 //*****************************************************************************
 // Types
 //*****************************************************************************
+// A curve. The fields that are rarely written come first, then cur (which ends with the write
+// index and the state the flush threads change, each on cache lines of their own), then the
+// rest of the state the flush threads change, then the rest of the state the writer changes.
 typedef struct smartPlotListElem
 {
    struct smartPlotListElem* prev;
-   tSendMemToPlot cur;
    struct smartPlotListElem* next;
 
    struct smartPlotListElem* interleavedPair;
    PLOTTER_BOOL interleaved_isXAxis;
+
+   unsigned int i_nameHash;     // Hash of the plot / curve name. Used to assign the curve to a flush worker.
+   unsigned int i_endpointHash; // Hash of the PlotGUI's address. Used to assign the curve to a flush worker.
+   unsigned int i_registryIndex; // Index in gt_flushRegistry. SMART_PLOT_NOT_REGISTERED if it isn't in it.
+
+   // Number of samples - 1 if the circular buffer's size is a power of two, so the indexes wrap
+   // with a mask (see smartPlot_enablePow2Capacity). 0 otherwise.
+   unsigned int i_indexMask;
+
+   // Write index of a registered external circular buffer. NULL if smartPlot owns the
+   // curve's memory. External memory is never written to, resized or freed by smartPlot.
+   const volatile unsigned int* p_extWriteIndex;
+
+   // Memory budget (see smartPlot_setMemoryBudget).
+   size_t i_memBytes;             // Circular buffer bytes smartPlot allocated. The X Axis holds an interleaved pair's bytes.
+   PLOTTER_BOOL b_pinned;         // A handle to the curve has been given out, so it is never evicted.
+
+   // Next curve in the list of curves that have been removed, but not freed yet.
+   struct smartPlotListElem* p_nextRetired;
+
+   // Non-zero once the curve's memory and connection have been set up. Curves are added to the
+   // list before that, so the flush threads skip curves that aren't ready. Also cleared while
+   // the curve's circular buffer is being resized.
+   volatile unsigned int i_ready;
+
+   tSendMemToPlot cur;
+
+   // Written by the flush threads.
+   tPlotAtomicU64 i_numFlushing; // Number of flush threads currently flushing the curve.
+
+   // Written by the thread that writes the samples. t_stats starts with the writer's counters.
+   char ac_padWriter[PLOTTER_CACHE_LINE_SIZE];
+   PLOTTER_UINT_64 i_lastWriteNs; // Used to find the least recently written curve (memory budget).
+   tPlotAtomicU64 i_numWriting;   // Number of writes that looked the curve up by name and haven't finished (see smartPlot_doneWriting).
+   tPlotCurveStats t_stats;
 }tSmartPlotListElem;
 
+// The curves the flush threads visit, as a struct of arrays. Interleaved pairs are only in it
+// via their X Axis. A flush worker's scan only reads the hashes to find the curves it owns, it
+// doesn't touch the curves that belong to other workers. Guarded by gt_smartPlotList_mutex.
+typedef struct
+{
+   struct smartPlotListElem** pp_listElems;
+   unsigned int* pi_nameHashes;
+   unsigned int* pi_endpointHashes;
+   unsigned int i_numCurves;
+   unsigned int i_capacity;
+}tSmartPlotRegistry;
+
+// A flush worker's connection to a single PlotGUI. Each worker has its own sockets and
+// builds its own group messages, so the workers never have to wait on each other.
+typedef struct
+{
+   tSendMemToPlot t_sendMem;
+   tPlotMsgGroup t_group;
+}tSmartPlotWorkerConn;
+
+// One thread in the flush pool. Worker N flushes all the curves whose hash maps
+// to N (see smartPlot_shardIndex).
+typedef struct
+{
+   unsigned int i_workerIndex;
+   unsigned int i_numWorkers;
+   PLOTTER_BOOL b_shardByEndpoint;
+
+   unsigned int i_numConns;
+   tSmartPlotWorkerConn at_conns[MAX_FLUSH_WORKER_ENDPOINTS];
+
+   // The curves the worker owns, copied out of gt_flushRegistry at the start of each flush.
+   struct smartPlotListElem** pp_scan;
+   unsigned int i_scanCapacity;
+
+   // The worker's own flush measurements. Guarded by gt_plotThread_stats_mutex.
+   tSmartPlotFlushStats t_flushStats;
+}tSmartPlotFlushWorker;
+
+// State for publishing telemetry curves. Only ever accessed from the thread that publishes.
+typedef struct
+{
+   PLOTTER_UINT_64 i_lastPublishNs;
+   PLOTTER_UINT_64 i_lastSamplesOverwritten;
+   PLOTTER_UINT_64 ai_lastEndpointBytes[MAX_TELEMETRY_ENDPOINTS];
+   unsigned int i_numEndpoints;
+
+   // Names of the per endpoint curves. Only built once per endpoint, smartPlot copies the names.
+   char aac_bytesPerSecNames[MAX_TELEMETRY_ENDPOINTS][TELEMETRY_CURVE_NAME_SIZE];
+   char aac_reconnectNames[MAX_TELEMETRY_ENDPOINTS][TELEMETRY_CURVE_NAME_SIZE];
+}tSmartPlotTelemetry;
+
 //*****************************************************************************
 // Globals
 //*****************************************************************************
@@ -61,6 +177,31 @@ static tSmartPlotListElem* gt_smartPlotList = NULL;
 
 static CREATE_PLOT_MUTEX(gt_smartPlotList_mutex);
 
+// Curves that have been removed from the list, but might still be being flushed. They are
+// freed once no flushes are in progress. Guarded by gt_smartPlotList_mutex.
+static tSmartPlotListElem* gt_retiredList = NULL;
+static unsigned int g_numFlushesInProgress = 0;
+
+// The curves the flush workers visit. Guarded by gt_smartPlotList_mutex.
+static tSmartPlotRegistry gt_flushRegistry = {NULL, NULL, NULL, 0, 0};
+
+// Memory budget for the curves' circular buffers. A max of 0 means unlimited.
+// Guarded by gt_smartPlotList_mutex (the max is also read when stamping writes).
+static volatile PLOTTER_UINT_64 g_memBudget_maxBytes = 0;
+static PLOTTER_UINT_64 g_memBudget_minIdleNs = 0;
+static PLOTTER_UINT_64 g_memBudget_usedBytes = 0;
+static PLOTTER_UINT_64 g_memBudget_numEvicted = 0;
+
+// Allocator for the curves' circular buffers (see plotRingMem.h). Guarded by gt_smartPlotList_mutex.
+static size_t g_ringMem_mmapThresholdBytes = 0;
+static int g_ringMem_flags = 0;
+static tSmartPlotRingAlloc g_ringMem_allocFunc = NULL;
+static tSmartPlotRingFree g_ringMem_freeFunc = NULL;
+static void* g_ringMem_userData = NULL;
+
+// Non-zero to round the size of new / resized curves up to a power of two (see smartPlot_enablePow2Capacity).
+static volatile int g_pow2Capacity_enabled = 0;
+
 static char g_plotHostName[MAX_IP_ADDR_STRING_SIZE] = "plotter";
 static unsigned short g_plotPort = 2000;
 
@@ -68,6 +209,31 @@ static unsigned short g_plotPort = 2000;
 // Parameters for dealing with the background plot thread.
 static PLOTTER_BOOL g_plotThread_created = FALSE;
 static unsigned int g_plotThread_defaultTimeMs = 250;
+static unsigned int g_plotThread_adaptiveMinTimeMs = 0;
+static unsigned int g_plotThread_adaptiveMaxTimeMs = 0;
+
+static tSmartPlotFlushStats gt_plotThread_stats;
+static CREATE_PLOT_MUTEX(gt_plotThread_stats_mutex);
+
+// Telemetry curves. A publish period of 0 means telemetry is disabled.
+static unsigned int g_telemetry_periodMs = 0;
+static int g_telemetry_plotSize = 0;
+static tSmartPlotTelemetry gt_telemetry;
+
+// Index of the calling thread for per thread duration curves. -1 until the thread first needs it.
+static PLOT_THREAD_LOCAL int g_timePlot_threadIndex = -1;
+static int g_timePlot_numThreads = 0;
+
+// Fast clock calibration (see plotClock.h). Ticks are converted relative to the latest
+// calibration point, using the rate measured since the first calibration point.
+static volatile int g_fastClock_enabled = 0;
+static CREATE_PLOT_MUTEX(gt_fastClock_mutex);
+static PLOTTER_BOOL g_fastClock_calibrated = FALSE;
+static PLOTTER_UINT_64 g_fastClock_startTicks = 0;
+static PLOTTER_UINT_64 g_fastClock_startNs = 0;
+static PLOTTER_UINT_64 g_fastClock_baseTicks = 0;
+static PLOTTER_UINT_64 g_fastClock_baseNs = 0;
+static double g_fastClock_nsPerTick = 0.0;
 
 #ifdef PLOTTER_FORCE_BACKGROUND_THREAD
 static PLOTTER_BOOL g_plotThread_forcePlotToThread = TRUE;
@@ -79,6 +245,20 @@ static PLOTTER_BOOL g_plotThread_forcePlotToThread = FALSE;
 //*****************************************************************************
 // Local Functions
 //*****************************************************************************
+static void smartPlot_flushListElem(tSmartPlotListElem* listElem);
+static PLOTTER_BOOL smartPlot_registryAdd(tSmartPlotListElem* listElem);
+static void smartPlot_registryRemove(tSmartPlotListElem* listElem);
+
+static unsigned int smartPlot_hashString(unsigned int hash, const char* str)
+{
+   while(*str != '\0')
+   {
+      hash ^= (unsigned char)*str++;
+      hash *= NAME_HASH_PRIME;
+   }
+   return hash;
+}
+
 static tSmartPlotListElem* smartPlot_findListElem(const char* plotName, const char* curveName)
 {
    tSmartPlotListElem* listElem = NULL;
@@ -118,7 +298,7 @@ static PLOTTER_BOOL smartPlot_find(const char* plotName, const char* curveName,
       newPlot = TRUE;
       if(allowNewPlot)
       {
-         tSmartPlotListElem* newListElem = (tSmartPlotListElem*)malloc(sizeof(tSmartPlotListElem));
+         tSmartPlotListElem* newListElem = (tSmartPlotListElem*)calloc(1, sizeof(tSmartPlotListElem));
 
          if(newListElem != NULL)
          {
@@ -127,7 +307,19 @@ static PLOTTER_BOOL smartPlot_find(const char* plotName, const char* curveName,
             newListElem->cur.pc_plotName = plotName;
 
             newListElem->interleavedPair = NULL;
+            newListElem->i_nameHash = smartPlot_hashString(smartPlot_hashString(NAME_HASH_INIT, plotName), curveName);
+            newListElem->i_endpointHash = (smartPlot_hashString(NAME_HASH_INIT, g_plotHostName) ^ g_plotPort) * NAME_HASH_PRIME;
+            plotStats_curveStatsInit(&newListElem->t_stats);
+         }
+
+         if(newListElem != NULL && !smartPlot_registryAdd(newListElem))
+         {
+            free(newListElem);
+            newListElem = NULL;
+         }
 
+         if(newListElem != NULL)
+         {
             // Update list.
             if(gt_smartPlotList == NULL)
             {
@@ -149,166 +341,917 @@ static PLOTTER_BOOL smartPlot_find(const char* plotName, const char* curveName,
       }
    }
 
+   // The curve can't be evicted / freed until the caller is done writing it. Counted while the
+   // list is locked, so eviction sees every write that could reach the curve.
+   if(*retListElem != NULL)
+   {
+      plotThreading_atomicAdd(&(*retListElem)->i_numWriting, 1);
+   }
+
    plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
 
    return newPlot;
 }
 
-static void* smartPlot_flushThread(void* p_threadParams)
+// Number of samples that can be copied into a circular buffer, starting at writeIndex, with one memcpy.
+static inline int smartPlot_numSampToEnd(const tPlotMemory* plotMem, int writeIndex)
 {
-   tPlotThreadParams threadParams = *((tPlotThreadParams*)p_threadParams);
+   // A mirrored buffer is mapped twice, so a copy that runs off the end lands at the start.
+   return plotMem->b_mirrored ? (int)plotMem->i_numSamples : (int)plotMem->i_numSamples - writeIndex;
+}
 
-#ifdef PLOTTER_PTHREADS_AVAILABLE
-   pthread_t thisPthread = pthread_self();
+static inline unsigned int smartPlot_indexMask(unsigned int numSamples)
+{
+   return (numSamples > 1 && (numSamples & (numSamples - 1)) == 0) ? numSamples - 1 : 0;
+}
 
-   // Set Priority / Policy
-   if(threadParams.setPriorityPolicy)
+// Rounds a plot size up to a power of two, if enabled.
+static int smartPlot_capacity(int plotSize)
+{
+   int capacity = 1;
+   if(!g_pow2Capacity_enabled || plotSize <= 0 || plotSize > (1 << 30))
+      return plotSize;
+   while(capacity < plotSize)
+      capacity <<= 1;
+   return capacity;
+}
+
+// Number of samples that have been written, but not sent.
+static inline int smartPlot_numSampUnsent(const tSmartPlotListElem* listElem)
+{
+   const tSendMemToPlot* plot = &listElem->cur;
+   int numSampUnsent;
+
+   if(listElem->i_indexMask != 0)
+      return (int)((plot->i_writeIndex - plot->i_readIndex) & listElem->i_indexMask);
+
+   numSampUnsent = (int)plot->i_writeIndex - (int)plot->i_readIndex;
+   if(numSampUnsent < 0)
+      numSampUnsent += plot->t_plotMem.i_numSamples;
+   return numSampUnsent;
+}
+
+// Copies numSamp samples into a power of two sized circular buffer, starting at writeIndex.
+// It's at most 2 memcpys, samples that would just be overwritten by newer ones aren't copied.
+// Returns the new write index.
+static unsigned int smartPlot_writeMasked(const tPlotMemory* plotMem, unsigned int mask, unsigned int writeIndex, const char* src, unsigned int numSamp)
+{
+   unsigned int sampSize = plotMem->i_bytesBetweenValues;
+   unsigned int newWriteIndex = (writeIndex + numSamp) & mask;
+   unsigned int numSampToEnd;
+   unsigned int numSampFirst;
+
+   if(numSamp == 0)
+      return writeIndex;
+
+   if(numSamp > mask + 1)
    {
-      struct sched_param schedParam;
-      schedParam.sched_priority = threadParams.priority;
-      pthread_setschedparam(thisPthread, threadParams.policy, &schedParam);
+      // The newest mask + 1 samples fill the whole buffer, starting at the new write index.
+      src += (size_t)(numSamp - (mask + 1)) * sampSize;
+      numSamp = mask + 1;
+      writeIndex = newWriteIndex;
    }
-#endif
 
-   while(1)
+   numSampToEnd = plotMem->b_mirrored ? numSamp : mask + 1 - writeIndex;
+   numSampFirst = numSamp < numSampToEnd ? numSamp : numSampToEnd;
+   memcpy(plotMem->pc_memory + (size_t)writeIndex * sampSize, src, (size_t)numSampFirst * sampSize);
+   if(numSampFirst < numSamp)
    {
-#ifdef PLOTTER_WINDOWS_BUILD
-      Sleep(threadParams.timeBetweenMs);
-#else
-      usleep(threadParams.timeBetweenMs*1000);
-#endif
-      smartPlot_flush_all();
+      memcpy(plotMem->pc_memory, src + (size_t)numSampFirst * sampSize, (size_t)(numSamp - numSampFirst) * sampSize);
    }
-   return NULL;
+   return newWriteIndex;
 }
 
-static void smartPlot_autoStartThread(int* updateSize)
+// Allocates a circular buffer. Free with plotRingMem_free.
+static char* smartPlot_allocRing(size_t numBytes)
 {
-   if(g_plotThread_forcePlotToThread)
+   size_t mmapThresholdBytes;
+   int flags;
+   tSmartPlotRingAlloc allocFunc;
+   tSmartPlotRingFree freeFunc;
+   void* userData;
+
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   mmapThresholdBytes = g_ringMem_mmapThresholdBytes;
+   flags = g_ringMem_flags;
+   allocFunc = g_ringMem_allocFunc;
+   freeFunc = g_ringMem_freeFunc;
+   userData = g_ringMem_userData;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+
+   // Prefaulting a large buffer can take a while, so don't hold the list lock while allocating.
+   return plotRingMem_alloc(numBytes, mmapThresholdBytes, flags, allocFunc, freeFunc, userData);
+}
+
+// Adds a curve to gt_flushRegistry. gt_smartPlotList_mutex must be locked.
+// Returns FALSE if the registry couldn't be grown.
+static PLOTTER_BOOL smartPlot_registryAdd(tSmartPlotListElem* listElem)
+{
+   tSmartPlotRegistry* registry = &gt_flushRegistry;
+   unsigned int index = registry->i_numCurves;
+
+   if(index == registry->i_capacity)
    {
-      // Create the background plotting thread if it hasn't already been created.
-      if(!g_plotThread_created)
+      unsigned int newCapacity = registry->i_capacity > 0 ? 2 * registry->i_capacity : SMART_PLOT_REGISTRY_MIN_CAPACITY;
+      tSmartPlotListElem** newListElems;
+      unsigned int* newNameHashes;
+      unsigned int* newEndpointHashes;
+
+      // The capacity is only updated once all the arrays have grown.
+      newListElems = (tSmartPlotListElem**)realloc(registry->pp_listElems, newCapacity * sizeof(*newListElems));
+      if(newListElems == NULL)
+         return FALSE;
+      registry->pp_listElems = newListElems;
+
+      newNameHashes = (unsigned int*)realloc(registry->pi_nameHashes, newCapacity * sizeof(*newNameHashes));
+      if(newNameHashes == NULL)
+         return FALSE;
+      registry->pi_nameHashes = newNameHashes;
+
+      newEndpointHashes = (unsigned int*)realloc(registry->pi_endpointHashes, newCapacity * sizeof(*newEndpointHashes));
+      if(newEndpointHashes == NULL)
+         return FALSE;
+      registry->pi_endpointHashes = newEndpointHashes;
+
+      registry->i_capacity = newCapacity;
+   }
+
+   registry->pp_listElems[index] = listElem;
+   registry->pi_nameHashes[index] = listElem->i_nameHash;
+   registry->pi_endpointHashes[index] = listElem->i_endpointHash;
+   registry->i_numCurves++;
+   listElem->i_registryIndex = index;
+   return TRUE;
+}
+
+// Removes a curve from gt_flushRegistry, if it's in it. gt_smartPlotList_mutex must be locked.
+static void smartPlot_registryRemove(tSmartPlotListElem* listElem)
+{
+   tSmartPlotRegistry* registry = &gt_flushRegistry;
+   unsigned int index = listElem->i_registryIndex;
+   unsigned int lastIndex;
+
+   if(index == SMART_PLOT_NOT_REGISTERED)
+      return;
+
+   // Move the last curve into the hole.
+   lastIndex = --registry->i_numCurves;
+   registry->pp_listElems[index] = registry->pp_listElems[lastIndex];
+   registry->pi_nameHashes[index] = registry->pi_nameHashes[lastIndex];
+   registry->pi_endpointHashes[index] = registry->pi_endpointHashes[lastIndex];
+   registry->pp_listElems[index]->i_registryIndex = index;
+
+   listElem->i_registryIndex = SMART_PLOT_NOT_REGISTERED;
+}
+
+// Ends a write to a curve that was returned by smartPlot_find.
+static void smartPlot_doneWriting(tSmartPlotListElem* listElem)
+{
+   if(listElem != NULL)
+   {
+      // The write has to be finished before the count can be seen to drop (the count is a relaxed atomic).
+      plotThreading_fullFence();
+      plotThreading_atomicAdd(&listElem->i_numWriting, (PLOTTER_UINT_64)-1);
+   }
+}
+
+// Frees the retired curves. gt_smartPlotList_mutex must be locked and no flushes can be in progress.
+// Curves that are still being written are left for a later call, once the write is done.
+static void smartPlot_freeRetired()
+{
+   tSmartPlotListElem** nextRetired = &gt_retiredList;
+   while(*nextRetired != NULL)
+   {
+      tSmartPlotListElem* listElem = *nextRetired;
+      if(plotThreading_atomicLoad(&listElem->i_numWriting) != 0)
       {
-         smartPlot_createFlushThread(g_plotThread_defaultTimeMs);
+         nextRetired = &listElem->p_nextRetired;
+         continue;
       }
+      plotThreading_fullFence(); // Pairs with smartPlot_doneWriting.
+      *nextRetired = listElem->p_nextRetired;
 
-      // If forcing plots to the thread, change the update size to -1 (i.e. plot on the thread)
-      if(*updateSize > 0) // if update size is 0, this is likely being run on the plotter thread.
+      // A write that was in progress when the curve was removed may have reserved memory for it.
+      g_memBudget_usedBytes -= listElem->i_memBytes;
+
+      // Hand the TCP Socket back to the pool, for the next curve.
+      sendMemoryToPlot_Release(&listElem->cur);
+
+      // Free the memory allocated for the current plot / curve, but make sure not to free it twice.
+      // If this is an interleaved plot and this is the Y Axis, do not free the memory.
+      // External buffers belong to whoever registered them.
+      if( listElem->p_extWriteIndex == NULL &&
+          (listElem->interleavedPair == NULL || listElem->interleaved_isXAxis) )
       {
-         *updateSize = -1; // Don't plot on this thread, plot on the background thread.
+         plotRingMem_free(listElem->cur.t_plotMem.pc_memory);
+         if(listElem->cur.t_plotMem.e_plotDim == E_PLOT_2D)
+         {
+            // Need to free Y axis of 2D plot.
+            plotRingMem_free(listElem->cur.t_plotMem_separateYAxis.pc_memory);
+         }
       }
+      free(listElem);
    }
 }
 
-//*****************************************************************************
-// Public Functions
-//*****************************************************************************
-
-void smartPlot_networkConfigure(const char *hostName, const unsigned short port)
+// Removes the curve from the list. gt_smartPlotList_mutex must be locked. The flush threads
+// walk the list without locking it, so the curve is only freed once no flushes are in progress.
+static void smartPlot_removeListElem(tSmartPlotListElem* listElem)
 {
-#if defined PLOTTER_WINDOWS_BUILD && !defined __MINGW32_VERSION
-   strncpy_s(g_plotHostName, sizeof(g_plotHostName), hostName, sizeof(g_plotHostName));
-#else
-   strncpy(g_plotHostName, hostName, sizeof(g_plotHostName));
-   g_plotHostName[sizeof(g_plotHostName)-1] = '\0'; // Make sure null terminated.
-#endif
+   // A flush that is on this curve continues on to the curve's next (so next is left alone, unless
+   // the list is now empty). next was in the list when this curve was removed, so following the
+   // removed curves always leads back into the list (or to NULL).
+   if(listElem->next == listElem)
+   {
+      // This is the only entry in the list.
+      gt_smartPlotList = NULL;
+      listElem->next = NULL;
+   }
+   else
+   {
+      tSmartPlotListElem* oldPrev = listElem->prev;
+      tSmartPlotListElem* oldNext = listElem->next;
+      oldPrev->next = oldNext;
+      oldNext->prev = oldPrev;
+      if(gt_smartPlotList == listElem)
+      {
+         // This was the first element in the list.
+         gt_smartPlotList = oldNext;
+      }
+   }
 
-   g_plotPort = port;
+   g_memBudget_usedBytes -= listElem->i_memBytes;
+   listElem->i_memBytes = 0;
+   smartPlot_registryRemove(listElem);
+
+   listElem->p_nextRetired = gt_retiredList;
+   gt_retiredList = listElem;
+   if(g_numFlushesInProgress == 0)
+   {
+      smartPlot_freeRetired();
+   }
 }
 
-void smartPlot_forceBackgroundThread()
+// Marks the start of a walk through the list that doesn't keep it locked.
+// Returns the first element in the list.
+static tSmartPlotListElem* smartPlot_flushBegin()
 {
-   g_plotThread_forcePlotToThread = TRUE;
+   tSmartPlotListElem* firstListElem;
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   g_numFlushesInProgress++;
+   firstListElem = gt_smartPlotList;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+   return firstListElem;
 }
 
-void smartPlot_interleaved( const void* inDataToPlot,
-                            ePlotDataTypes inDataType,
-                            int inDataSize,
-                            int plotSize,
-                            int updateSize,
-                            const char* plotName,
-                            const char* curveName_x,
-                            const char* curveName_y )
+static void smartPlot_flushEnd()
 {
-   tSmartPlotListElem* listElem_x = NULL;
-   tSmartPlotListElem* listElem_y = NULL;
-   tSendMemToPlot* plot_x = NULL;
-   tSendMemToPlot* plot_y = NULL;
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   g_numFlushesInProgress--;
+   if(g_numFlushesInProgress == 0)
+   {
+      smartPlot_freeRetired();
+   }
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
 
-   // We can't make a new plot if the plot size or plot data type are not valid.
-   // If we are not making a new plot (i.e. the plot already exists) then these
-   // values do not need to be valid (we will just use the values that were used
-   // when the plot was created).
-   PLOTTER_BOOL newPlotParametersAreValid = (plotSize > 0 && isPlotDataTypeValid(inDataType));
+// Flushes the curve from a flush thread, unless it isn't ready.
+static void smartPlot_flushIfReady(tSmartPlotListElem* listElem)
+{
+   // Pairs with smartPlot_pauseFlushes: either the resize sees this flush in progress,
+   // or this flush sees that the curve isn't ready.
+   plotThreading_atomicAdd(&listElem->i_numFlushing, 1);
+   plotThreading_fullFence();
+   if(plotThreading_acquireLoadU32(&listElem->i_ready))
+   {
+      smartPlot_flushListElem(listElem);
+   }
+   plotThreading_fullFence();
+   plotThreading_atomicAdd(&listElem->i_numFlushing, (PLOTTER_UINT_64)-1);
+}
 
-   PLOTTER_BOOL newPlot_x = smartPlot_find(plotName, curveName_x, &listElem_x, newPlotParametersAreValid);
-   PLOTTER_BOOL newPlot_y = smartPlot_find(plotName, curveName_y, &listElem_y, newPlotParametersAreValid);
+// Stops the flush threads from flushing the curve and waits for the flushes of it that are
+// in progress to finish, so the curve's circular buffer can be swapped out from under them.
+static void smartPlot_pauseFlushes(tSmartPlotListElem* listElem)
+{
+   listElem->i_ready = 0;
+   plotThreading_fullFence();
+   while(plotThreading_atomicLoad(&listElem->i_numFlushing) != 0)
+   {
+      smartPlot_sleep(0.0001f);
+   }
+   plotThreading_fullFence();
+}
 
-   // Check if we need to force this plot message to be sent from a background thread.
-   smartPlot_autoStartThread(&updateSize);
+static void smartPlot_resumeFlushes(tSmartPlotListElem* listElem)
+{
+   plotThreading_releaseStoreU32(&listElem->i_ready, 1);
+}
 
-   assert(newPlot_x == newPlot_y); // If the are inequal, something is wrong.
+// Copies the newest numKeep samples of a circular buffer (the ones just before writeIndex)
+// to the start of newMem, oldest first.
+static void smartPlot_linearizeSamples( char* newMem,
+                                        const char* oldMem,
+                                        unsigned int sampSize,
+                                        unsigned int oldNumSamples,
+                                        unsigned int writeIndex,
+                                        unsigned int numKeep )
+{
+   unsigned int startIndex = (writeIndex + oldNumSamples - numKeep) % oldNumSamples;
+   unsigned int numSampToEnd = oldNumSamples - startIndex;
 
-   if(listElem_x == NULL || listElem_y == NULL)
+   if(numSampToEnd >= numKeep)
    {
-      return;
+      memcpy(newMem, oldMem + sampSize * startIndex, sampSize * numKeep);
+   }
+   else
+   {
+      // The newest samples wrap around the end of the circular buffer.
+      memcpy(newMem, oldMem + sampSize * startIndex, sampSize * numSampToEnd);
+      memcpy(newMem + sampSize * numSampToEnd, oldMem, sampSize * (numKeep - numSampToEnd));
    }
+}
 
-   plot_x = &listElem_x->cur;
-   plot_y = &listElem_y->cur;
+// Number of samples that are kept when a circular buffer is resized.
+static unsigned int smartPlot_numSampKept(const tSendMemToPlot* plot, unsigned int newNumSamples)
+{
+   return plot->t_plotMem.i_numSamples < newNumSamples ? plot->t_plotMem.i_numSamples : newNumSamples;
+}
 
-   if(newPlot_x && newPlot_y)
+// Moves the read / write index to where they are once the newest samples have been linearized
+// into a circular buffer of newNumSamples, so the unsent samples are still sent. If there are
+// more unsent samples than fit, the oldest unsent samples are counted as overwritten.
+static void smartPlot_resizeIndexes(tSmartPlotListElem* listElem, unsigned int newNumSamples)
+{
+   tSendMemToPlot* plot = &listElem->cur;
+   unsigned int oldNumSamples = plot->t_plotMem.i_numSamples;
+   unsigned int numKeep = smartPlot_numSampKept(plot, newNumSamples);
+   unsigned int numSampUnsent = (plot->i_writeIndex + oldNumSamples - plot->i_readIndex) % oldNumSamples;
+   unsigned int newWriteIndex = numKeep % newNumSamples;
+
+   // Read index == write index means there is nothing to send, so at most newNumSamples - 1 can be unsent.
+   if(numSampUnsent > newNumSamples - 1)
    {
-      int memberSize = PLOT_DATA_TYPE_SIZES[inDataType];
-      void* newMem = malloc(memberSize * 2 * plotSize);
-      if(NULL == newMem)
-         return;
+      plotStats_count(&listElem->t_stats.i_samplesOverwritten, numSampUnsent - (newNumSamples - 1));
+      numSampUnsent = newNumSamples - 1;
+   }
 
-      plot_x->t_plotMem.b_arrayOfStructs = TRUE;
-      plot_x->t_plotMem.b_interleaved = FALSE; // Interleaved assume 1 2D plot, rather than 2 1D plots that we are doing here.
-      plot_x->t_plotMem.e_dataType = inDataType;
-      plot_x->t_plotMem.e_plotDim = E_PLOT_1D;
-      plot_x->t_plotMem.i_bytesBetweenValues = 2 * memberSize;
-      plot_x->t_plotMem.i_dataSizeBytes = memberSize;
-      plot_x->t_plotMem.i_numSamples = plotSize;
-      plot_x->t_plotMem.pc_memory = (char*)newMem;
+   plot->i_writeIndex = newWriteIndex;
+   plot->i_readIndex = (newWriteIndex + newNumSamples - numSampUnsent) % newNumSamples;
+   plot->t_plotMem.i_numSamples = newNumSamples;
+   listElem->i_indexMask = smartPlot_indexMask(newNumSamples);
+}
 
-      // plot_y will be the same exept for the start position of the first member
-      plot_y->t_plotMem = plot_x->t_plotMem;
-      plot_y->t_plotMem.pc_memory = ((char*)newMem) + memberSize;
+// Returns TRUE if a handle to the curve has been given out (see smartPlot_getCurve1D). The handle's
+// owner writes straight into the circular buffer, so the buffer can never be resized.
+static PLOTTER_BOOL smartPlot_isPinned(const tSmartPlotListElem* listElem)
+{
+   PLOTTER_BOOL pinned;
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   pinned = listElem->b_pinned;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+   return pinned;
+}
 
-      sendMemoryToPlot_Init( plot_x, g_plotHostName, g_plotPort, TRUE, plotName, curveName_x);
-      sendMemoryToPlot_Init( plot_y, g_plotHostName, g_plotPort, TRUE, plotName, curveName_y);
+// Returns TRUE if nothing is writing the curve (or its interleaved pair). gt_smartPlotList_mutex must be locked.
+static PLOTTER_BOOL smartPlot_isIdle(const tSmartPlotListElem* listElem)
+{
+   return plotThreading_atomicLoad(&listElem->i_numWriting) == 0 &&
+          (listElem->interleavedPair == NULL || plotThreading_atomicLoad(&listElem->interleavedPair->i_numWriting) == 0);
+}
 
-      // Link the 2 list elements together.
-      listElem_x->interleavedPair = listElem_y;
-      listElem_x->interleaved_isXAxis = TRUE;
-      listElem_y->interleavedPair = listElem_x;
-      listElem_y->interleaved_isXAxis = FALSE;
+// Flushes and removes the least recently written curve that can be evicted. The curve that is
+// asking for memory (and its interleaved pair) is never picked, keepListElem can be NULL. Curves
+// that are being written are never picked, so eviction can't free a curve out from under a writer.
+// gt_smartPlotList_mutex must be locked once. It is unlocked while the evicted curve is flushed.
+// Returns TRUE if a curve was evicted.
+static PLOTTER_BOOL smartPlot_evictLeastRecentlyWritten(const tSmartPlotListElem* keepListElem)
+{
+   tSmartPlotListElem* evictListElem = NULL;
+   PLOTTER_UINT_64 nowNs = plotStats_getTimeNs();
+
+   if(gt_smartPlotList != NULL)
+   {
+      tSmartPlotListElem* list = gt_smartPlotList;
+      do
+      {
+         // Only the X Axis of an interleaved pair has memory, so the pair is evicted via the X Axis.
+         if( list->i_memBytes > 0 && !list->b_pinned && list->i_ready && smartPlot_isIdle(list) &&
+             list != keepListElem && (keepListElem == NULL || list != keepListElem->interleavedPair) &&
+             list->i_lastWriteNs + g_memBudget_minIdleNs <= nowNs &&
+             (evictListElem == NULL || list->i_lastWriteNs < evictListElem->i_lastWriteNs) )
+         {
+            evictListElem = list;
+         }
+         list = list->next;
+      }
+      while(list != gt_smartPlotList); // List is circular. When it wraps back to beginning of the list, stop looping.
    }
-   else if(plotSize != (int)plot_x->t_plotMem.i_numSamples && plotSize > 0 && isPlotDataTypeValid(plot_x->t_plotMem.e_dataType))
+
+   if(evictListElem == NULL)
    {
-      int memberSize = PLOT_DATA_TYPE_SIZES[plot_x->t_plotMem.e_dataType];
-      char* oldMem_toFree = plot_x->t_plotMem.pc_memory;
-      char* newMem = NULL;
+      return FALSE;
+   }
 
-      plot_x->i_readIndex = plot_x->i_writeIndex = 0;
-      plot_y->i_readIndex = plot_y->i_writeIndex = 0;
-      plot_x->t_plotMem.i_numSamples = plotSize;
-      plot_y->t_plotMem.i_numSamples = plotSize;
+   // Count the flush below as a write, so the curve isn't freed until it's done. Nothing else can
+   // find the curve once it's out of the list.
+   plotThreading_atomicAdd(&evictListElem->i_numWriting, 1);
+   if(evictListElem->interleavedPair != NULL)
+   {
+      plotThreading_atomicAdd(&evictListElem->interleavedPair->i_numWriting, 1);
+      smartPlot_removeListElem(evictListElem->interleavedPair);
+   }
+   smartPlot_removeListElem(evictListElem);
+   g_memBudget_numEvicted++;
 
-      newMem = (char*)malloc(memberSize * 2 * plotSize);
-      if(NULL == newMem)
-         return;
+   // Send whatever hasn't been sent yet before the samples are thrown away. Sending can take a
+   // while, so don't hold the list lock. The flush threads are stopped from flushing the curve the
+   // same way as for a resize, so the samples are only sent once.
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+   smartPlot_pauseFlushes(evictListElem);
+   smartPlot_flushListElem(evictListElem);
+   smartPlot_doneWriting(evictListElem->interleavedPair);
+   smartPlot_doneWriting(evictListElem);
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
 
-      plot_x->t_plotMem.pc_memory = newMem;
-      plot_y->t_plotMem.pc_memory = plot_x->t_plotMem.pc_memory + memberSize;
+   if(g_numFlushesInProgress == 0)
+   {
+      smartPlot_freeRetired();
+   }
+   return TRUE;
+}
 
-      free(oldMem_toFree);
+// Reserves memory budget for the curve's circular buffer(s) to be numBytes (replacing whatever
+// the curve currently has), evicting the least recently written curves until it fits.
+// Returns FALSE if the curve's memory would not fit in the budget.
+static PLOTTER_BOOL smartPlot_reserveMem(tSmartPlotListElem* listElem, size_t numBytes)
+{
+   PLOTTER_BOOL reserved;
+
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+
+   if(g_memBudget_maxBytes > 0)
+   {
+      while(g_memBudget_usedBytes - listElem->i_memBytes + numBytes > g_memBudget_maxBytes)
+      {
+         if(!smartPlot_evictLeastRecentlyWritten(listElem))
+            break; // Everything else is pinned / not idle long enough.
+      }
    }
 
+   reserved = g_memBudget_maxBytes == 0 || g_memBudget_usedBytes - listElem->i_memBytes + numBytes <= g_memBudget_maxBytes;
+   if(reserved)
    {
-      int numSampToLeftToWrite = inDataSize;
+      g_memBudget_usedBytes = g_memBudget_usedBytes - listElem->i_memBytes + numBytes;
+      listElem->i_memBytes = numBytes;
+      listElem->i_lastWriteNs = plotStats_getTimeNs();
+   }
+
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+
+   return reserved;
+}
+
+// Removes a new curve whose memory couldn't be allocated, so the next call tries again.
+static void smartPlot_abandonNewPlot(tSmartPlotListElem* listElem)
+{
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   smartPlot_removeListElem(listElem);
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
+
+// Sums the sample counters of all the curves, except for the telemetry curves.
+static void smartPlot_sumCurveStats(PLOTTER_UINT_64* samplesUnsent, PLOTTER_UINT_64* samplesOverwritten)
+{
+   *samplesUnsent = 0;
+   *samplesOverwritten = 0;
+
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   if(gt_smartPlotList != NULL)
+   {
+      tSmartPlotListElem* list = gt_smartPlotList;
+      do
+      {
+         const tSendMemToPlot* plot = &list->cur;
+         if(plot->t_plotMem.i_numSamples > 0 && strcmp(plot->pc_plotName, SMART_PLOT_TELEMETRY_PLOT_NAME) != 0)
+         {
+            int numSampUnsent = (int)plot->i_writeIndex - (int)plot->i_readIndex;
+            if(numSampUnsent < 0)
+               numSampUnsent += plot->t_plotMem.i_numSamples;
+            *samplesUnsent += numSampUnsent;
+            *samplesOverwritten += plotThreading_atomicLoad(&list->t_stats.i_samplesOverwritten);
+         }
+         list = list->next;
+      }
+      while(list != gt_smartPlotList); // List is circular. When it wraps back to beginning of the list, stop looping.
+   }
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
+
+static void smartPlot_publishTelemetryValue(const char* curveName, double value)
+{
+   // Update size of -1, the values will be sent by the next flush.
+   smartPlot_1D(&value, E_FLOAT_64, 1, g_telemetry_plotSize, -1, SMART_PLOT_TELEMETRY_PLOT_NAME, curveName);
+}
+
+// Plots the library's own health metrics (if enabled and the publish period has elapsed).
+// Must only be called from one thread.
+static void smartPlot_publishTelemetry(const tSmartPlotFlushStats* flushStats)
+{
+   tSmartPlotEndpointStats endpoints[MAX_TELEMETRY_ENDPOINTS];
+   unsigned int numEndpoints;
+   unsigned int endpointIndex;
+   PLOTTER_UINT_64 samplesUnsent;
+   PLOTTER_UINT_64 samplesOverwritten;
+   PLOTTER_UINT_64 nowNs = plotStats_getTimeNs();
+   double elapsedSec = (nowNs - gt_telemetry.i_lastPublishNs) * 1e-9;
+
+   if(g_telemetry_periodMs == 0 || g_telemetry_plotSize <= 0 || elapsedSec < g_telemetry_periodMs * 1e-3)
+   {
+      return;
+   }
+
+   smartPlot_sumCurveStats(&samplesUnsent, &samplesOverwritten);
+   numEndpoints = sendMemoryToPlot_getEndpointStats(endpoints, MAX_TELEMETRY_ENDPOINTS);
+   numEndpoints = numEndpoints < MAX_TELEMETRY_ENDPOINTS ? numEndpoints : MAX_TELEMETRY_ENDPOINTS;
+
+   smartPlot_publishTelemetryValue("Queue Depth", (double)samplesUnsent);
+   smartPlot_publishTelemetryValue("Dropped Samples", (double)(samplesOverwritten - gt_telemetry.i_lastSamplesOverwritten));
+   smartPlot_publishTelemetryValue("Flush Duration (us)", (double)flushStats->lastFlushDurationUs);
+   smartPlot_publishTelemetryValue("Flush Bytes", (double)flushStats->lastFlushBytes);
+   smartPlot_publishTelemetryValue("Flush Period (ms)", (double)flushStats->curPeriodMs);
+
+   for(endpointIndex = 0; endpointIndex < numEndpoints; ++endpointIndex)
+   {
+      const tSmartPlotEndpointStats* endpoint = &endpoints[endpointIndex];
+      unsigned long long reconnects = (endpoint->connects > 0 ? endpoint->connects - 1 : 0) + endpoint->connectFailures;
+
+      if(endpointIndex >= gt_telemetry.i_numEndpoints)
+      {
+         // First time seeing this endpoint. Endpoints are never removed, so the index is stable.
+         snprintf( gt_telemetry.aac_bytesPerSecNames[endpointIndex], TELEMETRY_CURVE_NAME_SIZE, "%.*s:%u Bytes/Sec",
+                   SMART_PLOT_STATS_NAME_SIZE - 1, endpoint->hostName, (unsigned int)endpoint->port );
+         snprintf( gt_telemetry.aac_reconnectNames[endpointIndex], TELEMETRY_CURVE_NAME_SIZE, "%.*s:%u Reconnects",
+                   SMART_PLOT_STATS_NAME_SIZE - 1, endpoint->hostName, (unsigned int)endpoint->port );
+         gt_telemetry.ai_lastEndpointBytes[endpointIndex] = endpoint->bytesSent;
+         gt_telemetry.i_numEndpoints = endpointIndex + 1;
+      }
+
+      smartPlot_publishTelemetryValue( gt_telemetry.aac_bytesPerSecNames[endpointIndex],
+                                       (endpoint->bytesSent - gt_telemetry.ai_lastEndpointBytes[endpointIndex]) / elapsedSec );
+      smartPlot_publishTelemetryValue(gt_telemetry.aac_reconnectNames[endpointIndex], (double)reconnects);
+      gt_telemetry.ai_lastEndpointBytes[endpointIndex] = endpoint->bytesSent;
+   }
+
+   gt_telemetry.i_lastSamplesOverwritten = samplesOverwritten;
+   gt_telemetry.i_lastPublishNs = nowNs;
+}
+
+// Updates the flush stats with what was measured during one flush. The totals are what the
+// flushing thread had sent before / after the flush. If the flush period is adaptive, the period
+// to use for the next flush is chosen here.
+static void smartPlot_recordFlush( tSmartPlotFlushStats* flushStats,
+                                   const tSendMemToPlotTotals* totalsBefore,
+                                   const tSendMemToPlotTotals* totalsAfter,
+                                   PLOTTER_UINT_64 flushDurationNs )
+{
+   PLOTTER_UINT_64 flushBytes = totalsAfter->i_bytesSent - totalsBefore->i_bytesSent;
+   PLOTTER_UINT_64 flushMsgs = totalsAfter->i_msgsSent - totalsBefore->i_msgsSent;
+   PLOTTER_BOOL sendCostRising = FALSE;
+   double elapsedSec;
+
+   elapsedSec = flushStats->curPeriodMs*1e-3 + flushDurationNs*1e-9;
+
+   flushStats->numFlushes++;
+   flushStats->lastFlushBytes = flushBytes;
+   flushStats->lastFlushDurationUs = flushDurationNs / 1000;
+   flushStats->dataRateBytesPerSec += ADAPTIVE_FLUSH_SMOOTHING * (flushBytes / elapsedSec - flushStats->dataRateBytesPerSec);
+
+   if(flushMsgs > 0)
+   {
+      PLOTTER_UINT_64 sendTimeNs = totalsAfter->i_sendTimeNs - totalsBefore->i_sendTimeNs;
+      double sendLatencyUs = sendTimeNs * 1e-3 / flushMsgs;
+      double sendNsPerByte = flushBytes > 0 ? (double)sendTimeNs / flushBytes : 0.0;
+
+      if(flushStats->numFlushes == 1 || flushStats->sendLatencyUs == 0.0)
+      {
+         // First measurement, nothing to smooth against.
+         flushStats->sendLatencyUs = sendLatencyUs;
+         flushStats->sendNsPerByte = sendNsPerByte;
+      }
+      else
+      {
+         // Bigger messages take longer to send, so compare the cost per byte to determine
+         // whether sending is getting slower.
+         sendCostRising = sendNsPerByte > flushStats->sendNsPerByte * ADAPTIVE_FLUSH_RISE_RATIO;
+         flushStats->sendLatencyUs += ADAPTIVE_FLUSH_SMOOTHING * (sendLatencyUs - flushStats->sendLatencyUs);
+         flushStats->sendNsPerByte += ADAPTIVE_FLUSH_SMOOTHING * (sendNsPerByte - flushStats->sendNsPerByte);
+      }
+   }
+
+   if(flushStats->adaptive)
+   {
+      unsigned int period = flushStats->curPeriodMs;
+      if(flushBytes >= ADAPTIVE_FLUSH_BUSY_BYTES && sendCostRising)
+      {
+         period = period + period / 2 + 1; // Lengthen by 50%
+      }
+      else if(flushBytes < ADAPTIVE_FLUSH_IDLE_BYTES)
+      {
+         period = period - period / 4; // Shorten by 25%
+      }
+      period = period < flushStats->minPeriodMs ? flushStats->minPeriodMs : period;
+      period = period > flushStats->maxPeriodMs ? flushStats->maxPeriodMs : period;
+      flushStats->curPeriodMs = period;
+   }
+}
+
+// Flushes all the plots and updates the flush stats with what was measured.
+static void smartPlot_measuredFlush(tSmartPlotFlushStats* flushStats)
+{
+   tSendMemToPlotTotals totalsBefore;
+   tSendMemToPlotTotals totalsAfter;
+   PLOTTER_UINT_64 flushStartTimeNs;
+
+   sendMemoryToPlot_getThreadTotals(&totalsBefore);
+   flushStartTimeNs = plotStats_getTimeNs();
+
+   smartPlot_flush_all();
+
+   sendMemoryToPlot_getThreadTotals(&totalsAfter);
+   smartPlot_recordFlush(flushStats, &totalsBefore, &totalsAfter, plotStats_getTimeNs() - flushStartTimeNs);
+
+   // Make the latest values available to smartPlot_getFlushStats.
+   plotThreading_mutexLock(&gt_plotThread_stats_mutex);
+   gt_plotThread_stats = *flushStats;
+   plotThreading_mutexUnlock(&gt_plotThread_stats_mutex);
+
+   smartPlot_publishTelemetry(flushStats);
+}
+
+static void smartPlot_flushLoop(const tPlotThreadParams* threadParams, unsigned int minTimeMs, unsigned int maxTimeMs)
+{
+   tSmartPlotFlushStats flushStats;
+
+#ifdef PLOTTER_PTHREADS_AVAILABLE
+   pthread_t thisPthread = pthread_self();
+
+   // Set Priority / Policy
+   if(threadParams->setPriorityPolicy)
+   {
+      struct sched_param schedParam;
+      schedParam.sched_priority = threadParams->priority;
+      pthread_setschedparam(thisPthread, threadParams->policy, &schedParam);
+   }
+#endif
+
+   memset(&flushStats, 0, sizeof(flushStats));
+   flushStats.adaptive = minTimeMs != maxTimeMs;
+   flushStats.minPeriodMs = minTimeMs;
+   flushStats.maxPeriodMs = maxTimeMs;
+   flushStats.curPeriodMs = threadParams->timeBetweenMs;
+
+   while(1)
+   {
+#ifdef PLOTTER_WINDOWS_BUILD
+      Sleep(flushStats.curPeriodMs);
+#else
+      usleep(flushStats.curPeriodMs*1000);
+#endif
+      smartPlot_measuredFlush(&flushStats);
+   }
+}
+
+static void* smartPlot_flushThread(void* p_threadParams)
+{
+   tPlotThreadParams threadParams = *((tPlotThreadParams*)p_threadParams);
+   smartPlot_flushLoop(&threadParams, threadParams.timeBetweenMs, threadParams.timeBetweenMs);
+   return NULL;
+}
+
+static void* smartPlot_adaptiveFlushThread(void* p_threadParams)
+{
+   tPlotThreadParams threadParams = *((tPlotThreadParams*)p_threadParams);
+   smartPlot_flushLoop(&threadParams, g_plotThread_adaptiveMinTimeMs, g_plotThread_adaptiveMaxTimeMs);
+   return NULL;
+}
+
+static void smartPlot_autoStartThread(int* updateSize)
+{
+   if(g_plotThread_forcePlotToThread)
+   {
+      // Create the background plotting thread if it hasn't already been created.
+      if(!g_plotThread_created)
+      {
+         smartPlot_createFlushThread(g_plotThread_defaultTimeMs);
+      }
+
+      // If forcing plots to the thread, change the update size to -1 (i.e. plot on the thread)
+      if(*updateSize > 0) // if update size is 0, this is likely being run on the plotter thread.
+      {
+         *updateSize = -1; // Don't plot on this thread, plot on the background thread.
+      }
+   }
+}
+
+//*****************************************************************************
+// Public Functions
+//*****************************************************************************
+
+void smartPlot_networkConfigure(const char *hostName, const unsigned short port)
+{
+#if defined PLOTTER_WINDOWS_BUILD && !defined __MINGW32_VERSION
+   strncpy_s(g_plotHostName, sizeof(g_plotHostName), hostName, sizeof(g_plotHostName));
+#else
+   strncpy(g_plotHostName, hostName, sizeof(g_plotHostName));
+   g_plotHostName[sizeof(g_plotHostName)-1] = '\0'; // Make sure null terminated.
+#endif
+
+   g_plotPort = port;
+}
+
+int smartPlot_registerSink(const char* scheme, const tSmartPlotSink* sink)
+{
+   return sendMemoryToPlot_registerSink(scheme, sink);
+}
+
+int smartPlot_addDestination(const char* hostName, unsigned short port)
+{
+   return sendMemoryToPlot_addDestination(NULL, hostName, port);
+}
+
+int smartPlot_removeDestination(const char* hostName, unsigned short port)
+{
+   return sendMemoryToPlot_removeDestination(NULL, hostName, port);
+}
+
+// Returns the plot that sends a curve's messages. Interleaved curves are sent via the X Axis.
+// gt_smartPlotList_mutex must be locked.
+static tSendMemToPlot* smartPlot_findSender(const char* plotName, const char* curveName)
+{
+   tSmartPlotListElem* listElem = smartPlot_findListElem(plotName, curveName);
+   if(listElem == NULL)
+      return NULL;
+   if(listElem->interleavedPair != NULL && !listElem->interleaved_isXAxis)
+      listElem = listElem->interleavedPair;
+   return &listElem->cur;
+}
+
+int smartPlot_addCurveDestination(const char* plotName, const char* curveName, const char* hostName, unsigned short port)
+{
+   int retVal = -1;
+   tSendMemToPlot* plot;
+
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   plot = smartPlot_findSender(plotName, curveName);
+   if(plot != NULL)
+   {
+      retVal = sendMemoryToPlot_addDestination(plot, hostName, port);
+   }
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+
+   return retVal;
+}
+
+int smartPlot_removeCurveDestination(const char* plotName, const char* curveName, const char* hostName, unsigned short port)
+{
+   int retVal = -1;
+   tSendMemToPlot* plot;
+
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   plot = smartPlot_findSender(plotName, curveName);
+   if(plot != NULL)
+   {
+      retVal = sendMemoryToPlot_removeDestination(plot, hostName, port);
+   }
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+
+   return retVal;
+}
+
+void smartPlot_forceBackgroundThread()
+{
+   g_plotThread_forcePlotToThread = TRUE;
+}
+
+// Updates the curve's sample counters after new samples have been written to its circular buffer.
+static void smartPlot_countWrite(tSmartPlotListElem* listElem, int numSampAlreadyInBuff, int numSampWritten)
+{
+   int numSampOverwritten = numSampAlreadyInBuff + numSampWritten - (int)listElem->cur.t_plotMem.i_numSamples;
+   plotStats_count(&listElem->t_stats.i_samplesWritten, numSampWritten);
+   if(numSampOverwritten > 0)
+   {
+      plotStats_count(&listElem->t_stats.i_samplesOverwritten, numSampOverwritten);
+   }
+   if(g_memBudget_maxBytes > 0 && numSampWritten > 0)
+   {
+      listElem->i_lastWriteNs = plotStats_getTimeNs();
+   }
+}
+
+static void smartPlot_interleaved_listElem( tSmartPlotListElem* listElem_x,
+                                            tSmartPlotListElem* listElem_y,
+                                            PLOTTER_BOOL newPlot,
+                                            const void* inDataToPlot,
+                                            ePlotDataTypes inDataType,
+                                            int inDataSize,
+                                            int plotSize,
+                                            int updateSize,
+                                            const char* plotName,
+                                            const char* curveName_x,
+                                            const char* curveName_y )
+{
+   tSendMemToPlot* plot_x = &listElem_x->cur;
+   tSendMemToPlot* plot_y = &listElem_y->cur;
+
+   plotSize = smartPlot_capacity(plotSize);
+
+   if(newPlot)
+   {
+      int memberSize = PLOT_DATA_TYPE_SIZES[inDataType];
+      char* newMem = NULL;
+      if(smartPlot_reserveMem(listElem_x, (size_t)memberSize * 2 * plotSize))
+      {
+         newMem = smartPlot_allocRing((size_t)memberSize * 2 * plotSize);
+      }
+      if(NULL == newMem)
+      {
+         smartPlot_abandonNewPlot(listElem_x);
+         smartPlot_abandonNewPlot(listElem_y);
+         return;
+      }
+
+      plot_x->t_plotMem.b_arrayOfStructs = TRUE;
+      plot_x->t_plotMem.b_interleaved = FALSE; // Interleaved assume 1 2D plot, rather than 2 1D plots that we are doing here.
+      plot_x->t_plotMem.e_dataType = inDataType;
+      plot_x->t_plotMem.e_plotDim = E_PLOT_1D;
+      plot_x->t_plotMem.i_bytesBetweenValues = 2 * memberSize;
+      plot_x->t_plotMem.i_dataSizeBytes = memberSize;
+      plot_x->t_plotMem.i_numSamples = plotSize;
+      plot_x->t_plotMem.pc_memory = (char*)newMem;
+      plot_x->t_plotMem.b_mirrored = plotRingMem_isMirrored(newMem);
+
+      // plot_y will be the same exept for the start position of the first member
+      plot_y->t_plotMem = plot_x->t_plotMem;
+      plot_y->t_plotMem.pc_memory = ((char*)newMem) + memberSize;
+      listElem_x->i_indexMask = smartPlot_indexMask(plotSize);
+      listElem_y->i_indexMask = listElem_x->i_indexMask;
+
+      sendMemoryToPlot_Init( plot_x, g_plotHostName, g_plotPort, TRUE, plotName, curveName_x);
+      sendMemoryToPlot_Init( plot_y, g_plotHostName, g_plotPort, TRUE, plotName, curveName_y);
+      plot_x->p_curveStats = &listElem_x->t_stats;
+      plot_y->p_curveStats = &listElem_y->t_stats;
+
+      // Link the 2 list elements together.
+      listElem_x->interleavedPair = listElem_y;
+      listElem_x->interleaved_isXAxis = TRUE;
+      listElem_y->interleavedPair = listElem_x;
+      listElem_y->interleaved_isXAxis = FALSE;
+
+      // Interleaved pairs are flushed via the X Axis.
+      plotThreading_mutexLock(&gt_smartPlotList_mutex);
+      smartPlot_registryRemove(listElem_y);
+      plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+
+      plotThreading_releaseStoreU32(&listElem_x->i_ready, 1);
+      plotThreading_releaseStoreU32(&listElem_y->i_ready, 1);
+   }
+   else if(plotSize != (int)plot_x->t_plotMem.i_numSamples && plotSize > 0 && isPlotDataTypeValid(plot_x->t_plotMem.e_dataType))
+   {
+      int memberSize = PLOT_DATA_TYPE_SIZES[plot_x->t_plotMem.e_dataType];
+      char* oldMem_toFree = plot_x->t_plotMem.pc_memory;
+      char* newMem = NULL;
+      size_t oldMemBytes = listElem_x->i_memBytes;
+
+      if(!smartPlot_reserveMem(listElem_x, (size_t)memberSize * 2 * plotSize))
+         return;
+
+      newMem = smartPlot_allocRing((size_t)memberSize * 2 * plotSize);
+      if(NULL == newMem)
+      {
+         smartPlot_reserveMem(listElem_x, oldMemBytes);
+         return;
+      }
+
+      // Interleaved pairs are flushed via the X Axis.
+      smartPlot_pauseFlushes(listElem_x);
+
+      smartPlot_linearizeSamples( newMem, oldMem_toFree, 2 * memberSize, plot_x->t_plotMem.i_numSamples,
+                                  plot_x->i_writeIndex, smartPlot_numSampKept(plot_x, plotSize) );
+      smartPlot_resizeIndexes(listElem_x, plotSize);
+      smartPlot_resizeIndexes(listElem_y, plotSize);
+
+      plot_x->t_plotMem.pc_memory = newMem;
+      plot_y->t_plotMem.pc_memory = plot_x->t_plotMem.pc_memory + memberSize;
+      plot_x->t_plotMem.b_mirrored = plotRingMem_isMirrored(newMem);
+      plot_y->t_plotMem.b_mirrored = plot_x->t_plotMem.b_mirrored;
+
+      plotRingMem_free(oldMem_toFree);
+      smartPlot_resumeFlushes(listElem_x);
+   }
+
+   {
+      int numSampToLeftToWrite = inDataSize;
       int numSampWritten = 0;
       int writeIndex = plot_x->i_writeIndex;
       int numSampLeftForPlotSend;
@@ -316,9 +1259,7 @@ void smartPlot_interleaved( const void* inDataToPlot,
       char* readLocationPtr = (char*)inDataToPlot;
       int memberSize = PLOT_DATA_TYPE_SIZES[plot_x->t_plotMem.e_dataType];
 
-      int numSampAlreadyInBuff = (int)writeIndex - (int)plot_x->i_readIndex;
-      if(numSampAlreadyInBuff < 0)
-         numSampAlreadyInBuff += plot_x->t_plotMem.i_numSamples;
+      int numSampAlreadyInBuff = smartPlot_numSampUnsent(listElem_x);
 
       // When update size is a negative number, no plot message should be sent.
       // Set update size to a value large than the number of samples in the plot
@@ -328,9 +1269,16 @@ void smartPlot_interleaved( const void* inDataToPlot,
 
       numSampLeftForPlotSend = updateSize - numSampAlreadyInBuff;
 
+      if(listElem_x->i_indexMask != 0 && numSampToLeftToWrite > 0)
+      {
+         writeIndex = (int)smartPlot_writeMasked(&plot_x->t_plotMem, listElem_x->i_indexMask, writeIndex, readLocationPtr, numSampToLeftToWrite);
+         numSampWritten = numSampToLeftToWrite;
+         numSampToLeftToWrite = 0;
+      }
+
       while(numSampToLeftToWrite > 0)
       {
-         int numSampToEnd = plot_x->t_plotMem.i_numSamples - writeIndex;
+         int numSampToEnd = smartPlot_numSampToEnd(&plot_x->t_plotMem, writeIndex);
          int numSampToWrite = (numSampToEnd < numSampToLeftToWrite) ? numSampToEnd : numSampToLeftToWrite;
          memcpy( &writeLocationPtr[2 * memberSize * writeIndex],
                  &readLocationPtr[2 * memberSize * numSampWritten],
@@ -341,7 +1289,7 @@ void smartPlot_interleaved( const void* inDataToPlot,
          writeIndex += numSampToWrite;
          if(writeIndex >= (int)plot_x->t_plotMem.i_numSamples)
          {
-            writeIndex = 0;
+            writeIndex -= plot_x->t_plotMem.i_numSamples;
          }
       }
 
@@ -350,6 +1298,8 @@ void smartPlot_interleaved( const void* inDataToPlot,
          plot_x->i_writeIndex = writeIndex;
          plot_y->i_writeIndex = writeIndex;
       }
+      smartPlot_countWrite(listElem_x, numSampAlreadyInBuff, numSampWritten);
+      smartPlot_countWrite(listElem_y, numSampAlreadyInBuff, numSampWritten);
 
       // Never update plot if update size is greater than the plot size.
       if(plot_x->t_plotMem.i_numSamples >= (unsigned int)updateSize)
@@ -380,16 +1330,17 @@ void smartPlot_interleaved( const void* inDataToPlot,
 
 }
 
-void smartPlot_1D( const void* inDataToPlot,
-                   ePlotDataTypes inDataType,
-                   int inDataSize,
-                   int plotSize,
-                   int updateSize,
-                   const char* plotName,
-                   const char* curveName )
+void smartPlot_interleaved( const void* inDataToPlot,
+                            ePlotDataTypes inDataType,
+                            int inDataSize,
+                            int plotSize,
+                            int updateSize,
+                            const char* plotName,
+                            const char* curveName_x,
+                            const char* curveName_y )
 {
-   tSmartPlotListElem* listElem = NULL;
-   tSendMemToPlot* plot = NULL;
+   tSmartPlotListElem* listElem_x = NULL;
+   tSmartPlotListElem* listElem_y = NULL;
 
    // We can't make a new plot if the plot size or plot data type are not valid.
    // If we are not making a new plot (i.e. the plot already exists) then these
@@ -397,24 +1348,126 @@ void smartPlot_1D( const void* inDataToPlot,
    // when the plot was created).
    PLOTTER_BOOL newPlotParametersAreValid = (plotSize > 0 && isPlotDataTypeValid(inDataType));
 
-   PLOTTER_BOOL newPlot = smartPlot_find(plotName, curveName, &listElem, newPlotParametersAreValid);
+   PLOTTER_BOOL newPlot_x = smartPlot_find(plotName, curveName_x, &listElem_x, newPlotParametersAreValid);
+   PLOTTER_BOOL newPlot_y = smartPlot_find(plotName, curveName_y, &listElem_y, newPlotParametersAreValid);
 
    // Check if we need to force this plot message to be sent from a background thread.
    smartPlot_autoStartThread(&updateSize);
 
-   if(listElem == NULL)
+   if( listElem_x != NULL && listElem_y != NULL &&
+       (listElem_x->p_extWriteIndex != NULL || listElem_y->p_extWriteIndex != NULL) )
    {
-      return;
+      // External buffers are never written / resized by smartPlot (see smartPlot_registerExternal1D).
+      if(newPlot_x)
+         smartPlot_abandonNewPlot(listElem_x);
+      if(newPlot_y)
+         smartPlot_abandonNewPlot(listElem_y);
+   }
+   else
+   {
+      assert(newPlot_x == newPlot_y); // If the are inequal, something is wrong.
+
+      if(listElem_x != NULL && listElem_y != NULL)
+      {
+         smartPlot_interleaved_listElem( listElem_x, listElem_y, newPlot_x && newPlot_y,
+                                         inDataToPlot, inDataType, inDataSize, plotSize, updateSize,
+                                         plotName, curveName_x, curveName_y );
+      }
    }
 
-   plot = &listElem->cur;
+   smartPlot_doneWriting(listElem_x);
+   smartPlot_doneWriting(listElem_y);
+}
+
+// Moves the write index of a 1D curve past numSampWritten samples that have just been copied into
+// its circular buffer (starting at the write index) and sends a plot message if one is due.
+static void smartPlot_1D_commit(tSmartPlotListElem* listElem, int numSampWritten, int updateSize)
+{
+   tSendMemToPlot* plot = &listElem->cur;
+   int writeIndex = plot->i_writeIndex;
+   int numSampLeftForPlotSend;
+
+   int numSampAlreadyInBuff = smartPlot_numSampUnsent(listElem);
+
+   // When update size is a negative number, no plot message should be sent.
+   // Set update size to a value large than the number of samples in the plot
+   // to ensure a message is not sent.
+   if(updateSize < 0)
+      updateSize = plot->t_plotMem.i_numSamples + 1;
+
+   numSampLeftForPlotSend = updateSize - numSampAlreadyInBuff;
+
+   if(numSampWritten > 0) // Only modify write index if it is changing.
+   {
+      if(listElem->i_indexMask != 0)
+         writeIndex = (int)((writeIndex + (unsigned int)numSampWritten) & listElem->i_indexMask);
+      else
+         writeIndex = (int)((writeIndex + (unsigned int)numSampWritten) % plot->t_plotMem.i_numSamples);
+      plot->i_writeIndex = writeIndex;
+   }
+   smartPlot_countWrite(listElem, numSampAlreadyInBuff, numSampWritten);
+
+   // Never update plot if update size is greater than the plot size.
+   if(plot->t_plotMem.i_numSamples >= (unsigned int)updateSize)
+   {
+      if( (numSampAlreadyInBuff + numSampWritten) >= (int)plot->t_plotMem.i_numSamples )
+      {
+         // More samples need to be updated than size of the plot, send Create message (which will
+         // send all the samples in the plot).
+         sendMemoryToPlot_Create1D(plot);
+
+         // By sending the Create plot, all the data has been read. Set the read index to the write index.
+         plot->i_readIndex = writeIndex;
+      }
+      else if(numSampWritten >= numSampLeftForPlotSend)
+      {
+         sendMemoryToPlot(plot);
+      }
+   }
+}
+
+// Picks up the samples the owner of an external circular buffer has written since the
+// last time and sends a plot message if one is due. A whole lap of the buffer between
+// two calls can't be detected (it looks like no new samples).
+static void smartPlot_externalCommit(tSmartPlotListElem* listElem, int updateSize)
+{
+   tSendMemToPlot* plot = &listElem->cur;
+   unsigned int extWriteIndex = plotThreading_acquireLoadU32(listElem->p_extWriteIndex) % plot->t_plotMem.i_numSamples;
+   unsigned int numSampWritten = extWriteIndex >= plot->i_writeIndex ?
+         extWriteIndex - plot->i_writeIndex :
+         plot->t_plotMem.i_numSamples + extWriteIndex - plot->i_writeIndex;
+
+   smartPlot_1D_commit(listElem, (int)numSampWritten, updateSize);
+}
+
+// Returns FALSE if the new curve's memory couldn't be allocated (listElem has been removed from the list).
+static PLOTTER_BOOL smartPlot_1D_listElem( tSmartPlotListElem* listElem,
+                                   PLOTTER_BOOL newPlot,
+                                   const void* inDataToPlot,
+                                   ePlotDataTypes inDataType,
+                                   int inDataSize,
+                                   int plotSize,
+                                   int updateSize,
+                                   const char* plotName,
+                                   const char* curveName )
+{
+   tSendMemToPlot* plot = &listElem->cur;
+
+   plotSize = smartPlot_capacity(plotSize);
 
    if(newPlot)
    {
       int memberSize = PLOT_DATA_TYPE_SIZES[inDataType];
-      void* newMem = malloc(memberSize * plotSize);
+      char* newMem = NULL;
+      if(smartPlot_reserveMem(listElem, (size_t)memberSize * plotSize))
+      {
+         newMem = smartPlot_allocRing((size_t)memberSize * plotSize);
+      }
       if(NULL == newMem)
-         return;
+      {
+         smartPlot_abandonNewPlot(listElem);
+         return FALSE;
+      }
 
       plot->t_plotMem.b_arrayOfStructs = FALSE;
       plot->t_plotMem.b_interleaved = FALSE;
@@ -424,38 +1477,343 @@ void smartPlot_1D( const void* inDataToPlot,
       plot->t_plotMem.i_dataSizeBytes = memberSize;
       plot->t_plotMem.i_numSamples = plotSize;
       plot->t_plotMem.pc_memory = (char*)newMem;
+      plot->t_plotMem.b_mirrored = plotRingMem_isMirrored(newMem);
+      listElem->i_indexMask = smartPlot_indexMask(plotSize);
 
       sendMemoryToPlot_Init( plot, g_plotHostName, g_plotPort, TRUE, plotName, curveName);
+      plot->p_curveStats = &listElem->t_stats;
+      plotThreading_releaseStoreU32(&listElem->i_ready, 1);
    }
-   else if(plotSize != (int)plot->t_plotMem.i_numSamples && plotSize > 0 && isPlotDataTypeValid(plot->t_plotMem.e_dataType))
+   else if( plotSize != (int)plot->t_plotMem.i_numSamples && plotSize > 0 && isPlotDataTypeValid(plot->t_plotMem.e_dataType) &&
+            !smartPlot_isPinned(listElem) )
    {
       int memberSize = PLOT_DATA_TYPE_SIZES[plot->t_plotMem.e_dataType];
       char* oldMem_toFree = plot->t_plotMem.pc_memory;
       char* newMem = NULL;
+      size_t oldMemBytes = listElem->i_memBytes;
 
-      plot->i_readIndex = plot->i_writeIndex = 0;
+      if(!smartPlot_reserveMem(listElem, (size_t)memberSize * plotSize))
+         return TRUE;
 
-      newMem = (char*)malloc(memberSize * plotSize);
+      newMem = smartPlot_allocRing((size_t)memberSize * plotSize);
       if(NULL == newMem)
-         return;
+      {
+         smartPlot_reserveMem(listElem, oldMemBytes);
+         return TRUE;
+      }
+
+      smartPlot_pauseFlushes(listElem);
+
+      smartPlot_linearizeSamples( newMem, oldMem_toFree, memberSize, plot->t_plotMem.i_numSamples,
+                                  plot->i_writeIndex, smartPlot_numSampKept(plot, plotSize) );
+      smartPlot_resizeIndexes(listElem, plotSize);
 
       plot->t_plotMem.pc_memory = newMem;
-      plot->t_plotMem.i_numSamples = plotSize;
-      free(oldMem_toFree);
+      plot->t_plotMem.b_mirrored = plotRingMem_isMirrored(newMem);
+      plotRingMem_free(oldMem_toFree);
+      smartPlot_resumeFlushes(listElem);
    }
 
    {
       int numSampToLeftToWrite = inDataSize;
       int numSampWritten = 0;
       int writeIndex = plot->i_writeIndex;
-      int numSampLeftForPlotSend;
       char* writeLocationPtr = plot->t_plotMem.pc_memory;
       char* readLocationPtr = (char*)inDataToPlot;
       int memberSize = PLOT_DATA_TYPE_SIZES[plot->t_plotMem.e_dataType];
 
-      int numSampAlreadyInBuff = (int)writeIndex - (int)plot->i_readIndex;
-      if(numSampAlreadyInBuff < 0)
-         numSampAlreadyInBuff += plot->t_plotMem.i_numSamples;
+      if(listElem->i_indexMask != 0 && numSampToLeftToWrite > 0)
+      {
+         smartPlot_writeMasked(&plot->t_plotMem, listElem->i_indexMask, writeIndex, readLocationPtr, numSampToLeftToWrite);
+         numSampWritten = numSampToLeftToWrite;
+         numSampToLeftToWrite = 0;
+      }
+
+      while(numSampToLeftToWrite > 0)
+      {
+         int numSampToEnd = smartPlot_numSampToEnd(&plot->t_plotMem, writeIndex);
+         int numSampToWrite = (numSampToEnd < numSampToLeftToWrite) ? numSampToEnd : numSampToLeftToWrite;
+         memcpy( &writeLocationPtr[memberSize * writeIndex],
+                 &readLocationPtr[memberSize * numSampWritten],
+                 memberSize * numSampToWrite );
+
+         numSampWritten += numSampToWrite;
+         numSampToLeftToWrite -= numSampToWrite;
+         writeIndex += numSampToWrite;
+         if(writeIndex >= (int)plot->t_plotMem.i_numSamples)
+         {
+            writeIndex -= plot->t_plotMem.i_numSamples;
+         }
+      }
+
+      smartPlot_1D_commit(listElem, numSampWritten, updateSize);
+   }
+
+   return TRUE;
+}
+
+void smartPlot_1D( const void* inDataToPlot,
+                   ePlotDataTypes inDataType,
+                   int inDataSize,
+                   int plotSize,
+                   int updateSize,
+                   const char* plotName,
+                   const char* curveName )
+{
+   tSmartPlotListElem* listElem = NULL;
+
+   // We can't make a new plot if the plot size or plot data type are not valid.
+   // If we are not making a new plot (i.e. the plot already exists) then these
+   // values do not need to be valid (we will just use the values that were used
+   // when the plot was created).
+   PLOTTER_BOOL newPlotParametersAreValid = (plotSize > 0 && isPlotDataTypeValid(inDataType));
+
+   PLOTTER_BOOL newPlot = smartPlot_find(plotName, curveName, &listElem, newPlotParametersAreValid);
+
+   // Check if we need to force this plot message to be sent from a background thread.
+   smartPlot_autoStartThread(&updateSize);
+
+   if(listElem == NULL)
+   {
+      return;
+   }
+
+   if(listElem->p_extWriteIndex != NULL)
+   {
+      // The samples are written by the owner of the external buffer, just pick up what they have written.
+      smartPlot_externalCommit(listElem, updateSize);
+   }
+   else
+   {
+      smartPlot_1D_listElem(listElem, newPlot, inDataToPlot, inDataType, inDataSize, plotSize, updateSize, plotName, curveName);
+   }
+
+   smartPlot_doneWriting(listElem);
+}
+
+tSmartPlotCurve smartPlot_registerExternal1D( const void* ringBuffer,
+                                              ePlotDataTypes dataType,
+                                              int ringSize,
+                                              const volatile unsigned int* writeIndex,
+                                              const char* plotName,
+                                              const char* curveName )
+{
+   tSmartPlotListElem* listElem = NULL;
+   tSendMemToPlot* plot;
+   int memberSize;
+
+   if(ringBuffer == NULL || writeIndex == NULL || ringSize <= 0 || !isPlotDataTypeValid(dataType))
+   {
+      return NULL;
+   }
+
+   if(!smartPlot_find(plotName, curveName, &listElem, TRUE) || listElem == NULL)
+   {
+      smartPlot_doneWriting(listElem);
+      return NULL; // The curve already exists (or couldn't be allocated).
+   }
+
+   plot = &listElem->cur;
+   memberSize = PLOT_DATA_TYPE_SIZES[dataType];
+
+   plot->t_plotMem.b_arrayOfStructs = FALSE;
+   plot->t_plotMem.b_interleaved = FALSE;
+   plot->t_plotMem.e_dataType = dataType;
+   plot->t_plotMem.e_plotDim = E_PLOT_1D;
+   plot->t_plotMem.i_bytesBetweenValues = memberSize;
+   plot->t_plotMem.i_dataSizeBytes = memberSize;
+   plot->t_plotMem.i_numSamples = ringSize;
+   plot->t_plotMem.pc_memory = (char*)ringBuffer;
+   listElem->i_indexMask = smartPlot_indexMask(ringSize);
+
+   sendMemoryToPlot_Init( plot, g_plotHostName, g_plotPort, TRUE, plotName, curveName);
+   plot->p_curveStats = &listElem->t_stats;
+
+   // Only samples written after the buffer was registered are plotted.
+   plot->i_readIndex = plot->i_writeIndex = plotThreading_acquireLoadU32(writeIndex) % (unsigned int)ringSize;
+   listElem->p_extWriteIndex = writeIndex;
+   plotThreading_releaseStoreU32(&listElem->i_ready, 1);
+
+   smartPlot_doneWriting(listElem);
+   return listElem;
+}
+
+tSmartPlotCurve smartPlot_getCurve1D( ePlotDataTypes dataType,
+                                      int plotSize,
+                                      const char* plotName,
+                                      const char* curveName )
+{
+   tSmartPlotListElem* listElem = NULL;
+   PLOTTER_BOOL newPlot;
+
+   if(plotSize <= 0 || !isPlotDataTypeValid(dataType))
+   {
+      return NULL;
+   }
+
+   newPlot = smartPlot_find(plotName, curveName, &listElem, TRUE);
+   if(listElem == NULL)
+   {
+      return NULL;
+   }
+
+   // Only hand out 1D curves of the requested type, otherwise the caller would write the wrong size samples.
+   if( !newPlot &&
+       ( listElem->interleavedPair != NULL ||
+         listElem->p_extWriteIndex != NULL ||
+         listElem->cur.t_plotMem.e_plotDim != E_PLOT_1D ||
+         listElem->cur.t_plotMem.e_dataType != dataType ) )
+   {
+      smartPlot_doneWriting(listElem);
+      return NULL;
+   }
+
+   // The caller keeps the handle, so the curve must never be evicted or resized. Pinned before
+   // the curve is allocated, so an existing curve keeps its size.
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   listElem->b_pinned = TRUE;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+
+   // Allocates the circular buffer for a new curve.
+   if(!smartPlot_1D_listElem(listElem, newPlot, NULL, dataType, 0, plotSize, -1, plotName, curveName))
+   {
+      smartPlot_doneWriting(listElem);
+      return NULL;
+   }
+
+   smartPlot_doneWriting(listElem);
+   return listElem;
+}
+
+void* smartPlot_curveBuffer(tSmartPlotCurve curve, unsigned int* writeIndex, unsigned int* numSamples)
+{
+   *writeIndex = curve->cur.i_writeIndex;
+   *numSamples = curve->cur.t_plotMem.i_numSamples;
+   return curve->cur.t_plotMem.pc_memory;
+}
+
+void smartPlot_curveCommit(tSmartPlotCurve curve, int numSampWritten, int updateSize)
+{
+   // Check if we need to force this plot message to be sent from a background thread.
+   smartPlot_autoStartThread(&updateSize);
+
+   smartPlot_1D_commit(curve, numSampWritten, updateSize);
+}
+
+static void smartPlot_2D_listElem( tSmartPlotListElem* listElem,
+                                   PLOTTER_BOOL newPlot,
+                                   const void* inDataToPlotX,
+                                   ePlotDataTypes inDataTypeX,
+                                   PLOTTER_BOOL repeatX, // Use the one X value for every sample.
+                                   const void* inDataToPlotY,
+                                   ePlotDataTypes inDataTypeY,
+                                   int inDataSize,
+                                   int plotSize,
+                                   int updateSize,
+                                   const char* plotName,
+                                   const char* curveName )
+{
+   tSendMemToPlot* plot = &listElem->cur;
+
+   plotSize = smartPlot_capacity(plotSize);
+
+   if(newPlot)
+   {
+      int memberSizeX = PLOT_DATA_TYPE_SIZES[inDataTypeX];
+      int memberSizeY = PLOT_DATA_TYPE_SIZES[inDataTypeY];
+      char* newMemX = NULL;
+      char* newMemY = NULL;
+      if(smartPlot_reserveMem(listElem, (size_t)(memberSizeX + memberSizeY) * plotSize))
+      {
+         newMemX = smartPlot_allocRing((size_t)memberSizeX * plotSize);
+         newMemY = smartPlot_allocRing((size_t)memberSizeY * plotSize);
+      }
+      if(NULL == newMemX || newMemY == NULL)
+      {
+         plotRingMem_free(newMemX);
+         plotRingMem_free(newMemY);
+         smartPlot_abandonNewPlot(listElem);
+         return;
+      }
+
+      plot->t_plotMem.b_arrayOfStructs = FALSE;
+      plot->t_plotMem.b_interleaved = FALSE;
+      plot->t_plotMem.e_dataType = inDataTypeX;
+      plot->t_plotMem.e_plotDim = E_PLOT_2D;
+      plot->t_plotMem.i_bytesBetweenValues = memberSizeX;
+      plot->t_plotMem.i_dataSizeBytes = memberSizeX;
+      plot->t_plotMem.i_numSamples = plotSize;
+      plot->t_plotMem.pc_memory = (char*)newMemX;
+      plot->t_plotMem.b_mirrored = plotRingMem_isMirrored(newMemX);
+
+      plot->t_plotMem_separateYAxis = plot->t_plotMem;
+      plot->t_plotMem_separateYAxis.e_dataType = inDataTypeY;
+      plot->t_plotMem_separateYAxis.i_bytesBetweenValues = memberSizeY;
+      plot->t_plotMem_separateYAxis.i_dataSizeBytes = memberSizeY;
+      plot->t_plotMem_separateYAxis.pc_memory = (char*)newMemY;
+      plot->t_plotMem_separateYAxis.b_mirrored = plotRingMem_isMirrored(newMemY);
+      listElem->i_indexMask = smartPlot_indexMask(plotSize);
+
+      sendMemoryToPlot_Init( plot, g_plotHostName, g_plotPort, TRUE, plotName, curveName);
+      plot->p_curveStats = &listElem->t_stats;
+      plotThreading_releaseStoreU32(&listElem->i_ready, 1);
+   }
+   else if(plotSize != (int)plot->t_plotMem.i_numSamples && plotSize > 0 && isPlotDataTypeValid(plot->t_plotMem.e_dataType) && isPlotDataTypeValid(plot->t_plotMem_separateYAxis.e_dataType))
+   {
+      int memberSizeX = PLOT_DATA_TYPE_SIZES[plot->t_plotMem.e_dataType];
+      int memberSizeY = PLOT_DATA_TYPE_SIZES[plot->t_plotMem_separateYAxis.e_dataType];
+      char* oldMem_toFreeX = plot->t_plotMem.pc_memory;
+      char* oldMem_toFreeY = plot->t_plotMem_separateYAxis.pc_memory;
+      char* newMemX = NULL;
+      char* newMemY = NULL;
+      size_t oldMemBytes = listElem->i_memBytes;
+      unsigned int numKeep = smartPlot_numSampKept(plot, plotSize);
+
+      if(!smartPlot_reserveMem(listElem, (size_t)(memberSizeX + memberSizeY) * plotSize))
+         return;
+
+      newMemX = smartPlot_allocRing((size_t)memberSizeX * plotSize);
+      newMemY = smartPlot_allocRing((size_t)memberSizeY * plotSize);
+      if(NULL == newMemX || NULL == newMemY)
+      {
+         plotRingMem_free(newMemX);
+         plotRingMem_free(newMemY);
+         smartPlot_reserveMem(listElem, oldMemBytes);
+         return;
+      }
+
+      smartPlot_pauseFlushes(listElem);
+
+      smartPlot_linearizeSamples( newMemX, oldMem_toFreeX, memberSizeX, plot->t_plotMem.i_numSamples,
+                                  plot->i_writeIndex, numKeep );
+      smartPlot_linearizeSamples( newMemY, oldMem_toFreeY, memberSizeY, plot->t_plotMem.i_numSamples,
+                                  plot->i_writeIndex, numKeep );
+      smartPlot_resizeIndexes(listElem, plotSize);
+
+      plot->t_plotMem.pc_memory = newMemX;
+      plot->t_plotMem.b_mirrored = plotRingMem_isMirrored(newMemX);
+      plotRingMem_free(oldMem_toFreeX);
+
+      plot->t_plotMem_separateYAxis.pc_memory = newMemY;
+      plot->t_plotMem_separateYAxis.b_mirrored = plotRingMem_isMirrored(newMemY);
+      plot->t_plotMem_separateYAxis.i_numSamples = plotSize;
+      plotRingMem_free(oldMem_toFreeY);
+      smartPlot_resumeFlushes(listElem);
+   }
+
+   {
+      int numSampToLeftToWrite = inDataSize;
+      int numSampWritten = 0;
+      int writeIndex = plot->i_writeIndex;
+      int numSampLeftForPlotSend;
+      char* writeLocationPtrX = plot->t_plotMem.pc_memory;
+      char* writeLocationPtrY = plot->t_plotMem_separateYAxis.pc_memory;
+      char* readLocationPtrX = (char*)inDataToPlotX;
+      char* readLocationPtrY = (char*)inDataToPlotY;
+      int memberSizeX = PLOT_DATA_TYPE_SIZES[plot->t_plotMem.e_dataType];
+      int memberSizeY = PLOT_DATA_TYPE_SIZES[plot->t_plotMem_separateYAxis.e_dataType];
+
+      int numSampAlreadyInBuff = smartPlot_numSampUnsent(listElem);
 
       // When update size is a negative number, no plot message should be sent.
       // Set update size to a value large than the number of samples in the plot
@@ -465,25 +1823,66 @@ void smartPlot_1D( const void* inDataToPlot,
 
       numSampLeftForPlotSend = updateSize - numSampAlreadyInBuff;
 
+      if(listElem->i_indexMask != 0 && numSampToLeftToWrite > 0)
+      {
+         unsigned int mask = listElem->i_indexMask;
+         if(repeatX)
+         {
+            unsigned int sampIndex;
+            for(sampIndex = 0; sampIndex < (unsigned int)numSampToLeftToWrite && sampIndex <= mask; ++sampIndex)
+            {
+               memcpy(&writeLocationPtrX[memberSizeX * ((writeIndex + sampIndex) & mask)], readLocationPtrX, memberSizeX);
+            }
+         }
+         else
+         {
+            smartPlot_writeMasked(&plot->t_plotMem, mask, writeIndex, readLocationPtrX, numSampToLeftToWrite);
+         }
+         writeIndex = (int)smartPlot_writeMasked(&plot->t_plotMem_separateYAxis, mask, writeIndex, readLocationPtrY, numSampToLeftToWrite);
+         numSampWritten = numSampToLeftToWrite;
+         numSampToLeftToWrite = 0;
+      }
+
       while(numSampToLeftToWrite > 0)
       {
-         int numSampToEnd = plot->t_plotMem.i_numSamples - writeIndex;
-         int numSampToWrite = (numSampToEnd < numSampToLeftToWrite) ? numSampToEnd : numSampToLeftToWrite;
-         memcpy( &writeLocationPtr[memberSize * writeIndex],
-                 &readLocationPtr[memberSize * numSampWritten],
-                 memberSize * numSampToWrite );
+         int numSampToEnd = smartPlot_numSampToEnd(&plot->t_plotMem, writeIndex);
+         int numSampToEndY = smartPlot_numSampToEnd(&plot->t_plotMem_separateYAxis, writeIndex);
+         int numSampToWrite;
+
+         if(numSampToEndY < numSampToEnd)
+            numSampToEnd = numSampToEndY;
+         numSampToWrite = (numSampToEnd < numSampToLeftToWrite) ? numSampToEnd : numSampToLeftToWrite;
+
+         if(repeatX)
+         {
+            int sampIndex;
+            for(sampIndex = 0; sampIndex < numSampToWrite; ++sampIndex)
+            {
+               memcpy(&writeLocationPtrX[memberSizeX * (writeIndex + sampIndex)], readLocationPtrX, memberSizeX);
+            }
+         }
+         else
+         {
+            memcpy( &writeLocationPtrX[memberSizeX * writeIndex],
+                    &readLocationPtrX[memberSizeX * numSampWritten],
+                    memberSizeX * numSampToWrite );
+         }
+         memcpy( &writeLocationPtrY[memberSizeY * writeIndex],
+                 &readLocationPtrY[memberSizeY * numSampWritten],
+                 memberSizeY * numSampToWrite );
 
          numSampWritten += numSampToWrite;
          numSampToLeftToWrite -= numSampToWrite;
          writeIndex += numSampToWrite;
          if(writeIndex >= (int)plot->t_plotMem.i_numSamples)
          {
-            writeIndex = 0;
+            writeIndex -= plot->t_plotMem.i_numSamples;
          }
       }
 
       if(numSampWritten > 0) // Only modify write index if it is changing.
          plot->i_writeIndex = writeIndex;
+      smartPlot_countWrite(listElem, numSampAlreadyInBuff, numSampWritten);
 
       // Never update plot if update size is greater than the plot size.
       if(plot->t_plotMem.i_numSamples >= (unsigned int)updateSize)
@@ -492,7 +1891,7 @@ void smartPlot_1D( const void* inDataToPlot,
          {
             // More samples need to be updated than size of the plot, send Create message (which will
             // send all the samples in the plot).
-            sendMemoryToPlot_Create1D(plot);
+            sendMemoryToPlot_Create2D(plot);
 
             // By sending the Create plot, all the data has been read. Set the read index to the write index.
             plot->i_readIndex = writeIndex;
@@ -507,18 +1906,18 @@ void smartPlot_1D( const void* inDataToPlot,
 
 }
 
-void smartPlot_2D( const void* inDataToPlotX,
-                   ePlotDataTypes inDataTypeX,
-                   const void* inDataToPlotY,
-                   ePlotDataTypes inDataTypeY,
-                   int inDataSize,
-                   int plotSize,
-                   int updateSize,
-                   const char* plotName,
-                   const char* curveName )
+static void smartPlot_2D_impl( const void* inDataToPlotX,
+                               ePlotDataTypes inDataTypeX,
+                               PLOTTER_BOOL repeatX,
+                               const void* inDataToPlotY,
+                               ePlotDataTypes inDataTypeY,
+                               int inDataSize,
+                               int plotSize,
+                               int updateSize,
+                               const char* plotName,
+                               const char* curveName )
 {
    tSmartPlotListElem* listElem = NULL;
-   tSendMemToPlot* plot = NULL;
 
    // We can't make a new plot if the plot size or plot data type are not valid.
    // If we are not making a new plot (i.e. the plot already exists) then these
@@ -536,243 +1935,601 @@ void smartPlot_2D( const void* inDataToPlotX,
       return;
    }
 
-   plot = &listElem->cur;
+   // External buffers are never written / resized by smartPlot (see smartPlot_registerExternal1D).
+   if(listElem->p_extWriteIndex != NULL)
+   {
+      smartPlot_doneWriting(listElem);
+      return;
+   }
 
-   if(newPlot)
+   smartPlot_2D_listElem( listElem, newPlot, inDataToPlotX, inDataTypeX, repeatX, inDataToPlotY, inDataTypeY,
+                          inDataSize, plotSize, updateSize, plotName, curveName );
+
+   smartPlot_doneWriting(listElem);
+}
+
+void smartPlot_2D( const void* inDataToPlotX,
+                   ePlotDataTypes inDataTypeX,
+                   const void* inDataToPlotY,
+                   ePlotDataTypes inDataTypeY,
+                   int inDataSize,
+                   int plotSize,
+                   int updateSize,
+                   const char* plotName,
+                   const char* curveName )
+{
+   smartPlot_2D_impl( inDataToPlotX, inDataTypeX, FALSE, inDataToPlotY, inDataTypeY,
+                      inDataSize, plotSize, updateSize, plotName, curveName );
+}
+
+static void smartPlot_borrowedPlotMem( tPlotMemory* plotMem,
+                                       const void* inDataToPlot,
+                                       ePlotDataTypes inDataType,
+                                       int inDataSize,
+                                       ePlotDim plotDim )
+{
+   plotMem->pc_memory = (char*)inDataToPlot;
+   plotMem->i_numSamples = (unsigned int)inDataSize;
+   plotMem->e_dataType = inDataType;
+   plotMem->i_dataSizeBytes = PLOT_DATA_TYPE_SIZES[inDataType];
+   plotMem->e_plotDim = plotDim;
+   plotMem->b_interleaved = FALSE;
+   plotMem->b_arrayOfStructs = FALSE;
+   plotMem->i_bytesBetweenValues = PLOT_DATA_TYPE_SIZES[inDataType];
+   plotMem->b_mirrored = FALSE;
+}
+
+int smartPlot_1D_borrowed( const void* inDataToPlot,
+                           ePlotDataTypes inDataType,
+                           int inDataSize,
+                           const char* plotName,
+                           const char* curveName )
+{
+   tSendMemToPlot plot;
+
+   if(inDataToPlot == NULL || inDataSize <= 0 || !isPlotDataTypeValid(inDataType))
    {
-      int memberSizeX = PLOT_DATA_TYPE_SIZES[inDataTypeX];
-      int memberSizeY = PLOT_DATA_TYPE_SIZES[inDataTypeY];
-      void* newMemX = malloc(memberSizeX * plotSize);
-      void* newMemY = malloc(memberSizeY * plotSize);
-      if(NULL == newMemX || newMemY == NULL)
-         return;
+      return -1;
+   }
 
-      plot->t_plotMem.b_arrayOfStructs = FALSE;
-      plot->t_plotMem.b_interleaved = FALSE;
-      plot->t_plotMem.e_dataType = inDataTypeX;
-      plot->t_plotMem.e_plotDim = E_PLOT_2D;
-      plot->t_plotMem.i_bytesBetweenValues = memberSizeX;
-      plot->t_plotMem.i_dataSizeBytes = memberSizeX;
-      plot->t_plotMem.i_numSamples = plotSize;
-      plot->t_plotMem.pc_memory = (char*)newMemX;
+   // The samples stay in the caller's memory, so this plot is never added to the list.
+   smartPlot_borrowedPlotMem(&plot.t_plotMem, inDataToPlot, inDataType, inDataSize, E_PLOT_1D);
+   sendMemoryToPlot_Init(&plot, g_plotHostName, g_plotPort, FALSE, plotName, curveName);
+   plot.b_closeSocketAfterSend = TRUE;
 
-      plot->t_plotMem_separateYAxis = plot->t_plotMem;
-      plot->t_plotMem_separateYAxis.e_dataType = inDataTypeY;
-      plot->t_plotMem_separateYAxis.i_bytesBetweenValues = memberSizeY;
-      plot->t_plotMem_separateYAxis.i_dataSizeBytes = memberSizeY;
-      plot->t_plotMem_separateYAxis.pc_memory = (char*)newMemY;
+   return sendMemoryToPlot_Borrowed(&plot);
+}
 
-      sendMemoryToPlot_Init( plot, g_plotHostName, g_plotPort, TRUE, plotName, curveName);
+int smartPlot_2D_borrowed( const void* inDataToPlotX,
+                           ePlotDataTypes inDataTypeX,
+                           const void* inDataToPlotY,
+                           ePlotDataTypes inDataTypeY,
+                           int inDataSize,
+                           const char* plotName,
+                           const char* curveName )
+{
+   tSendMemToPlot plot;
+
+   if( inDataToPlotX == NULL || inDataToPlotY == NULL || inDataSize <= 0 ||
+       !isPlotDataTypeValid(inDataTypeX) || !isPlotDataTypeValid(inDataTypeY) )
+   {
+      return -1;
    }
-   else if(plotSize != (int)plot->t_plotMem.i_numSamples && plotSize > 0 && isPlotDataTypeValid(plot->t_plotMem.e_dataType) && isPlotDataTypeValid(plot->t_plotMem_separateYAxis.e_dataType))
+
+   smartPlot_borrowedPlotMem(&plot.t_plotMem, inDataToPlotX, inDataTypeX, inDataSize, E_PLOT_2D);
+   smartPlot_borrowedPlotMem(&plot.t_plotMem_separateYAxis, inDataToPlotY, inDataTypeY, inDataSize, E_PLOT_2D);
+   sendMemoryToPlot_Init(&plot, g_plotHostName, g_plotPort, FALSE, plotName, curveName);
+   plot.b_closeSocketAfterSend = TRUE;
+
+   return sendMemoryToPlot_Borrowed(&plot);
+}
+
+
+// Same as calling the smartPlot_flush_* function that matches the list element, but
+// without having to look the list element up by its plot / curve name.
+static void smartPlot_flushListElem(tSmartPlotListElem* listElem)
+{
+   if(listElem->interleavedPair != NULL)
    {
-      int memberSizeX = PLOT_DATA_TYPE_SIZES[plot->t_plotMem.e_dataType];
-      int memberSizeY = PLOT_DATA_TYPE_SIZES[plot->t_plotMem_separateYAxis.e_dataType];
-      char* oldMem_toFreeX = plot->t_plotMem.pc_memory;
-      char* oldMem_toFreeY = plot->t_plotMem_separateYAxis.pc_memory;
-      char* newMemX = NULL;
-      char* newMemY = NULL;
+      // This is an interleaved plot. Only plot interleaved as X, Y. Not Y, X.
+      if(listElem->interleaved_isXAxis)
+      {
+         smartPlot_interleaved_listElem( listElem, listElem->interleavedPair, FALSE,
+                                         NULL, E_INVALID_DATA_TYPE, 0, 0, 0, NULL, NULL, NULL );
+      }
+   }
+   else if(listElem->cur.t_plotMem.e_plotDim == E_PLOT_2D)
+   {
+      // This is NOT an interleaved plot, flush as 2D.
+      smartPlot_2D_listElem( listElem, FALSE, NULL, E_INVALID_DATA_TYPE, FALSE, NULL, E_INVALID_DATA_TYPE,
+                             0, 0, 0, NULL, NULL );
+   }
+   else if(listElem->p_extWriteIndex != NULL)
+   {
+      smartPlot_externalCommit(listElem, 0);
+   }
+   else
+   {
+      // This is NOT an interleaved plot, flush as 1D.
+      smartPlot_1D_listElem(listElem, FALSE, NULL, E_INVALID_DATA_TYPE, 0, 0, 0, NULL, NULL);
+   }
+}
 
-      plot->i_readIndex = plot->i_writeIndex = 0;
+void smartPlot_flush_all()
+{
+   tSmartPlotListElem* smartPlotList = smartPlot_flushBegin();
+   if(smartPlotList != NULL)
+   {
+      smartPlot_groupMsgStart(); // Send all flushed plots as one big message.
+      do
+      {
+         smartPlot_flushIfReady(smartPlotList);
+         smartPlotList = smartPlotList->next;
+      }while(smartPlotList != NULL && smartPlotList != gt_smartPlotList);// List is circular. When it wraps back to beginning of the list, stop looping. NULL if every curve was removed during the flush.
+      smartPlot_groupMsgEnd(); // Send the big group message with all the flushed plot messages.
+   }
+   smartPlot_flushEnd();
+}
 
-      newMemX = (char*)malloc(memberSizeX * plotSize);
-      newMemY = (char*)malloc(memberSizeY * plotSize);
-      if(NULL == newMemX || NULL == newMemY)
-         return;
+// Maps a hash to a worker. Multiply / shift rather than modulo, so scanning the registry doesn't divide.
+static inline unsigned int smartPlot_shardIndex(unsigned int hash, unsigned int numWorkers)
+{
+   return (unsigned int)(((PLOTTER_UINT_64)hash * numWorkers) >> 32);
+}
 
-      plot->t_plotMem.pc_memory = newMemX;
-      plot->t_plotMem.i_numSamples = plotSize;
-      free(oldMem_toFreeX);
+// Like smartPlot_flushBegin, but copies the curves the worker owns out of gt_flushRegistry
+// into worker->pp_scan. Returns the number of curves copied.
+static unsigned int smartPlot_flushBeginShard(tSmartPlotFlushWorker* worker)
+{
+   const tSmartPlotRegistry* registry = &gt_flushRegistry;
+   const unsigned int* hashes;
+   unsigned int numOwned = 0;
+   unsigned int index;
 
-      plot->t_plotMem_separateYAxis.pc_memory = newMemY;
-      plot->t_plotMem_separateYAxis.i_numSamples = plotSize;
-      free(oldMem_toFreeY);
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   g_numFlushesInProgress++;
+
+   if(worker->i_scanCapacity < registry->i_numCurves)
+   {
+      tSmartPlotListElem** newScan = (tSmartPlotListElem**)realloc(worker->pp_scan, registry->i_capacity * sizeof(*newScan));
+      if(newScan != NULL)
+      {
+         worker->pp_scan = newScan;
+         worker->i_scanCapacity = registry->i_capacity;
+      }
    }
 
+   hashes = worker->b_shardByEndpoint ? registry->pi_endpointHashes : registry->pi_nameHashes;
+   for(index = 0; index < registry->i_numCurves && numOwned < worker->i_scanCapacity; ++index)
    {
-      int numSampToLeftToWrite = inDataSize;
-      int numSampWritten = 0;
-      int writeIndex = plot->i_writeIndex;
-      int numSampLeftForPlotSend;
-      char* writeLocationPtrX = plot->t_plotMem.pc_memory;
-      char* writeLocationPtrY = plot->t_plotMem_separateYAxis.pc_memory;
-      char* readLocationPtrX = (char*)inDataToPlotX;
-      char* readLocationPtrY = (char*)inDataToPlotY;
-      int memberSizeX = PLOT_DATA_TYPE_SIZES[plot->t_plotMem.e_dataType];
-      int memberSizeY = PLOT_DATA_TYPE_SIZES[plot->t_plotMem_separateYAxis.e_dataType];
+      if(smartPlot_shardIndex(hashes[index], worker->i_numWorkers) == worker->i_workerIndex)
+      {
+         worker->pp_scan[numOwned++] = registry->pp_listElems[index];
+      }
+   }
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
 
-      int numSampAlreadyInBuff = (int)writeIndex - (int)plot->i_readIndex;
-      if(numSampAlreadyInBuff < 0)
-         numSampAlreadyInBuff += plot->t_plotMem.i_numSamples;
+   return numOwned;
+}
 
-      // When update size is a negative number, no plot message should be sent.
-      // Set update size to a value large than the number of samples in the plot
-      // to ensure a message is not sent.
-      if(updateSize < 0)
-         updateSize = plot->t_plotMem.i_numSamples + 1;
+// Returns the worker's connection to the curve's PlotGUI, creating it if needed.
+static tSmartPlotWorkerConn* smartPlot_getWorkerConn(tSmartPlotFlushWorker* worker, const tSendMemToPlot* plot)
+{
+   unsigned int connIndex;
+   for(connIndex = 0; connIndex < worker->i_numConns; ++connIndex)
+   {
+      tSendMemToPlot* connSendMem = &worker->at_conns[connIndex].t_sendMem;
+      if(connSendMem->s_ipPort == plot->s_ipPort && strcmp(connSendMem->pc_ipAddr, plot->pc_ipAddr) == 0)
+      {
+         return &worker->at_conns[connIndex];
+      }
+   }
 
-      numSampLeftForPlotSend = updateSize - numSampAlreadyInBuff;
+   if(worker->i_numConns < MAX_FLUSH_WORKER_ENDPOINTS)
+   {
+      tSmartPlotWorkerConn* newConn = &worker->at_conns[worker->i_numConns];
+      sendMemoryToPlot_Init(&newConn->t_sendMem, plot->pc_ipAddr, plot->s_ipPort, FALSE, "", "");
+      plotMsgGroupInit(&newConn->t_group, &newConn->t_sendMem);
+      worker->i_numConns++;
+      return newConn;
+   }
 
-      while(numSampToLeftToWrite > 0)
+   return NULL; // Too many PlotGUIs. The curve's messages will be sent on the curve's own connection.
+}
+
+// Flushes all the curves that belong to the worker. The messages for each PlotGUI
+// are grouped into one message and sent on the worker's own connection.
+static void smartPlot_flushWorkerShard(tSmartPlotFlushWorker* worker)
+{
+   unsigned int connIndex;
+   unsigned int numOwned = smartPlot_flushBeginShard(worker);
+   unsigned int scanIndex;
+
+   // Interleaved pairs are only in the registry via the X Axis, so the X Axis decides which worker owns the pair.
+   for(scanIndex = 0; scanIndex < numOwned; ++scanIndex)
+   {
+      tSmartPlotListElem* listElem = worker->pp_scan[scanIndex];
+      if(plotThreading_acquireLoadU32(&listElem->i_ready))
       {
-         int numSampToEnd = plot->t_plotMem.i_numSamples - writeIndex;
-         int numSampToWrite = (numSampToEnd < numSampToLeftToWrite) ? numSampToEnd : numSampToLeftToWrite;
+         tSmartPlotWorkerConn* conn = smartPlot_getWorkerConn(worker, &listElem->cur);
+         plotMsgGroupSelect(conn != NULL ? &conn->t_group : NULL);
+         smartPlot_flushIfReady(listElem);
+      }
+   }
+   plotMsgGroupSelect(NULL);
+   smartPlot_flushEnd();
 
-         memcpy( &writeLocationPtrX[memberSizeX * writeIndex],
-                 &readLocationPtrX[memberSizeX * numSampWritten],
-                 memberSizeX * numSampToWrite );
-         memcpy( &writeLocationPtrY[memberSizeY * writeIndex],
-                 &readLocationPtrY[memberSizeY * numSampWritten],
-                 memberSizeY * numSampToWrite );
+   for(connIndex = 0; connIndex < worker->i_numConns; ++connIndex)
+   {
+      plotMsgGroupSend(&worker->at_conns[connIndex].t_group);
+   }
+}
 
-         numSampWritten += numSampToWrite;
-         numSampToLeftToWrite -= numSampToWrite;
-         writeIndex += numSampToWrite;
-         if(writeIndex >= (int)plot->t_plotMem.i_numSamples)
-         {
-            writeIndex = 0;
-         }
+// Combines the flush pool workers' measurements into gt_plotThread_stats. The workers flush at
+// the same time, so a flush of the pool sends all their bytes and takes as long as the slowest
+// worker. gt_plotThread_stats_mutex must be locked.
+static void smartPlot_combinePoolStats(const tSmartPlotFlushWorker* workers, unsigned int numWorkers)
+{
+   tSmartPlotFlushStats* poolStats = &gt_plotThread_stats;
+   unsigned int numMeasured = 0;
+   unsigned int workerIndex;
+
+   memset(poolStats, 0, sizeof(*poolStats));
+   poolStats->curPeriodMs = workers[0].t_flushStats.curPeriodMs;
+   poolStats->minPeriodMs = workers[0].t_flushStats.minPeriodMs;
+   poolStats->maxPeriodMs = workers[0].t_flushStats.maxPeriodMs;
+
+   for(workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+   {
+      const tSmartPlotFlushStats* workerStats = &workers[workerIndex].t_flushStats;
+      poolStats->numFlushes += workerStats->numFlushes;
+      poolStats->lastFlushBytes += workerStats->lastFlushBytes;
+      if(workerStats->lastFlushDurationUs > poolStats->lastFlushDurationUs)
+      {
+         poolStats->lastFlushDurationUs = workerStats->lastFlushDurationUs;
+      }
+      poolStats->dataRateBytesPerSec += workerStats->dataRateBytesPerSec;
+      if(workerStats->sendLatencyUs > 0.0)
+      {
+         poolStats->sendLatencyUs += workerStats->sendLatencyUs;
+         poolStats->sendNsPerByte += workerStats->sendNsPerByte;
+         numMeasured++;
+      }
+   }
+
+   if(numMeasured > 0)
+   {
+      poolStats->sendLatencyUs /= numMeasured;
+      poolStats->sendNsPerByte /= numMeasured;
+   }
+}
+
+// Flushes the worker's curves and updates the flush stats with what was measured.
+// poolStats (Out) - The pool's combined flush stats, including this flush.
+static void smartPlot_measuredFlushShard(tSmartPlotFlushWorker* worker, tSmartPlotFlushStats* poolStats)
+{
+   // The workers are allocated as one array, in worker index order.
+   const tSmartPlotFlushWorker* workers = worker - worker->i_workerIndex;
+   tSendMemToPlotTotals totalsBefore;
+   tSendMemToPlotTotals totalsAfter;
+   PLOTTER_UINT_64 flushStartTimeNs;
+   PLOTTER_UINT_64 flushDurationNs;
+
+   sendMemoryToPlot_getThreadTotals(&totalsBefore);
+   flushStartTimeNs = plotStats_getTimeNs();
+
+   smartPlot_flushWorkerShard(worker);
+
+   flushDurationNs = plotStats_getTimeNs() - flushStartTimeNs;
+   sendMemoryToPlot_getThreadTotals(&totalsAfter);
+
+   plotThreading_mutexLock(&gt_plotThread_stats_mutex);
+   smartPlot_recordFlush(&worker->t_flushStats, &totalsBefore, &totalsAfter, flushDurationNs);
+   smartPlot_combinePoolStats(workers, worker->i_numWorkers);
+   *poolStats = gt_plotThread_stats;
+   plotThreading_mutexUnlock(&gt_plotThread_stats_mutex);
+}
+
+static void* smartPlot_flushWorkerThread(void* p_threadParams)
+{
+   tPlotThreadParams threadParams = *((tPlotThreadParams*)p_threadParams);
+   tSmartPlotFlushWorker* worker = (tSmartPlotFlushWorker*)threadParams.userData;
+
+   while(1)
+   {
+      tSmartPlotFlushStats poolStats;
+#ifdef PLOTTER_WINDOWS_BUILD
+      Sleep(threadParams.timeBetweenMs);
+#else
+      usleep(threadParams.timeBetweenMs*1000);
+#endif
+      smartPlot_measuredFlushShard(worker, &poolStats);
+
+      // Only one thread can publish the telemetry curves. The flush curves are the whole pool's.
+      if(worker->i_workerIndex == 0)
+      {
+         smartPlot_publishTelemetry(&poolStats);
+      }
+   }
+   return NULL;
+}
+
+
+void smartPlot_groupMsgStart()
+{
+   plotMsgGroupStart();
+}
+
+void smartPlot_groupMsgEnd()
+{
+   plotMsgGroupEnd();
+}
+
+
+void smartPlot_deallocate( const char* plotName,
+                           const char* curveName )
+{
+   tSmartPlotListElem* listElem = NULL;
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+
+   listElem = smartPlot_findListElem(plotName, curveName);
+
+   if(listElem != NULL)
+   {
+      smartPlot_removeListElem(listElem);
+   }
+
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
+
+void smartPlot_deallocate_interleaved( const char* plotName,
+                                       const char* curveName_x,
+                                       const char* curveName_y)
+{
+   smartPlot_deallocate(plotName, curveName_x);
+   smartPlot_deallocate(plotName, curveName_y);
+}
+
+void smartPlot_setMemoryBudget(unsigned long long maxBytes, unsigned int minIdleMs)
+{
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+
+   g_memBudget_maxBytes = maxBytes;
+   g_memBudget_minIdleNs = (PLOTTER_UINT_64)minIdleMs * 1000000;
+
+   // Get under the new budget now, rather than when the next curve is allocated.
+   if(maxBytes > 0)
+   {
+      while(g_memBudget_usedBytes > maxBytes)
+      {
+         if(!smartPlot_evictLeastRecentlyWritten(NULL))
+            break;
       }
+   }
+
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
+
+void smartPlot_configureRingMemory(size_t mmapThresholdBytes, int flags)
+{
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   g_ringMem_mmapThresholdBytes = mmapThresholdBytes;
+   g_ringMem_flags = flags;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
+
+void smartPlot_setRingAllocator(tSmartPlotRingAlloc allocFunc, tSmartPlotRingFree freeFunc, void* userData)
+{
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   g_ringMem_allocFunc = allocFunc;
+   g_ringMem_freeFunc = freeFunc;
+   g_ringMem_userData = userData;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+}
+
+void smartPlot_enablePow2Capacity(int enable)
+{
+   g_pow2Capacity_enabled = enable != 0;
+}
+
+void smartPlot_createFlushThread(unsigned int sleepBetweenFlush_ms)
+{
+   g_plotThread_created = TRUE;
+   plotThreading_createNewThread(smartPlot_flushThread, sleepBetweenFlush_ms);
+}
 
-      if(numSampWritten > 0) // Only modify write index if it is changing.
-         plot->i_writeIndex = writeIndex;
+void smartPlot_createFlushThread_withPriorityPolicy(unsigned int sleepBetweenFlush_ms, int priority, int policy)
+{
+   g_plotThread_created = TRUE;
+   plotThreading_createNewThread_withPriorityPolicy(smartPlot_flushThread, sleepBetweenFlush_ms, priority, policy);
+}
 
-      // Never update plot if update size is greater than the plot size.
-      if(plot->t_plotMem.i_numSamples >= (unsigned int)updateSize)
-      {
-         if( (numSampAlreadyInBuff + numSampWritten) >= (int)plot->t_plotMem.i_numSamples )
-         {
-            // More samples need to be updated than size of the plot, send Create message (which will
-            // send all the samples in the plot).
-            sendMemoryToPlot_Create2D(plot);
+void smartPlot_createFlushThread_adaptive(unsigned int minSleepBetweenFlush_ms, unsigned int maxSleepBetweenFlush_ms)
+{
+   if(minSleepBetweenFlush_ms < ADAPTIVE_FLUSH_MIN_PERIOD_MS)
+   {
+      minSleepBetweenFlush_ms = ADAPTIVE_FLUSH_MIN_PERIOD_MS;
+   }
+   if(maxSleepBetweenFlush_ms < minSleepBetweenFlush_ms)
+   {
+      maxSleepBetweenFlush_ms = minSleepBetweenFlush_ms;
+   }
+   g_plotThread_adaptiveMinTimeMs = minSleepBetweenFlush_ms;
+   g_plotThread_adaptiveMaxTimeMs = maxSleepBetweenFlush_ms;
 
-            // By sending the Create plot, all the data has been read. Set the read index to the write index.
-            plot->i_readIndex = writeIndex;
-         }
-         else if(numSampWritten >= numSampLeftForPlotSend)
-         {
-            sendMemoryToPlot(plot);
-         }
-      }
+   g_plotThread_created = TRUE;
+   plotThreading_createNewThread(smartPlot_adaptiveFlushThread, minSleepBetweenFlush_ms); // Start out at the low latency end.
+}
+
+void smartPlot_createFlushPool(unsigned int numWorkers, unsigned int sleepBetweenFlush_ms, int shardByEndpoint)
+{
+   tSmartPlotFlushWorker* workers;
+   unsigned int workerIndex;
 
+   if(numWorkers == 0)
+   {
+      numWorkers = 1;
    }
 
+   workers = (tSmartPlotFlushWorker*)calloc(numWorkers, sizeof(tSmartPlotFlushWorker));
+   if(NULL == workers)
+      return;
+
+   g_plotThread_created = TRUE;
+   for(workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+   {
+      workers[workerIndex].i_workerIndex = workerIndex;
+      workers[workerIndex].i_numWorkers = numWorkers;
+      workers[workerIndex].b_shardByEndpoint = shardByEndpoint ? TRUE : FALSE;
+      workers[workerIndex].t_flushStats.curPeriodMs = sleepBetweenFlush_ms;
+      workers[workerIndex].t_flushStats.minPeriodMs = sleepBetweenFlush_ms;
+      workers[workerIndex].t_flushStats.maxPeriodMs = sleepBetweenFlush_ms;
+      plotThreading_createNewThread_withUserData(smartPlot_flushWorkerThread, sleepBetweenFlush_ms, &workers[workerIndex]);
+   }
 }
 
+void smartPlot_getFlushStats(tSmartPlotFlushStats* stats)
+{
+   plotThreading_mutexLock(&gt_plotThread_stats_mutex);
+   *stats = gt_plotThread_stats;
+   plotThreading_mutexUnlock(&gt_plotThread_stats_mutex);
+}
 
-void smartPlot_flush_all()
+void smartPlot_getStats( tSmartPlotStats* stats,
+                         tSmartPlotCurveStats* curves,
+                         unsigned int maxCurves,
+                         tSmartPlotEndpointStats* endpoints,
+                         unsigned int maxEndpoints )
 {
+   unsigned int numCurves = 0;
+
+   memset(stats, 0, sizeof(*stats));
+
+   plotThreading_mutexLock(&gt_smartPlotList_mutex);
    if(gt_smartPlotList != NULL)
    {
-      tSmartPlotListElem* smartPlotList = gt_smartPlotList;
-      smartPlot_groupMsgStart(); // Send all flushed plots as one big message.
+      tSmartPlotListElem* list = gt_smartPlotList;
       do
       {
-         if(smartPlotList->interleavedPair != NULL)
-         {
-            // This is an interleaved plot. Only plot interleaved as X, Y. Not Y, X.
-            if(smartPlotList->interleaved_isXAxis)
-            {
-               smartPlot_flush_interleaved( smartPlotList->cur.pc_plotName,
-                                            smartPlotList->cur.pc_curveName, // X Axis
-                                            smartPlotList->interleavedPair->cur.pc_curveName ); // Y Axis
-            }
-         }
-         else if(smartPlotList->cur.t_plotMem.e_plotDim == E_PLOT_2D)
-         {
-            // This is NOT an interleaved plot, flush as 2D.
-            smartPlot_flush_2D(smartPlotList->cur.pc_plotName, smartPlotList->cur.pc_curveName);
-         }
-         else
+         if(curves != NULL && numCurves < maxCurves)
          {
-            // This is NOT an interleaved plot, flush as 1D.
-            smartPlot_flush_1D(smartPlotList->cur.pc_plotName, smartPlotList->cur.pc_curveName);
+            const tSendMemToPlot* plot = &list->cur;
+            tSmartPlotCurveStats* curve = &curves[numCurves];
+            int numSampUnsent = smartPlot_numSampUnsent(list);
+
+            plotStats_copyName(curve->plotName, sizeof(curve->plotName), plot->pc_plotName);
+            plotStats_copyName(curve->curveName, sizeof(curve->curveName), plot->pc_curveName);
+            curve->samplesWritten = plotThreading_atomicLoad(&list->t_stats.i_samplesWritten);
+            curve->samplesOverwritten = plotThreading_atomicLoad(&list->t_stats.i_samplesOverwritten);
+            curve->samplesUnsent = numSampUnsent;
+            curve->msgsGenerated = plotThreading_atomicLoad(&list->t_stats.i_msgsGenerated);
+            curve->bytesGenerated = plotThreading_atomicLoad(&list->t_stats.i_bytesGenerated);
          }
-         smartPlotList = smartPlotList->next;
-      }while(smartPlotList != gt_smartPlotList);// List is circular. When it wraps back to beginning of the list, stop looping.
-      smartPlot_groupMsgEnd(); // Send the big group message with all the flushed plot messages.
+         numCurves++;
+         list = list->next;
+      }
+      while(list != gt_smartPlotList); // List is circular. When it wraps back to beginning of the list, stop looping.
    }
-}
+   stats->memBytes = g_memBudget_usedBytes;
+   stats->memBudgetBytes = g_memBudget_maxBytes;
+   stats->curvesEvicted = g_memBudget_numEvicted;
+   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
 
+   stats->numCurves = numCurves;
+   stats->numEndpoints = sendMemoryToPlot_getEndpointStats(endpoints, endpoints != NULL ? maxEndpoints : 0);
+   sendMemoryToPlot_getEncodeLatency(&stats->encodeLatency);
+   smartPlot_getFlushStats(&stats->flush);
+}
 
-void smartPlot_groupMsgStart()
+static int smartPlot_compareCurveBytes(const void* a, const void* b)
 {
-   plotMsgGroupStart();
+   const tSmartPlotCurveStats* curveA = (const tSmartPlotCurveStats*)a;
+   const tSmartPlotCurveStats* curveB = (const tSmartPlotCurveStats*)b;
+   if(curveA->bytesGenerated == curveB->bytesGenerated)
+      return 0;
+   return curveA->bytesGenerated > curveB->bytesGenerated ? -1 : 1;
 }
 
-void smartPlot_groupMsgEnd()
+static void smartPlot_printLatency(FILE* file, const char* name, const tSmartPlotLatencyStats* latency)
 {
-   plotMsgGroupEnd();
+   fprintf( file, "%s: count %llu, mean %llu ns, p50 %llu ns, p90 %llu ns, p99 %llu ns, max %llu ns\n",
+            name, latency->count, latency->meanNs, latency->p50Ns, latency->p90Ns, latency->p99Ns, latency->maxNs );
 }
 
-
-void smartPlot_deallocate( const char* plotName,
-                           const char* curveName )
+int smartPlot_dumpStats(const char* fileName)
 {
-   tSmartPlotListElem* listElem = NULL;
-   plotThreading_mutexLock(&gt_smartPlotList_mutex);
+   tSmartPlotStats stats;
+   tSmartPlotCurveStats* curves = NULL;
+   tSmartPlotEndpointStats* endpoints = NULL;
+   unsigned int numCurves;
+   unsigned int numEndpoints;
+   unsigned int index;
+   FILE* file;
+
+   // Get the counts first so the arrays can be sized.
+   smartPlot_getStats(&stats, NULL, 0, NULL, 0);
+   curves = (tSmartPlotCurveStats*)calloc(stats.numCurves + 1, sizeof(tSmartPlotCurveStats));
+   endpoints = (tSmartPlotEndpointStats*)calloc(stats.numEndpoints + 1, sizeof(tSmartPlotEndpointStats));
+   if(curves == NULL || endpoints == NULL)
+   {
+      free(curves);
+      free(endpoints);
+      return -1;
+   }
+   numCurves = stats.numCurves;
+   numEndpoints = stats.numEndpoints;
+   smartPlot_getStats(&stats, curves, numCurves, endpoints, numEndpoints);
+   numCurves = stats.numCurves < numCurves ? stats.numCurves : numCurves;
+   numEndpoints = stats.numEndpoints < numEndpoints ? stats.numEndpoints : numEndpoints;
 
-   listElem = smartPlot_findListElem(plotName, curveName);
+   qsort(curves, numCurves, sizeof(tSmartPlotCurveStats), smartPlot_compareCurveBytes);
 
-   if(listElem != NULL)
+   file = fopen(fileName, "w");
+   if(file == NULL)
    {
-      if(listElem->next == listElem)
-      {
-         // This is the only entry in the list.
-         gt_smartPlotList = NULL;
-      }
-      else
-      {
-         tSmartPlotListElem* oldPrev = listElem->prev;
-         tSmartPlotListElem* oldNext = listElem->next;
-         oldPrev->next = oldNext;
-         oldNext->prev = oldPrev;
-         if(gt_smartPlotList == listElem)
-         {
-            // This was the first element in the list.
-            gt_smartPlotList = oldNext;
-         }
-      }
+      free(curves);
+      free(endpoints);
+      return -1;
+   }
 
-      // Close the TCP Socket
-      if(listElem->cur.i_tcpSocketFd >= 0)
-         sendTCPPacket_close(listElem->cur.i_tcpSocketFd);
+   fprintf(file, "Flush: %s, period %u ms, %llu flushes, last flush %llu bytes in %llu us\n",
+           stats.flush.adaptive ? "adaptive" : "fixed", stats.flush.curPeriodMs, stats.flush.numFlushes,
+           stats.flush.lastFlushBytes, stats.flush.lastFlushDurationUs);
+   fprintf(file, "Memory: %llu bytes, budget %llu bytes (0 is unlimited), %llu curves evicted\n",
+           stats.memBytes, stats.memBudgetBytes, stats.curvesEvicted);
+   smartPlot_printLatency(file, "Encode", &stats.encodeLatency);
 
-      // Free the memory allocated for the current plot / curve, but make sure not to free it twice.
-      // If this is an interleaved plot and this is the Y Axis, do not free the memory.
-      if(listElem->interleavedPair == NULL || listElem->interleaved_isXAxis)
-      {
-         free(listElem->cur.t_plotMem.pc_memory);
-         if(listElem->cur.t_plotMem.e_plotDim == E_PLOT_2D)
-         {
-            // Need to free Y axis of 2D plot.
-            free(listElem->cur.t_plotMem_separateYAxis.pc_memory);
-         }
-      }
-      free(listElem);
+   fprintf(file, "\nEndpoints (%u)\n", stats.numEndpoints);
+   for(index = 0; index < numEndpoints; ++index)
+   {
+      const tSmartPlotEndpointStats* endpoint = &endpoints[index];
+      fprintf(file, "%s:%u msgs %llu, bytes %llu, send errors %llu, connects %llu, connect failures %llu, connections reused %llu\n",
+              endpoint->hostName, (unsigned int)endpoint->port, endpoint->msgsSent, endpoint->bytesSent,
+              endpoint->sendErrors, endpoint->connects, endpoint->connectFailures, endpoint->connsReused);
+      smartPlot_printLatency(file, "   Send", &endpoint->sendLatency);
+      smartPlot_printLatency(file, "   Connect", &endpoint->connectLatency);
    }
 
-   plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
-}
-
-void smartPlot_deallocate_interleaved( const char* plotName,
-                                       const char* curveName_x,
-                                       const char* curveName_y)
-{
-   smartPlot_deallocate(plotName, curveName_x);
-   smartPlot_deallocate(plotName, curveName_y);
-}
+   fprintf(file, "\nCurves (%u)\n", stats.numCurves);
+   fprintf(file, "Plot Name,Curve Name,Bytes,Msgs,Samples Written,Samples Overwritten,Samples Unsent\n");
+   for(index = 0; index < numCurves; ++index)
+   {
+      const tSmartPlotCurveStats* curve = &curves[index];
+      fprintf(file, "%s,%s,%llu,%llu,%llu,%llu,%llu\n",
+              curve->plotName, curve->curveName, curve->bytesGenerated, curve->msgsGenerated,
+              curve->samplesWritten, curve->samplesOverwritten, curve->samplesUnsent);
+   }
 
-void smartPlot_createFlushThread(unsigned int sleepBetweenFlush_ms)
-{
-   g_plotThread_created = TRUE;
-   plotThreading_createNewThread(smartPlot_flushThread, sleepBetweenFlush_ms);
+   fclose(file);
+   free(curves);
+   free(endpoints);
+   return 0;
 }
 
-void smartPlot_createFlushThread_withPriorityPolicy(unsigned int sleepBetweenFlush_ms, int priority, int policy)
+void smartPlot_enableTelemetry(unsigned int publishPeriod_ms, int plotSize)
 {
-   g_plotThread_created = TRUE;
-   plotThreading_createNewThread_withPriorityPolicy(smartPlot_flushThread, sleepBetweenFlush_ms, priority, policy);
+   g_telemetry_plotSize = plotSize;
+   g_telemetry_periodMs = publishPeriod_ms;
 }
 
 void smartPlot_getTime(tSmartPlotTime* pTime)
@@ -808,15 +2565,202 @@ void smartPlot_sleep(float sleepTimeSec)
 #endif
 }
 
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+// Reads the Monotonic clock between two tick reads, keeping the tightest of a few tries.
+static void fastClock_readCalibrationPoint(PLOTTER_UINT_64* pTicks, PLOTTER_UINT_64* pNs)
+{
+   PLOTTER_UINT_64 bestTicksWidth = ~0ull;
+   int i;
+
+   for(i = 0; i < 5; ++i)
+   {
+      tSmartPlotTime nowTime;
+      PLOTTER_UINT_64 beforeTicks = plotClock_readTicks();
+      smartPlot_getTime(&nowTime);
+      PLOTTER_UINT_64 afterTicks = plotClock_readTicks();
+
+      if(afterTicks - beforeTicks < bestTicksWidth)
+      {
+         bestTicksWidth = afterTicks - beforeTicks;
+         *pTicks = beforeTicks + bestTicksWidth / 2;
+         *pNs = plotStats_timeToNs(&nowTime);
+      }
+   }
+}
+
+// Must be called with gt_fastClock_mutex locked.
+static void fastClock_recalibrate()
+{
+   fastClock_readCalibrationPoint(&g_fastClock_baseTicks, &g_fastClock_baseNs);
+   if(g_fastClock_baseTicks > g_fastClock_startTicks)
+   {
+      g_fastClock_nsPerTick = (double)(g_fastClock_baseNs - g_fastClock_startNs) / (double)(g_fastClock_baseTicks - g_fastClock_startTicks);
+   }
+}
+#endif
+
+int smartPlot_enableFastClock(int enable)
+{
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+   if(!enable || !PLOT_CLOCK_TIME_TYPE_SUPPORTED || !plotClock_hasInvariantTsc())
+   {
+      // Raw tick samples that are already in the curves still get converted with the old calibration.
+      g_fastClock_enabled = 0;
+      return 0;
+   }
+
+   plotThreading_mutexLock(&gt_fastClock_mutex);
+   if(!g_fastClock_calibrated)
+   {
+      fastClock_readCalibrationPoint(&g_fastClock_startTicks, &g_fastClock_startNs);
+      smartPlot_sleep(PLOT_CLOCK_CALIBRATE_MS * 1e-3f);
+      fastClock_recalibrate();
+      g_fastClock_calibrated = TRUE;
+   }
+   plotThreading_mutexUnlock(&gt_fastClock_mutex);
+
+   g_fastClock_enabled = 1;
+   return 1;
+#else
+   (void)enable;
+   return 0;
+#endif
+}
+
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+// Locks the calibration, so it holds still for a whole message, and refreshes it if it's stale.
+static void fastClock_lockCalibration()
+{
+   plotThreading_mutexLock(&gt_fastClock_mutex);
+   if((double)(plotClock_readTicks() - g_fastClock_baseTicks) * g_fastClock_nsPerTick > (double)PLOT_CLOCK_RECALIBRATE_NS)
+   {
+      fastClock_recalibrate();
+   }
+}
+
+// Must be called with the calibration locked.
+static inline PLOTTER_UINT_64 fastClock_ticksToNs(PLOTTER_UINT_64 ticks)
+{
+   // Samples from before the latest calibration point have a negative offset.
+   return g_fastClock_baseNs + (PLOTTER_INT_64)((double)(PLOTTER_INT_64)(ticks - g_fastClock_baseTicks) * g_fastClock_nsPerTick);
+}
+#endif
+
+void plotClock_convertRawTicks(char* samples, unsigned int numSamp)
+{
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+   PLOTTER_BOOL locked = FALSE;
+   unsigned int i;
+
+   for(i = 0; i < numSamp; ++i)
+   {
+      tSmartPlotTime sampTime;
+      PLOTTER_UINT_64 sampNs;
+
+      memcpy(&sampTime, samples + i*sizeof(sampTime), sizeof(sampTime)); // Message samples are not aligned.
+      if(!plotClock_isRawTicks(&sampTime))
+      {
+         continue;
+      }
+
+      if(!locked)
+      {
+         fastClock_lockCalibration();
+         locked = TRUE;
+      }
+
+      sampNs = fastClock_ticksToNs((PLOTTER_UINT_64)sampTime.tv_sec);
+      sampTime.tv_sec = sampNs / 1000000000ull;
+      sampTime.tv_nsec = sampNs % 1000000000ull;
+      memcpy(samples + i*sizeof(sampTime), &sampTime, sizeof(sampTime));
+   }
+
+   if(locked)
+   {
+      plotThreading_mutexUnlock(&gt_fastClock_mutex);
+   }
+#else
+   (void)samples;
+   (void)numSamp;
+#endif
+}
+
+void plotClock_convertRawTicksNs(PLOTTER_UINT_64* timesNs, unsigned int numSamp)
+{
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+   PLOTTER_BOOL locked = FALSE;
+   unsigned int i;
+
+   for(i = 0; i < numSamp; ++i)
+   {
+      if((timesNs[i] & PLOT_CLOCK_RAW_TICKS_NS_FLAG) == 0)
+      {
+         continue;
+      }
+
+      if(!locked)
+      {
+         fastClock_lockCalibration();
+         locked = TRUE;
+      }
+      timesNs[i] = fastClock_ticksToNs(timesNs[i] & ~PLOT_CLOCK_RAW_TICKS_NS_FLAG);
+   }
+
+   if(locked)
+   {
+      plotThreading_mutexUnlock(&gt_fastClock_mutex);
+   }
+#else
+   (void)timesNs;
+   (void)numSamp;
+#endif
+}
+
+// Define PLOTTER_COMPACT_TIME_PLOT to store the timePlot times as 8 byte E_TIME_NS_DELTA
+// samples (which are also packed smaller in the plot messages) instead of tSmartPlotTime.
+#ifdef PLOTTER_COMPACT_TIME_PLOT
+typedef PLOTTER_UINT_64 tTimePlotSample;
+#define TIME_PLOT_SAMPLE_TYPE E_TIME_NS_DELTA
+#else
+typedef tSmartPlotTime tTimePlotSample;
+#define TIME_PLOT_SAMPLE_TYPE E_TIME_STRUCT_AUTO
+#endif
+
+#define TIME_PLOT_BATCH_STACK_SIZE (256) // timePlot_2D_batchTimes converts this many times without a malloc.
+
+// Time for the timePlot samples. Raw ticks when the fast clock is enabled.
+static inline void timePlot_getTime(tTimePlotSample* pTime)
+{
+#ifdef PLOTTER_COMPACT_TIME_PLOT
+   #ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+   if(g_fastClock_enabled)
+   {
+      *pTime = plotClock_getRawTicksNs();
+      return;
+   }
+   #endif
+   *pTime = plotStats_getTimeNs();
+#else
+   #ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+   if(g_fastClock_enabled)
+   {
+      plotClock_getRawTicks(pTime);
+      return;
+   }
+   #endif
+   smartPlot_getTime(pTime);
+#endif
+}
+
 
 /**************************************************************************
 Function:     timePlot_1D
 */
 void timePlot_1D(int plotSize, int updateSize, const char* plotName, const char* curveName)
 {
-   tSmartPlotTime nowTime;
-   smartPlot_getTime(&nowTime);
-   smartPlot_1D(&nowTime, E_TIME_STRUCT_AUTO, 1, plotSize, updateSize, plotName, curveName);
+   tTimePlotSample nowTime;
+   timePlot_getTime(&nowTime);
+   smartPlot_1D(&nowTime, TIME_PLOT_SAMPLE_TYPE, 1, plotSize, updateSize, plotName, curveName);
 }
 
 /**************************************************************************
@@ -830,9 +2774,9 @@ void timePlot_2D(
    const char* plotName,
    const char* curveName)
 {
-   tSmartPlotTime nowTime;
-   smartPlot_getTime(&nowTime);
-   smartPlot_2D(&nowTime, E_TIME_STRUCT_AUTO, inDataToPlotY, inDataTypeY, 1, plotSize, updateSize, plotName, curveName);
+   tTimePlotSample nowTime;
+   timePlot_getTime(&nowTime);
+   smartPlot_2D(&nowTime, TIME_PLOT_SAMPLE_TYPE, inDataToPlotY, inDataTypeY, 1, plotSize, updateSize, plotName, curveName);
 }
 
 /**************************************************************************
@@ -845,9 +2789,125 @@ void timePlot_2D_Int(
    const char* plotName,
    const char* curveName)
 {
-   tSmartPlotTime nowTime;
-   smartPlot_getTime(&nowTime);
-   smartPlot_2D(&nowTime, E_TIME_STRUCT_AUTO, &num, E_INT_32, 1, plotSize, updateSize, plotName, curveName);
+   tTimePlotSample nowTime;
+   timePlot_getTime(&nowTime);
+   smartPlot_2D(&nowTime, TIME_PLOT_SAMPLE_TYPE, &num, E_INT_32, 1, plotSize, updateSize, plotName, curveName);
+}
+
+/**************************************************************************
+Function:     timePlot_2D_batch
+*/
+void timePlot_2D_batch(
+   const void* inDataToPlotY,
+   ePlotDataTypes inDataTypeY,
+   int inDataSize,
+   int plotSize,
+   int updateSize,
+   const char* plotName,
+   const char* curveName)
+{
+   tTimePlotSample nowTime;
+   timePlot_getTime(&nowTime);
+   smartPlot_2D_impl(&nowTime, TIME_PLOT_SAMPLE_TYPE, TRUE, inDataToPlotY, inDataTypeY, inDataSize, plotSize, updateSize, plotName, curveName);
+}
+
+/**************************************************************************
+Function:     timePlot_getTimestamp
+*/
+void timePlot_getTimestamp(tSmartPlotTime* pTime)
+{
+#ifdef PLOTTER_FAST_CLOCK_AVAILABLE
+   if(g_fastClock_enabled)
+   {
+      plotClock_getRawTicks(pTime);
+      return;
+   }
+#endif
+   smartPlot_getTime(pTime);
+}
+
+/**************************************************************************
+Function:     timePlot_2D_batchTimes
+*/
+void timePlot_2D_batchTimes(
+   const tSmartPlotTime* inTimes,
+   const void* inDataToPlotY,
+   ePlotDataTypes inDataTypeY,
+   int inDataSize,
+   int plotSize,
+   int updateSize,
+   const char* plotName,
+   const char* curveName)
+{
+#ifdef PLOTTER_COMPACT_TIME_PLOT
+   // Convert to E_TIME_NS_DELTA samples (raw ticks keep their flag until the samples are sent).
+   tTimePlotSample stackTimes[TIME_PLOT_BATCH_STACK_SIZE];
+   tTimePlotSample* times = inDataSize <= TIME_PLOT_BATCH_STACK_SIZE ? stackTimes : (tTimePlotSample*)malloc(inDataSize * sizeof(tTimePlotSample));
+   int sampIndex;
+
+   if(times == NULL || inDataSize <= 0)
+   {
+      return;
+   }
+   for(sampIndex = 0; sampIndex < inDataSize; ++sampIndex)
+   {
+      times[sampIndex] = plotClock_isRawTicks(&inTimes[sampIndex]) ?
+         (PLOTTER_UINT_64)inTimes[sampIndex].tv_sec | PLOT_CLOCK_RAW_TICKS_NS_FLAG :
+         plotStats_timeToNs(&inTimes[sampIndex]);
+   }
+   smartPlot_2D(times, TIME_PLOT_SAMPLE_TYPE, inDataToPlotY, inDataTypeY, inDataSize, plotSize, updateSize, plotName, curveName);
+   if(times != stackTimes)
+   {
+      free(times);
+   }
+#else
+   smartPlot_2D(inTimes, TIME_PLOT_SAMPLE_TYPE, inDataToPlotY, inDataTypeY, inDataSize, plotSize, updateSize, plotName, curveName);
+#endif
+}
+
+/**************************************************************************
+Function:     timePlot_getDurationCurve
+*/
+tSmartPlotCurve timePlot_getDurationCurve(int plotSize, const char* plotName, const char* curveName, int perThread)
+{
+   char threadCurveName[MAX_PLOT_CURVE_STRING_SIZE];
+
+   if(perThread)
+   {
+      if(g_timePlot_threadIndex < 0)
+      {
+         plotThreading_mutexLock(&gt_smartPlotList_mutex);
+         g_timePlot_threadIndex = g_timePlot_numThreads++;
+         plotThreading_mutexUnlock(&gt_smartPlotList_mutex);
+      }
+      // Keep the thread index even if the Curve Name has to be truncated.
+      snprintf( threadCurveName, sizeof(threadCurveName), "%.*s [T%d]",
+                (int)sizeof(threadCurveName) - 16, curveName, g_timePlot_threadIndex );
+      curveName = threadCurveName;
+   }
+
+   return smartPlot_getCurve1D(E_FLOAT_64, plotSize, plotName, curveName);
+}
+
+/**************************************************************************
+Function:     timePlot_duration
+*/
+void timePlot_duration(tSmartPlotCurve curve, const tSmartPlotTime* startTime, int updateSize)
+{
+   tSmartPlotTime endTime;
+   unsigned int writeIndex;
+   unsigned int numSamples;
+   double* buffer;
+
+   smartPlot_getTime(&endTime);
+   if(curve == NULL)
+   {
+      return;
+   }
+
+   buffer = (double*)smartPlot_curveBuffer(curve, &writeIndex, &numSamples);
+   buffer[writeIndex] = (double)(endTime.tv_sec - startTime->tv_sec) + (double)(endTime.tv_nsec - startTime->tv_nsec) * 1e-9;
+   smartPlot_curveCommit(curve, 1, updateSize);
 }
 
 
@@ -57,7 +57,9 @@ typedef enum
    E_TIME_STRUCT_64,
    E_TIME_STRUCT_128,
    E_FLOAT_16, // Add to end to keep backward compatibility.
-   E_INVALID_DATA_TYPE
+   E_INVALID_DATA_TYPE = 13, // Fixed value, so code built against older headers still passes an invalid type. New types go after it.
+   E_TIME_NS_DELTA, // Time in nanoseconds (PLOTTER_UINT_64), sent as a base time + deltas. Can't be interleaved.
+   E_DATA_TYPE_END // One past the last type. Not a valid type.
 }ePlotDataTypes;
 
 // Time struct may not always exist. Abstract it with tSmartPlotTime.
@@ -68,10 +70,117 @@ typedef struct
    long long tv_nsec;
 }tSmartPlotTime;
 #else
+#include <time.h> /* for struct timespec */
 typedef struct timespec tSmartPlotTime;
 #endif
 #define E_TIME_STRUCT_AUTO (sizeof(tSmartPlotTime) <= 8 ? E_TIME_STRUCT_64 : E_TIME_STRUCT_128) // This can be used when size of timespec is unknown.
 
+// Snapshot of the background flush thread's state. See smartPlot_getFlushStats. For a flush pool,
+// the workers' measurements are combined: a flush is one worker's flush, the bytes of the most
+// recent flush are summed over the workers and its duration is the slowest worker's.
+typedef struct
+{
+   int adaptive;                     // Non-zero if the flush period is being adjusted automatically.
+   unsigned int curPeriodMs;         // The flush period currently in use.
+   unsigned int minPeriodMs;         // Lower bound of the flush period.
+   unsigned int maxPeriodMs;         // Upper bound of the flush period.
+   unsigned long long numFlushes;    // Number of flushes performed by the background thread.
+   unsigned long long lastFlushBytes;      // Bytes sent by the most recent flush.
+   unsigned long long lastFlushDurationUs; // How long the most recent flush took.
+   double dataRateBytesPerSec;       // Smoothed rate of bytes sent by the background thread.
+   double sendLatencyUs;             // Smoothed time spent per send to the PlotGUI.
+   double sendNsPerByte;             // Smoothed send cost per byte. Rising values mean the PlotGUI is backing up.
+}tSmartPlotFlushStats;
+
+// Handle to a single 1D curve. See smartPlot_getCurve1D.
+typedef struct smartPlotListElem* tSmartPlotCurve;
+
+// Allocator hook for the curves' circular buffers. See smartPlot_setRingAllocator.
+typedef void* (*tSmartPlotRingAlloc)(size_t numBytes, void* userData);
+typedef void (*tSmartPlotRingFree)(void* mem, size_t numBytes, void* userData);
+
+// Flags for smartPlot_configureRingMemory.
+#define SMART_PLOT_RING_MEM_HUGETLB  (0x1) // mmap with MAP_HUGETLB (needs reserved huge pages, falls back to SMART_PLOT_RING_MEM_THP).
+#define SMART_PLOT_RING_MEM_THP      (0x2) // madvise the mapping for transparent huge pages.
+#define SMART_PLOT_RING_MEM_POPULATE (0x4) // Prefault the whole buffer when it is allocated.
+#define SMART_PLOT_RING_MEM_MIRROR   (0x8) // Map the buffer twice, back to back, so writes never have to wrap (Linux only).
+
+// A piece of a plot message. Sinks are handed a message as a list of these, to be sent back to back.
+typedef struct
+{
+   const char* data;
+   unsigned int size;
+}tSmartPlotSinkBuff;
+
+#define SMART_PLOT_SINK_MAX_BUFFS (8) // Max number of buffers in a single send.
+
+// Where plot messages go. See smartPlot_registerSink. A connection is an int that is
+// > 0 when valid (e.g. a socket or file descriptor). userData is passed to every call.
+typedef struct
+{
+   int (*open)(const char* address, unsigned short port, void* userData); // Returns the new connection, <= 0 on failure.
+   int (*send)(int conn, const tSmartPlotSinkBuff* buffs, unsigned int numBuffs, void* userData); // Returns bytes sent, < 0 on failure.
+   int (*flush)(int conn, void* userData); // Optional. Called when the library is done sending on the connection for now.
+   void (*close)(int conn, void* userData);
+   int (*isOpen)(int conn, void* userData); // Optional. Returns 0 if an idle connection can't be used anymore.
+   void* userData;
+}tSmartPlotSink;
+
+#define SMART_PLOT_STATS_NAME_SIZE (50)
+
+// Plot Name the library's own telemetry curves are sent under. See smartPlot_enableTelemetry.
+#define SMART_PLOT_TELEMETRY_PLOT_NAME "PlotPerfect Client"
+
+// Summary of a latency histogram. All values are in nanoseconds.
+typedef struct
+{
+   unsigned long long count;
+   unsigned long long meanNs;
+   unsigned long long p50Ns;
+   unsigned long long p90Ns;
+   unsigned long long p99Ns;
+   unsigned long long maxNs;
+}tSmartPlotLatencyStats;
+
+// Counters for a single Plot Name / Curve Name combination.
+typedef struct
+{
+   char plotName[SMART_PLOT_STATS_NAME_SIZE];
+   char curveName[SMART_PLOT_STATS_NAME_SIZE];
+   unsigned long long samplesWritten;
+   unsigned long long samplesOverwritten; // Samples that were overwritten before they were sent.
+   unsigned long long samplesUnsent;      // Samples currently waiting to be sent.
+   unsigned long long msgsGenerated;
+   unsigned long long bytesGenerated;
+}tSmartPlotCurveStats;
+
+// Counters for a single PlotGUI host / port.
+typedef struct
+{
+   char hostName[SMART_PLOT_STATS_NAME_SIZE];
+   unsigned short port;
+   unsigned long long msgsSent;
+   unsigned long long bytesSent;
+   unsigned long long sendErrors;
+   unsigned long long connects;
+   unsigned long long connectFailures;
+   unsigned long long connsReused; // Sends that used an idle connection from the pool instead of connecting.
+   tSmartPlotLatencyStats sendLatency;
+   tSmartPlotLatencyStats connectLatency;
+}tSmartPlotEndpointStats;
+
+// Process wide stats. See smartPlot_getStats.
+typedef struct
+{
+   unsigned int numCurves;    // Total number of curves (can be more than were copied out).
+   unsigned int numEndpoints; // Total number of PlotGUI endpoints (can be more than were copied out).
+   tSmartPlotLatencyStats encodeLatency; // Time to pack plot messages.
+   tSmartPlotFlushStats flush;
+   unsigned long long memBytes;       // Circular buffer memory smartPlot has allocated for the curves.
+   unsigned long long memBudgetBytes; // See smartPlot_setMemoryBudget. 0 means unlimited.
+   unsigned long long curvesEvicted;  // Curves evicted to stay within the memory budget.
+}tSmartPlotStats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -82,7 +191,10 @@ Function:     smartPlot_networkConfigure
 Description:  This function configures network parameters. If you are planning on
               using non-default values, call this function prior to plotting data.
 
-Arguments:    hostName - Host name or IP address of the PlotGUI server.
+Arguments:    hostName - Host name or IP address of the PlotGUI server. Can start
+              with a scheme that picks the sink the messages go to (see
+              smartPlot_registerSink), e.g. "file:///tmp/plot.bin" or "null://".
+              No scheme is the same as "tcp://".
 
               port - TCP port of the PlotGUI server.
 
@@ -90,6 +202,77 @@ Returns:      None.
 */
 void smartPlot_networkConfigure(const char *hostName, const unsigned short port);
 
+/**************************************************************************
+Function:     smartPlot_registerSink
+
+Description:  Adds a sink (or replaces one), so plot messages can go somewhere
+              other than a PlotGUI over TCP (e.g. shared memory or a consumer
+              in this process). The sink is used by every host name that
+              starts with "<scheme>://". These sinks are built in:
+                 tcp://<host>  - The PlotGUI at <host>:<port> (the default).
+                 file://<path> - Appends the messages to a file.
+                 null://       - Throws the messages away.
+              Register sinks before sending to them. The sink used for a host
+              name is fixed the first time a message is sent to it. Stats are
+              kept for every host name, whatever its sink (see smartPlot_getStats).
+
+Arguments:    scheme - e.g. "shm". Up to 15 characters.
+
+              sink - The sink's functions. Copied. open, send and close are
+              required.
+
+Returns:      0 on success, -1 if the sink is invalid or too many have been added.
+*/
+int smartPlot_registerSink(const char* scheme, const tSmartPlotSink* sink);
+
+/**************************************************************************
+Function:     smartPlot_addDestination
+
+Description:  Sends a copy of every plot message to another PlotGUI (or sink)
+              as well as the one set with smartPlot_networkConfigure, e.g. a
+              local PlotGUI and a remote recorder. Messages are encoded once,
+              each extra destination only costs the send.
+
+Arguments:    hostName - Host name of the extra destination. Can start with a
+              sink scheme (see smartPlot_registerSink).
+
+              port - TCP port of the extra destination.
+
+Returns:      0 on success, -1 if there are already too many destinations.
+*/
+int smartPlot_addDestination(const char* hostName, unsigned short port);
+
+/**************************************************************************
+Function:     smartPlot_removeDestination
+
+Description:  Stops sending copies to a destination from smartPlot_addDestination.
+              A message that is being sent while this is called might still
+              go to it. Each curve closes its connection to the destination
+              the next time it sends a message.
+
+Arguments:    hostName, port - Same as passed to smartPlot_addDestination.
+
+Returns:      0 on success, -1 if it isn't a destination.
+*/
+int smartPlot_removeDestination(const char* hostName, unsigned short port);
+
+/**************************************************************************
+Function:     smartPlot_addCurveDestination
+
+Description:  Same as smartPlot_addDestination, but only for one curve. The
+              curve has to exist already. For interleaved curves, either
+              curve name adds the destination for both.
+
+Arguments:    plotName, curveName - The curve.
+
+              hostName, port - The extra destination.
+
+Returns:      0 on success, -1 if the curve doesn't exist or it already has
+              too many destinations.
+*/
+int smartPlot_addCurveDestination(const char* plotName, const char* curveName, const char* hostName, unsigned short port);
+int smartPlot_removeCurveDestination(const char* plotName, const char* curveName, const char* hostName, unsigned short port);
+
 /**************************************************************************
 Function:     smartPlot_forceBackgroundThread
 
@@ -123,8 +306,9 @@ Arguments:    inDataToPlot - Pointer to the samples to plot. If there are no
               to plot.
 
               plotSize - The number of data points in the entire GUI plot.
-              This value is only used the first time a new Plot Name /
-              Curve Name combination is passed in.
+              Passing in a different size for an existing Plot Name /
+              Curve Name combination resizes it. The newest samples (and
+              the ones that haven't been sent yet) are kept.
 
               updateSize - The number of samples to send in each plot message to
               the plot GUI. Setting this value to 0 will flush the buffer (i.e
@@ -167,8 +351,9 @@ Arguments:    inDataToPlot - Pointer to the samples to plot. If there are no
               to plot.
 
               plotSize - The number of data points in the entire GUI plot.
-              This value is only used the first time a new Plot Name /
-              Curve Name combination is passed in.
+              Passing in a different size for an existing Plot Name /
+              Curve Name combination resizes it. The newest samples (and
+              the ones that haven't been sent yet) are kept.
 
               updateSize - The number of samples to send in each plot message to
               the plot GUI. Setting this value to 0 will flush the buffer (i.e
@@ -207,6 +392,170 @@ void smartPlot_2D( const void* inDataToPlotX,
                    const char* plotName,
                    const char* curveName );
 
+/**************************************************************************
+Function:     smartPlot_1D_borrowed
+
+Description:  Plots a caller owned array without copying it. Unlike
+              smartPlot_1D, the samples are not copied into a circular
+              buffer, the plot message is sent straight from inDataToPlot
+              (scatter / gather I/O). Useful for large one shot arrays, like a
+              capture buffer.
+
+              This call is synchronous: it doesn't return until the samples
+              have been handed to the socket, so inDataToPlot can be reused or
+              freed as soon as it returns. The message is always sent right
+              away from the calling thread, even between smartPlot_groupMsgStart
+              and smartPlot_groupMsgEnd.
+
+              The whole GUI plot is replaced with the samples. Don't plot to
+              the same Plot Name / Curve Name with smartPlot_1D.
+
+Arguments:    inDataToPlot - Pointer to the samples to plot.
+
+              inDataType - Data type of the samples.
+
+              inDataSize - Number of samples in inDataToPlot. This is also the
+              size of the GUI plot.
+
+              plotName - The Plot Name.
+
+              curveName - The Curve Name.
+
+Returns:      0 if the samples were sent, -1 otherwise.
+*/
+int smartPlot_1D_borrowed( const void* inDataToPlot,
+                           ePlotDataTypes inDataType,
+                           int inDataSize,
+                           const char* plotName,
+                           const char* curveName );
+
+/**************************************************************************
+Function:     smartPlot_2D_borrowed
+
+Description:  Same as smartPlot_1D_borrowed, but takes separate X and Y axis
+              samples and generates a 2D plot.
+*/
+int smartPlot_2D_borrowed( const void* inDataToPlotX,
+                           ePlotDataTypes inDataTypeX,
+                           const void* inDataToPlotY,
+                           ePlotDataTypes inDataTypeY,
+                           int inDataSize,
+                           const char* plotName,
+                           const char* curveName );
+
+/**************************************************************************
+Function:     smartPlot_getCurve1D
+
+Description:  Gets a handle to a 1D curve (creating it if needed) so samples
+              can be written directly into the curve's circular buffer with
+              smartPlot_curveBuffer / smartPlot_curveCommit. This is what the
+              typed C++ API in smartPlotTyped.h is built on.
+
+              The handle is valid until the curve is deallocated. Once a
+              handle has been given out the circular buffer is never resized
+              (the handle's owner may be writing to it): smartPlot_1D and
+              smartPlot_getCurve1D calls with a different plotSize keep the
+              existing size.
+
+Arguments:    dataType - Data type of the samples. Unlike smartPlot_1D, this
+              must match the type the curve was created with.
+
+              plotSize - The number of data points in the entire GUI plot.
+              Ignored if the curve already exists.
+
+              plotName - The Plot Name.
+
+              curveName - The Curve Name.
+
+Returns:      The curve handle. NULL if the parameters are invalid, the
+              memory could not be allocated, or the curve already exists with
+              a different data type, is not a 1D curve or is an external
+              buffer (see smartPlot_registerExternal1D).
+*/
+tSmartPlotCurve smartPlot_getCurve1D( ePlotDataTypes dataType,
+                                      int plotSize,
+                                      const char* plotName,
+                                      const char* curveName );
+
+/**************************************************************************
+Function:     smartPlot_registerExternal1D
+
+Description:  Registers a circular buffer that the caller already maintains
+              as a 1D curve. smartPlot never copies into, resizes or frees the
+              buffer. The flush thread (or smartPlot_flush_1D / smartPlot_1D
+              with the same names) reads the caller's write index and sends
+              the new samples straight from the buffer, so writing samples
+              doesn't need any smartPlot calls. smartPlot_2D / smartPlot_interleaved
+              calls with the curve's names are ignored.
+
+              The caller writes samples at the write index (wrapping back to 0
+              at ringSize) and then stores the new write index with release
+              semantics (e.g. __atomic_store_n(..., __ATOMIC_RELEASE) or
+              std::atomic<unsigned int>::store). The buffer must be flushed
+              at least once per lap, and must stay valid until the curve is
+              deallocated with smartPlot_deallocate.
+
+Arguments:    ringBuffer - The circular buffer.
+
+              dataType - Data type of the samples in the buffer.
+
+              ringSize - Number of samples in the buffer. This is also the size
+              of the GUI plot.
+
+              writeIndex - Index of where the caller will write the next
+              sample. Only samples written after registering are plotted.
+
+              plotName - The Plot Name.
+
+              curveName - The Curve Name.
+
+Returns:      The curve handle. NULL if the parameters are invalid or the
+              Plot Name / Curve Name combination already exists.
+*/
+tSmartPlotCurve smartPlot_registerExternal1D( const void* ringBuffer,
+                                              ePlotDataTypes dataType,
+                                              int ringSize,
+                                              const volatile unsigned int* writeIndex,
+                                              const char* plotName,
+                                              const char* curveName );
+
+/**************************************************************************
+Function:     smartPlot_curveBuffer
+
+Description:  Gets the curve's circular buffer. New samples are written
+              starting at writeIndex, wrapping back to 0 at numSamples.
+              Call smartPlot_curveCommit once the samples have been written.
+              If the buffer is mirrored (see smartPlot_configureRingMemory),
+              up to numSamples samples can be written from writeIndex
+              without wrapping.
+
+Arguments:    curve - Handle from smartPlot_getCurve1D.
+
+              writeIndex (Out) - Index of where the next sample goes.
+
+              numSamples (Out) - Number of samples in the circular buffer.
+
+Returns:      Pointer to the start of the circular buffer.
+*/
+void* smartPlot_curveBuffer(tSmartPlotCurve curve, unsigned int* writeIndex, unsigned int* numSamples);
+
+/**************************************************************************
+Function:     smartPlot_curveCommit
+
+Description:  Makes samples written to the circular buffer available to be
+              plotted and sends a plot message if one is due (same rules as
+              smartPlot_1D).
+
+Arguments:    curve - Handle from smartPlot_getCurve1D.
+
+              numSampWritten - Number of samples written at the write index.
+
+              updateSize - See smartPlot_1D.
+
+Returns:      None.
+*/
+void smartPlot_curveCommit(tSmartPlotCurve curve, int numSampWritten, int updateSize);
+
 /**************************************************************************
 Function:     smartPlot_groupMsgStart
 
@@ -220,6 +569,11 @@ Description:  This function is used to group a bunch of separate plot
               smartPlot_groupMsgEnd is called, at which point all the
               separate plot messages will be sent as one big message.
 
+              Grouping is per thread. Only plot messages generated on the
+              calling thread are grouped, other threads keep sending as
+              normal. Calls can be nested, the group is sent when the
+              outermost smartPlot_groupMsgEnd is called.
+
 */
 void smartPlot_groupMsgStart();
 
@@ -335,6 +689,92 @@ void smartPlot_deallocate_interleaved( const char* plotName,
                                        const char* curveName_x,
                                        const char* curveName_y);
 
+/**************************************************************************
+Function:     smartPlot_setMemoryBudget
+
+Description:  Caps the memory used for the curves' circular buffers, so a
+              process that plots curves with dynamic names doesn't grow
+              without bound. When a curve needs memory that would go over the
+              budget, the least recently written curves are flushed and
+              evicted (as if smartPlot_deallocate was called) until it fits.
+              If it still doesn't fit, the curve isn't created / resized and
+              the samples are dropped.
+
+              Curves with a handle (smartPlot_getCurve1D, timePlot duration
+              curves) are never evicted, but count against the budget.
+              Registered external buffers don't count against the budget.
+              Curves that another thread is in the middle of writing are not
+              evicted.
+
+Arguments:    maxBytes - Max bytes of circular buffer memory. 0 for no limit
+              (the default).
+
+              minIdleMs - Only curves that haven't been written for at least
+              this long are evicted. In milliseconds.
+
+Returns:      None.
+*/
+void smartPlot_setMemoryBudget(unsigned long long maxBytes, unsigned int minIdleMs);
+
+
+/**************************************************************************
+Function:     smartPlot_configureRingMemory
+
+Description:  Has the circular buffers of very large curves mmap'd instead of
+              malloc'd, so they can be backed by huge pages (fewer TLB misses
+              each lap through the buffer) and prefaulted (no page fault storm
+              on the first lap). Only affects buffers that are allocated after
+              this is called. mmap isn't used on Windows.
+
+Arguments:    mmapThresholdBytes - Buffers of at least this many bytes are
+              mmap'd. 0 to always malloc (the default).
+
+              flags - SMART_PLOT_RING_MEM_* flags. With
+              SMART_PLOT_RING_MEM_MIRROR, buffers whose size is a multiple of
+              the page size (e.g. 1024 4 byte samples) are backed by a memfd
+              that is mapped twice, so a write that runs off the end of the buffer lands at
+              the start of it. Mirrored buffers don't use huge pages.
+
+Returns:      None.
+*/
+void smartPlot_configureRingMemory(size_t mmapThresholdBytes, int flags);
+
+/**************************************************************************
+Function:     smartPlot_setRingAllocator
+
+Description:  Replaces the allocator used for the curves' circular buffers
+              (e.g. with a pool or NUMA aware allocator). Only affects buffers
+              that are allocated after this is called. Buffers are always
+              freed by whatever allocated them.
+
+Arguments:    allocFunc - Returns numBytes of memory, or NULL on failure.
+              Pass in NULL to go back to the built in allocator.
+
+              freeFunc - Frees memory from allocFunc. numBytes is the size
+              that was passed to allocFunc.
+
+              userData - Passed to allocFunc / freeFunc.
+
+Returns:      None.
+*/
+void smartPlot_setRingAllocator(tSmartPlotRingAlloc allocFunc, tSmartPlotRingFree freeFunc, void* userData);
+
+/**************************************************************************
+Function:     smartPlot_enablePow2Capacity
+
+Description:  Rounds the plot size of curves that are created (or resized)
+              after this is called up to a power of two, e.g. a plot size of
+              1000 becomes 1024. The write index of a power of two sized
+              curve wraps with a mask, so writing samples is at most 2
+              memcpys, with no division or compare per chunk. Curves that
+              happen to be a power of two in size get this either way.
+
+Arguments:    enable - Non-zero to round plot sizes up, 0 to use the plot
+              size as is (the default).
+
+Returns:      None.
+*/
+void smartPlot_enablePow2Capacity(int enable);
 
 /**************************************************************************
 Function:     smartPlot_createFlushThread
@@ -377,6 +817,127 @@ Returns:      None.
 */
 void smartPlot_createFlushThread_withPriorityPolicy(unsigned int sleepBetweenFlush_ms, int priority, int policy);
 
+/**************************************************************************
+Function:     smartPlot_createFlushThread_adaptive
+
+Description:  See smartPlot_createFlushThread description. Rather than using a
+              fixed flush period, the background thread adjusts its period
+              between the bounds passed in. When a lot of data is being sent
+              and the time to send it is rising, the period is lengthened so
+              more samples are packed into each (more efficient) group message.
+              When traffic is light, the period is shortened to keep latency low.
+
+Arguments:    minSleepBetweenFlush_ms - Shortest allowed flush period. In milliseconds.
+              Values below 1 are treated as 1.
+
+              maxSleepBetweenFlush_ms - Longest allowed flush period. In milliseconds.
+
+Returns:      None.
+*/
+void smartPlot_createFlushThread_adaptive(unsigned int minSleepBetweenFlush_ms, unsigned int maxSleepBetweenFlush_ms);
+
+/**************************************************************************
+Function:     smartPlot_createFlushPool
+
+Description:  See smartPlot_createFlushThread description. Rather than a single
+              background thread flushing every curve, this creates several
+              threads that each flush a subset of the curves. Each worker packs
+              its own group messages and has its own connections to the PlotGUI,
+              so the flush work is spread across multiple cores.
+
+Arguments:    numWorkers - Number of background threads to create.
+
+              sleepBetweenFlush_ms - How often each thread wakes up and sends
+              its curves' plot data to the PlotGUI. In milliseconds.
+
+              shardByEndpoint - If zero, curves are assigned to threads by
+              a hash of the plot / curve name. If non-zero, curves are
+              assigned by a hash of the PlotGUI host / port they are sent to,
+              so all the curves for one PlotGUI are sent in the same message.
+
+Returns:      None.
+*/
+void smartPlot_createFlushPool(unsigned int numWorkers, unsigned int sleepBetweenFlush_ms, int shardByEndpoint);
+
+/**************************************************************************
+Function:     smartPlot_getFlushStats
+
+Description:  Fills in the current state of the background flush thread, including
+              the flush period that is in use and the measurements used to choose it.
+
+Arguments:    stats (Out) - Pointer to the struct that will be filled in.
+
+Returns:      None.
+*/
+void smartPlot_getFlushStats(tSmartPlotFlushStats* stats);
+
+/**************************************************************************
+Function:     smartPlot_getStats
+
+Description:  Gets the library's stats: per curve sample / message / byte
+              counts, per PlotGUI send counts and latencies, and how long
+              it takes to pack plot messages.
+
+              The counters are always being updated (with very low overhead).
+              Define PLOTTER_NO_STATS when building the library to remove them.
+
+Arguments:    stats (Out) - Process wide stats.
+
+              curves (Out) - Array to fill in with per curve stats. Can be NULL.
+
+              maxCurves - Number of elements in the curves array.
+
+              endpoints (Out) - Array to fill in with per PlotGUI stats. Can be NULL.
+
+              maxEndpoints - Number of elements in the endpoints array.
+
+Returns:      None. stats->numCurves / stats->numEndpoints are the total counts,
+              which can be used to size the arrays for the next call.
+*/
+void smartPlot_getStats( tSmartPlotStats* stats,
+                         tSmartPlotCurveStats* curves,
+                         unsigned int maxCurves,
+                         tSmartPlotEndpointStats* endpoints,
+                         unsigned int maxEndpoints );
+
+/**************************************************************************
+Function:     smartPlot_dumpStats
+
+Description:  Writes the library's stats to a text file. Curves are listed
+              from most to least bytes generated, so the hot curves are at
+              the top.
+
+Arguments:    fileName - Path of the file to write.
+
+Returns:      0 on success, -1 if the file could not be written.
+*/
+int smartPlot_dumpStats(const char* fileName);
+
+/**************************************************************************
+Function:     smartPlot_enableTelemetry
+
+Description:  Has the background flush thread plot the library's own health
+              metrics, so the overhead of plotting can be watched live next to
+              the application's data. The metrics are sent as ordinary 1D curves
+              under the SMART_PLOT_TELEMETRY_PLOT_NAME Plot Name:
+                 Queue Depth - Samples waiting to be sent (all curves).
+                 Dropped Samples - Samples overwritten before being sent, since the last publish.
+                 Flush Duration (us) / Flush Bytes / Flush Period (ms) - From the most recent flush.
+                    For a flush pool, combined over the workers (see tSmartPlotFlushStats).
+                 <host>:<port> Bytes/Sec - Send rate to each PlotGUI.
+                 <host>:<port> Reconnects - Reconnects / failed connects to each PlotGUI.
+
+              Only has an effect once a flush thread (or flush pool) has been created.
+
+Arguments:    publishPeriod_ms - How often to publish the metrics. In milliseconds.
+              Pass in 0 to stop publishing.
+
+              plotSize - Number of samples of each metric to keep in the plot.
+
+Returns:      None.
+*/
+void smartPlot_enableTelemetry(unsigned int publishPeriod_ms, int plotSize);
+
 /**************************************************************************
 Function:     smartPlot_getTime
 
@@ -389,6 +950,24 @@ Returns:      None.
 */
 void smartPlot_getTime(tSmartPlotTime* pTime);
 
+/**************************************************************************
+Function:     smartPlot_enableFastClock
+
+Description:  Makes the timePlot functions read the CPU's invariant Time Stamp
+              Counter instead of the Monotonic clock. The raw counter values are
+              stored in the curve and converted to Monotonic time when the curve
+              is flushed, using a calibration against the Monotonic clock that is
+              refreshed about once a second. smartPlot_getTime is not affected.
+              Enabling the fast clock blocks for ~10 ms for the first calibration.
+
+Arguments:    enable - Non-zero to use the fast clock, 0 to go back to the
+              Monotonic clock.
+
+Returns:      Non-zero if the fast clock is now in use. The fast clock is only
+              available on x86-64 CPUs with an invariant Time Stamp Counter.
+*/
+int smartPlot_enableFastClock(int enable);
+
 /**************************************************************************
 Function:     smartPlot_sleep
 
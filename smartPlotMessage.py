@@ -23,7 +23,14 @@ E_FLOAT_64          = 9
 E_TIME_STRUCT_64    = 10
 E_TIME_STRUCT_128   = 11
 E_FLOAT_16          = 12
-E_INVALID_DATA_TYPE = 13
+E_INVALID_DATA_TYPE = 13 # Fixed value, new types go after it.
+E_TIME_NS_DELTA     = 14
+
+# Flags for configureRingMemory
+SMART_PLOT_RING_MEM_HUGETLB  = 0x1
+SMART_PLOT_RING_MEM_THP      = 0x2
+SMART_PLOT_RING_MEM_POPULATE = 0x4
+SMART_PLOT_RING_MEM_MIRROR   = 0x8
 
 ################################################################################
 plotLib = None
@@ -89,6 +96,20 @@ def networkConfigure(hostName: str, port: int):
 
 ################################################################################
 
+def addDestination(hostName: str, port: int):
+   global plotLib
+   _plotterInit()
+   return plotLib.smartPlot_addDestination(_strToBytes(hostName), port)
+
+################################################################################
+
+def removeDestination(hostName: str, port: int):
+   global plotLib
+   _plotterInit()
+   return plotLib.smartPlot_removeDestination(_strToBytes(hostName), port)
+
+################################################################################
+
 def forceBackgroundThread():
    global plotLib
    _plotterInit()
@@ -270,6 +291,27 @@ def deallocate_interleaved(
 
 ################################################################################
 
+def setMemoryBudget(maxBytes: int, minIdleMs: int = 0):
+   global plotLib
+   _plotterInit()
+   plotLib.smartPlot_setMemoryBudget(ctypes.c_ulonglong(maxBytes), minIdleMs)
+
+################################################################################
+
+def configureRingMemory(mmapThresholdBytes: int, flags: int):
+   global plotLib
+   _plotterInit()
+   plotLib.smartPlot_configureRingMemory(ctypes.c_size_t(mmapThresholdBytes), flags)
+
+################################################################################
+
+def enablePow2Capacity(enable: bool):
+   global plotLib
+   _plotterInit()
+   plotLib.smartPlot_enablePow2Capacity(1 if enable else 0)
+
+################################################################################
+
 def createFlushThread(sleepBetweenFlush_ms: int):
    global plotLib
    _plotterInit()
@@ -385,3 +427,25 @@ def timePlot_2D_Int(
       _strToBytes(curveName)
    )
 
+################################################################################
+
+def timePlot_2D_batch(
+         inDataToPlotY: bytes,
+         inDataTypeY: int,
+         inDataSize: int,
+         plotSize: int,
+         updateSize: int,
+         plotName: str,
+         curveName: str):
+   global plotLib
+   _plotterInit()
+   plotLib.timePlot_2D_batch(
+      bytes(inDataToPlotY),
+      int(inDataTypeY),
+      int(inDataSize),
+      int(plotSize),
+      int(updateSize),
+      _strToBytes(plotName),
+      _strToBytes(curveName)
+   )
+
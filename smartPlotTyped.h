@@ -0,0 +1,194 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef smartPlotTyped_h
+#define smartPlotTyped_h
+
+// Typed C++ (C++11) API on top of smartPlotMessage.h. The ePlotDataTypes value is
+// deduced from the sample type at compile time (plotting an unsupported type is a
+// compile error), and 1D samples are copied into the circular buffer by code that is
+// instantiated for the sample type, so there are no runtime size lookups.
+//
+// Example:
+//    smartPlot::Curve1D<float> curve(1000, 100, "Plot", "Curve");
+//    curve.write(samples, numSamples);
+//
+//    smartPlot::plot1D(samples, numSamples, 1000, 100, "Plot", "Curve");
+
+#include <time.h>
+#include <type_traits>
+#include "smartPlotMessage.h"
+
+namespace smartPlot
+{
+
+//*****************************************************************************
+// Sample Type -> ePlotDataTypes
+//*****************************************************************************
+template<unsigned int size, bool isSigned> struct IntDataType;
+template<> struct IntDataType<1, true>  { static const ePlotDataTypes value = E_INT_8; };
+template<> struct IntDataType<1, false> { static const ePlotDataTypes value = E_UINT_8; };
+template<> struct IntDataType<2, true>  { static const ePlotDataTypes value = E_INT_16; };
+template<> struct IntDataType<2, false> { static const ePlotDataTypes value = E_UINT_16; };
+template<> struct IntDataType<4, true>  { static const ePlotDataTypes value = E_INT_32; };
+template<> struct IntDataType<4, false> { static const ePlotDataTypes value = E_UINT_32; };
+template<> struct IntDataType<8, true>  { static const ePlotDataTypes value = E_INT_64; };
+template<> struct IntDataType<8, false> { static const ePlotDataTypes value = E_UINT_64; };
+
+// No definition for types that can't be plotted.
+template<typename T, bool isInt = std::is_integral<T>::value && !std::is_same<T, bool>::value>
+struct PlotDataType;
+
+template<typename T> struct PlotDataType<T, true>
+{
+   static const ePlotDataTypes value = IntDataType<sizeof(T), std::is_signed<T>::value>::value;
+};
+template<> struct PlotDataType<float, false>
+{
+   static_assert(sizeof(float) == 4, "E_FLOAT_32 must be 4 bytes");
+   static const ePlotDataTypes value = E_FLOAT_32;
+};
+template<> struct PlotDataType<double, false>
+{
+   static_assert(sizeof(double) == 8, "E_FLOAT_64 must be 8 bytes");
+   static const ePlotDataTypes value = E_FLOAT_64;
+};
+template<> struct PlotDataType<tSmartPlotTime, false>
+{
+   static const ePlotDataTypes value = sizeof(tSmartPlotTime) <= 8 ? E_TIME_STRUCT_64 : E_TIME_STRUCT_128;
+};
+
+//*****************************************************************************
+// 1D Curve
+//*****************************************************************************
+// Holds on to the curve handle, so writes skip the Plot Name / Curve Name lookup.
+// The curve must not be deallocated while the Curve1D is in use.
+template<typename T>
+class Curve1D
+{
+public:
+   Curve1D(int plotSize, int updateSize, const char* plotName, const char* curveName) :
+      m_curve(smartPlot_getCurve1D(PlotDataType<T>::value, plotSize, plotName, curveName)),
+      m_updateSize(updateSize)
+   {
+   }
+
+   // False if the curve could not be created or already exists with a different type.
+   bool valid() const
+   {
+      return m_curve != NULL;
+   }
+
+   void write(const T* samples, int numSamp)
+   {
+      unsigned int writeIndex;
+      unsigned int bufferSize;
+      unsigned int numToCopy = numSamp > 0 ? (unsigned int)numSamp : 0;
+      unsigned int numToEnd;
+      T* buffer;
+
+      if(m_curve == NULL)
+      {
+         return;
+      }
+
+      buffer = static_cast<T*>(smartPlot_curveBuffer(m_curve, &writeIndex, &bufferSize));
+      if(numToCopy > bufferSize)
+      {
+         // Only the newest bufferSize samples would survive, don't bother copying the rest.
+         writeIndex = (writeIndex + (numToCopy - bufferSize)) % bufferSize;
+         samples += numToCopy - bufferSize;
+         numToCopy = bufferSize;
+      }
+
+      numToEnd = bufferSize - writeIndex;
+      if(numToCopy <= numToEnd)
+      {
+         copySamples(buffer + writeIndex, samples, numToCopy);
+      }
+      else
+      {
+         copySamples(buffer + writeIndex, samples, numToEnd);
+         copySamples(buffer, samples + numToEnd, numToCopy - numToEnd);
+      }
+
+      smartPlot_curveCommit(m_curve, numSamp, m_updateSize);
+   }
+
+   void write(const T& sample)
+   {
+      write(&sample, 1);
+   }
+
+private:
+   static void copySamples(T* dst, const T* src, unsigned int numSamp)
+   {
+      for(unsigned int i = 0; i < numSamp; ++i)
+      {
+         dst[i] = src[i];
+      }
+   }
+
+   tSmartPlotCurve m_curve;
+   int m_updateSize;
+};
+
+//*****************************************************************************
+// Functions
+//*****************************************************************************
+// Same as smartPlot_1D, with the data type deduced from the samples.
+template<typename T>
+inline void plot1D(const T* samples, int numSamp, int plotSize, int updateSize, const char* plotName, const char* curveName)
+{
+   Curve1D<T>(plotSize, updateSize, plotName, curveName).write(samples, numSamp);
+}
+
+// Same as smartPlot_1D_borrowed, with the data type deduced from the samples.
+template<typename T>
+inline int plot1DBorrowed(const T* samples, int numSamp, const char* plotName, const char* curveName)
+{
+   return smartPlot_1D_borrowed(samples, PlotDataType<T>::value, numSamp, plotName, curveName);
+}
+
+// Same as smartPlot_2D, with the data types deduced from the samples.
+template<typename TX, typename TY>
+inline void plot2D(const TX* xSamples, const TY* ySamples, int numSamp, int plotSize, int updateSize, const char* plotName, const char* curveName)
+{
+   smartPlot_2D( xSamples, PlotDataType<TX>::value, ySamples, PlotDataType<TY>::value,
+                 numSamp, plotSize, updateSize, plotName, curveName );
+}
+
+// Same as smartPlot_2D_borrowed, with the data types deduced from the samples.
+template<typename TX, typename TY>
+inline int plot2DBorrowed(const TX* xSamples, const TY* ySamples, int numSamp, const char* plotName, const char* curveName)
+{
+   return smartPlot_2D_borrowed( xSamples, PlotDataType<TX>::value, ySamples, PlotDataType<TY>::value,
+                                 numSamp, plotName, curveName );
+}
+
+// Same as smartPlot_interleaved, with the data type deduced from the samples.
+// xySamples holds numPairs X / Y pairs.
+template<typename T>
+inline void plotInterleaved(const T* xySamples, int numPairs, int plotSize, int updateSize, const char* plotName, const char* curveName_x, const char* curveName_y)
+{
+   smartPlot_interleaved(xySamples, PlotDataType<T>::value, numPairs, plotSize, updateSize, plotName, curveName_x, curveName_y);
+}
+
+}
+
+#endif
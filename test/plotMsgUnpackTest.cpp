@@ -0,0 +1,393 @@
+/* Copyright 2026 Dan Williams. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons
+ * to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// plotMsgUnpackTest - Feeds good and malformed messages to the plotMsgUnpack.h decoder and
+// checks the ePlotUnpackResult of each. Also round trips packed E_TIME_NS_DELTA samples.
+// Returns non-zero if any check fails.
+
+#include <stdio.h>
+#include <string.h>
+#include "plotMsgUnpack.h"
+
+#define TEST_BUFF_SIZE (4096)
+
+static int g_numChecks = 0;
+static int g_numFailures = 0;
+
+#define CHECK(cond) checkResult((cond), #cond, __LINE__)
+
+static void checkResult(int passed, const char* condStr, int line)
+{
+   g_numChecks++;
+   if(!passed)
+   {
+      g_numFailures++;
+      printf("FAILED line %d: %s\n", line, condStr);
+   }
+}
+
+//*****************************************************************************
+// Message Building
+//*****************************************************************************
+// Builds any Create / Update message, including ones the pack functions can't build
+// (packed samples, bad types, etc). Returns the message size.
+static unsigned int buildPlotMsg(char* buff, ePlotAction action, PLOTTER_UINT_32 numSamp, ePlotDataTypes xAxisType, ePlotDataTypes yAxisType, char interleaved, const void* samples, unsigned int samplesSize)
+{
+   const char* plotName = "plot";
+   const char* curveName = "curve";
+   PLOTTER_UINT_32 startIndex = 5;
+   PLOT_MSG_SIZE_TYPE msgSize = 0;
+   unsigned int idx = 0;
+   int is2D = action == E_CREATE_2D_PLOT || action == E_UPDATE_2D_PLOT;
+   int isUpdate = action == E_UPDATE_1D_PLOT || action == E_UPDATE_2D_PLOT;
+
+   packPlotMsgParam(buff, &idx, &action, sizeof(action));
+   packPlotMsgParam(buff, &idx, &msgSize, sizeof(msgSize)); // Filled in below.
+   packPlotMsgParam(buff, &idx, plotName, (unsigned int)strlen(plotName)+1);
+   packPlotMsgParam(buff, &idx, curveName, (unsigned int)strlen(curveName)+1);
+   packPlotMsgParam(buff, &idx, &numSamp, sizeof(numSamp));
+   if(isUpdate)
+   {
+      packPlotMsgParam(buff, &idx, &startIndex, sizeof(startIndex));
+   }
+   if(is2D)
+   {
+      packPlotMsgParam(buff, &idx, &xAxisType, sizeof(xAxisType));
+   }
+   packPlotMsgParam(buff, &idx, &yAxisType, sizeof(yAxisType));
+   if(is2D)
+   {
+      packPlotMsgParam(buff, &idx, &interleaved, sizeof(interleaved));
+   }
+   if(samplesSize > 0)
+   {
+      packPlotMsgParam(buff, &idx, samples, samplesSize);
+   }
+
+   msgSize = idx;
+   memcpy(buff + sizeof(action), &msgSize, sizeof(msgSize));
+   return idx;
+}
+
+static unsigned int buildPlotMsgHeader(char* buff, ePlotAction action, PLOT_MSG_SIZE_TYPE msgSize)
+{
+   unsigned int idx = 0;
+   packPlotMsgParam(buff, &idx, &action, sizeof(action));
+   packPlotMsgParam(buff, &idx, &msgSize, sizeof(msgSize));
+   return idx;
+}
+
+static void setPlotMsgSize(char* buff, PLOT_MSG_SIZE_TYPE msgSize)
+{
+   memcpy(buff + sizeof(PLOTTER_UINT_32), &msgSize, sizeof(msgSize));
+}
+
+//*****************************************************************************
+// Tests
+//*****************************************************************************
+static void testHeader()
+{
+   char buff[TEST_BUFF_SIZE];
+   ePlotAction action;
+   PLOT_MSG_SIZE_TYPE msgSize;
+
+   buildPlotMsgHeader(buff, E_CREATE_1D_PLOT, 100);
+   CHECK(unpackPlotMsgHeader(buff, PLOT_MSG_HEADER_SIZE, &action, &msgSize) == E_UNPACK_OK);
+   CHECK(action == E_CREATE_1D_PLOT && msgSize == 100);
+
+   // Truncated headers.
+   CHECK(unpackPlotMsgHeader(buff, 0, &action, &msgSize) == E_UNPACK_INCOMPLETE);
+   CHECK(unpackPlotMsgHeader(buff, PLOT_MSG_HEADER_SIZE - 1, &action, &msgSize) == E_UNPACK_INCOMPLETE);
+
+   buildPlotMsgHeader(buff, E_INVALID_PLOT_ACTION, 100);
+   CHECK(unpackPlotMsgHeader(buff, PLOT_MSG_HEADER_SIZE, &action, &msgSize) == E_UNPACK_BAD_ACTION);
+
+   // Message size smaller than the header.
+   buildPlotMsgHeader(buff, E_UPDATE_2D_PLOT, PLOT_MSG_HEADER_SIZE - 1);
+   CHECK(unpackPlotMsgHeader(buff, PLOT_MSG_HEADER_SIZE, &action, &msgSize) == E_UNPACK_BAD_SIZE);
+   buildPlotMsgHeader(buff, E_MULPITLE_PLOTS, 0);
+   CHECK(unpackPlotMsgHeader(buff, PLOT_MSG_HEADER_SIZE, &action, &msgSize) == E_UNPACK_BAD_SIZE);
+}
+
+static void testGoodMsgs()
+{
+   char buff[TEST_BUFF_SIZE];
+   PLOTTER_INT_16 yPoints[3] = {1, -2, 3};
+   PLOTTER_UINT_8 xyPoints[3][3] = {{1,2,3}, {4,5,6}, {7,8,9}}; // 1 byte X, 2 byte Y interleaved.
+   tPlotMsgView view;
+   unsigned int msgSize;
+
+   // Create 1D from the pack functions.
+   {
+      t1dPlot param;
+      param.plotName = "plot";
+      param.curveName = "curve";
+      param.numSamp = 3;
+      param.yAxisType = E_INT_16;
+      packCreate1dPlotMsg(&param, yPoints, buff);
+      msgSize = getCreatePlot1dMsgSize(&param);
+      CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_OK);
+      CHECK(view.action == E_CREATE_1D_PLOT && view.numSamp == 3 && view.sampleStartIndex == 0);
+      CHECK(strcmp(view.plotName, "plot") == 0 && strcmp(view.curveName, "curve") == 0);
+      CHECK(view.yAxisType == E_INT_16 && view.xAxisType == E_INVALID_DATA_TYPE && view.xPoints == NULL);
+      CHECK(view.yPointsSize == sizeof(yPoints) && memcmp(view.yPoints, yPoints, sizeof(yPoints)) == 0);
+   }
+
+   msgSize = buildPlotMsg(buff, E_UPDATE_2D_PLOT, 3, E_UINT_8, E_INT_16, 1, xyPoints, sizeof(xyPoints));
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_OK);
+   CHECK(view.sampleStartIndex == 5 && view.interleaved);
+   CHECK(view.xStride == 3 && view.yStride == 3 && view.yPoints == view.xPoints + 1);
+
+   // No samples.
+   msgSize = buildPlotMsg(buff, E_UPDATE_1D_PLOT, 0, E_INVALID_DATA_TYPE, E_TIME_NS_DELTA, 0, NULL, 0);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_OK);
+   CHECK(view.numSamp == 0 && view.yPointsSize == 0);
+
+   // Groups are walked with the reader, not unpackPlotMsg.
+   buildPlotMsgHeader(buff, E_MULPITLE_PLOTS, PLOT_MSG_HEADER_SIZE);
+   CHECK(unpackPlotMsg(buff, PLOT_MSG_HEADER_SIZE, &view) == E_UNPACK_BAD_ACTION);
+}
+
+static void testBadMsgs()
+{
+   char buff[TEST_BUFF_SIZE];
+   PLOTTER_INT_16 yPoints[3] = {1, -2, 3};
+   PLOTTER_UINT_64 timesNs[3] = {1000, 2000, 3000};
+   char packedTimes[3 * PLOT_MSG_VARINT_MAX_SIZE];
+   PLOTTER_UINT_64 prevTimeNs;
+   unsigned int packedSize = packPlotMsgTimeDeltas(packedTimes, timesNs, 3, 1, &prevTimeNs);
+   tPlotMsgView view;
+   unsigned int msgSize;
+   unsigned int idx;
+
+   // Header size doesn't match the message size.
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+   CHECK(unpackPlotMsg(buff, msgSize - 1, &view) == E_UNPACK_BAD_SIZE);
+   CHECK(unpackPlotMsg(buff, msgSize + 1, &view) == E_UNPACK_BAD_SIZE);
+   CHECK(unpackPlotMsg(buff, PLOT_MSG_HEADER_SIZE - 1, &view) == E_UNPACK_INCOMPLETE);
+
+   // Unterminated plot name / curve name.
+   idx = PLOT_MSG_HEADER_SIZE;
+   packPlotMsgParam(buff, &idx, "plot", 4);
+   setPlotMsgSize(buff, idx);
+   CHECK(unpackPlotMsg(buff, idx, &view) == E_UNPACK_BAD_STRING);
+   idx = PLOT_MSG_HEADER_SIZE;
+   packPlotMsgParam(buff, &idx, "plot", 5);
+   packPlotMsgParam(buff, &idx, "curve", 5);
+   setPlotMsgSize(buff, idx);
+   CHECK(unpackPlotMsg(buff, idx, &view) == E_UNPACK_BAD_STRING);
+   setPlotMsgSize(buff, PLOT_MSG_HEADER_SIZE);
+   CHECK(unpackPlotMsg(buff, PLOT_MSG_HEADER_SIZE, &view) == E_UNPACK_BAD_STRING);
+
+   // Fields cut off after the names.
+   packPlotMsgParam(buff, &idx, "", 1);
+   packPlotMsgParam(buff, &idx, "\x03\x00\x00", 3);
+   setPlotMsgSize(buff, idx);
+   CHECK(unpackPlotMsg(buff, idx, &view) == E_UNPACK_BAD_SIZE);
+
+   // Bad data types.
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 0, E_INVALID_DATA_TYPE, E_INVALID_DATA_TYPE, 0, NULL, 0);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_DATA_TYPE);
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 0, E_INVALID_DATA_TYPE, E_DATA_TYPE_END, 0, NULL, 0);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_DATA_TYPE);
+   msgSize = buildPlotMsg(buff, E_CREATE_2D_PLOT, 0, (ePlotDataTypes)99, E_INT_16, 0, NULL, 0);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_DATA_TYPE);
+   msgSize = buildPlotMsg(buff, E_CREATE_2D_PLOT, 0, E_TIME_NS_DELTA, E_INT_16, 1, NULL, 0); // Packed can't be interleaved.
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_DATA_TYPE);
+
+   // Too few / too many sample bytes.
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints) - 1);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 2, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 0xFFFFFFFF, E_INVALID_DATA_TYPE, E_INT_64, 0, yPoints, sizeof(yPoints));
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+
+   // Packed samples: good, truncated varint, missing base time, extra bytes.
+   msgSize = buildPlotMsg(buff, E_CREATE_2D_PLOT, 3, E_TIME_NS_DELTA, E_INT_16, 0, packedTimes, packedSize);
+   memcpy(buff + msgSize, yPoints, sizeof(yPoints));
+   msgSize += sizeof(yPoints);
+   setPlotMsgSize(buff, msgSize);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_OK);
+   CHECK(view.xPointsSize == packedSize && view.xStride == 0 && view.yStride == sizeof(yPoints[0]));
+   CHECK(memcmp(view.yPoints, yPoints, sizeof(yPoints)) == 0);
+
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_TIME_NS_DELTA, 0, packedTimes, packedSize);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_OK);
+   buff[msgSize - 1] |= 0x80; // Last varint doesn't end.
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_TIME_NS_DELTA, 0, packedTimes, packedSize - 1);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 1, E_INVALID_DATA_TYPE, E_TIME_NS_DELTA, 0, packedTimes, sizeof(PLOTTER_UINT_64) - 1);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+   msgSize = buildPlotMsg(buff, E_CREATE_1D_PLOT, 2, E_INVALID_DATA_TYPE, E_TIME_NS_DELTA, 0, packedTimes, packedSize);
+   CHECK(unpackPlotMsg(buff, msgSize, &view) == E_UNPACK_BAD_SIZE);
+}
+
+static void testReader()
+{
+   char buff[TEST_BUFF_SIZE];
+   PLOTTER_INT_16 yPoints[3] = {1, -2, 3};
+   tPlotMsgReader reader;
+   tPlotMsgView view;
+   unsigned int msgSize;
+   unsigned int idx;
+   unsigned int depth;
+
+   // Group of 2 messages followed by a message that is cut off.
+   idx = buildPlotMsgHeader(buff, E_MULPITLE_PLOTS, 0);
+   idx += buildPlotMsg(buff + idx, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+   idx += buildPlotMsg(buff + idx, E_UPDATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+   setPlotMsgSize(buff, idx);
+   msgSize = buildPlotMsg(buff + idx, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+   plotMsgReaderInit(&reader, buff, idx + msgSize - 1);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_OK && view.action == E_CREATE_1D_PLOT);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_OK && view.action == E_UPDATE_1D_PLOT);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_INCOMPLETE && reader.idx == idx);
+   CHECK(reader.numGroups == 1 && reader.groupDepth == 0);
+
+   // Nested group bigger than the group it is in.
+   idx = buildPlotMsgHeader(buff, E_MULPITLE_PLOTS, 0);
+   idx += buildPlotMsgHeader(buff + idx, E_MULPITLE_PLOTS, PLOT_MSG_HEADER_SIZE + 1);
+   setPlotMsgSize(buff, idx);
+   buff[idx++] = 0;
+   plotMsgReaderInit(&reader, buff, idx);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_BAD_SIZE);
+
+   // Partial message inside of a group.
+   idx = buildPlotMsgHeader(buff, E_MULPITLE_PLOTS, 0);
+   msgSize = buildPlotMsg(buff + idx, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+   setPlotMsgSize(buff, idx + msgSize - 1);
+   plotMsgReaderInit(&reader, buff, idx + msgSize);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_BAD_SIZE);
+   setPlotMsgSize(buff, idx + PLOT_MSG_HEADER_SIZE - 1);
+   plotMsgReaderInit(&reader, buff, idx + msgSize);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_BAD_SIZE);
+
+   // Bad message inside of a group.
+   setPlotMsgSize(buff, idx + msgSize);
+   setPlotMsgSize(buff + idx, msgSize - 1);
+   plotMsgReaderInit(&reader, buff, idx + msgSize);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_BAD_SIZE);
+
+   // PLOT_MSG_MAX_GROUP_DEPTH groups in groups is OK, 1 more is too deep.
+   for(depth = PLOT_MSG_MAX_GROUP_DEPTH; depth <= PLOT_MSG_MAX_GROUP_DEPTH + 1; ++depth)
+   {
+      unsigned int groupIndex;
+      msgSize = buildPlotMsg(buff + depth * PLOT_MSG_HEADER_SIZE, E_CREATE_1D_PLOT, 3, E_INVALID_DATA_TYPE, E_INT_16, 0, yPoints, sizeof(yPoints));
+      for(groupIndex = 0; groupIndex < depth; ++groupIndex)
+      {
+         buildPlotMsgHeader(buff + groupIndex * PLOT_MSG_HEADER_SIZE, E_MULPITLE_PLOTS, (depth - groupIndex) * PLOT_MSG_HEADER_SIZE + msgSize);
+      }
+      plotMsgReaderInit(&reader, buff, depth * PLOT_MSG_HEADER_SIZE + msgSize);
+      if(depth <= PLOT_MSG_MAX_GROUP_DEPTH)
+      {
+         CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_OK && reader.numGroups == depth);
+         CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_INCOMPLETE && reader.groupDepth == 0);
+      }
+      else
+      {
+         CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_GROUP_TOO_DEEP);
+      }
+   }
+
+   // Bad action at the top level.
+   buildPlotMsgHeader(buff, E_INVALID_PLOT_ACTION, PLOT_MSG_HEADER_SIZE);
+   plotMsgReaderInit(&reader, buff, PLOT_MSG_HEADER_SIZE);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_BAD_ACTION);
+
+   // Empty buffer.
+   plotMsgReaderInit(&reader, buff, 0);
+   CHECK(plotMsgReaderNext(&reader, &view) == E_UNPACK_INCOMPLETE);
+}
+
+// Packs timesNs as E_TIME_NS_DELTA samples in one piece, then in pieces of pieceSize
+// samples (like the pieces of a wrapped ring buffer), and checks both unpack to timesNs.
+static void checkTimeDeltasRoundTrip(const PLOTTER_UINT_64* timesNs, unsigned int numSamp, unsigned int pieceSize, int line)
+{
+   char packed[TEST_BUFF_SIZE];
+   char packedPieces[TEST_BUFF_SIZE];
+   PLOTTER_UINT_64 unpacked[16];
+   PLOTTER_UINT_64 prevTimeNs = 0;
+   unsigned int packedSize = packPlotMsgTimeDeltas(packed, timesNs, numSamp, 1, &prevTimeNs);
+   unsigned int piecesSize = 0;
+   unsigned int sampIndex;
+   unsigned int samplesSize = 0;
+
+   checkResult(prevTimeNs == timesNs[numSamp - 1], "prevTimeNs is the last sample", line);
+   checkResult(packedSize <= getPlotMsgSamplesMaxSize(E_TIME_NS_DELTA, numSamp), "packed size <= max size", line);
+   checkResult(getPlotMsgSamplesSize(packed, packedSize, numSamp, E_TIME_NS_DELTA, &samplesSize) && samplesSize == packedSize, "samples size == packed size", line);
+
+   memset(unpacked, 0, sizeof(unpacked));
+   unpackPlotMsgTimeDeltas(packed, packedSize, numSamp, unpacked);
+   checkResult(memcmp(unpacked, timesNs, numSamp * sizeof(timesNs[0])) == 0, "unpacked == timesNs", line);
+
+   for(sampIndex = 0; sampIndex < numSamp; sampIndex += pieceSize)
+   {
+      unsigned int numPieceSamp = numSamp - sampIndex < pieceSize ? numSamp - sampIndex : pieceSize;
+      piecesSize += packPlotMsgTimeDeltas(packedPieces + piecesSize, timesNs + sampIndex, numPieceSamp, sampIndex == 0, &prevTimeNs);
+   }
+   piecesSize += packPlotMsgTimeDeltas(packedPieces + piecesSize, timesNs, 0, 0, &prevTimeNs); // Empty piece adds nothing.
+   checkResult(piecesSize == packedSize && memcmp(packedPieces, packed, packedSize) == 0, "pieces == one piece", line);
+}
+
+#define CHECK_TIME_DELTAS(timesNs, pieceSize) checkTimeDeltasRoundTrip(timesNs, sizeof(timesNs) / sizeof(timesNs[0]), pieceSize, __LINE__)
+
+static void testTimeDeltas()
+{
+   PLOTTER_UINT_64 oneSamp[1] = {0x123456789ABCDEF0ull};
+   PLOTTER_UINT_64 increasing[6] = {1000000, 2000000, 3000001, 3000001, 4000000, 0x7FFFFFFFFFFFFFFFull};
+   PLOTTER_UINT_64 negative[5] = {5000, 1000, 3000, 0, 1};
+   PLOTTER_UINT_64 huge[7] = {0, 0x8000000000000000ull, 0x8000000000000001ull, 0xFFFFFFFFFFFFFFFFull, 0, 0xFFFFFFFFFFFFFFFFull, 1};
+   char packed[TEST_BUFF_SIZE];
+   PLOTTER_UINT_64 prevTimeNs = 0;
+   unsigned int samplesSize;
+   unsigned int pieceSize;
+
+   CHECK_TIME_DELTAS(oneSamp, 1);
+   CHECK(packPlotMsgTimeDeltas(packed, oneSamp, 1, 1, &prevTimeNs) == sizeof(PLOTTER_UINT_64));
+   for(pieceSize = 1; pieceSize <= 4; ++pieceSize)
+   {
+      CHECK_TIME_DELTAS(increasing, pieceSize);
+      CHECK_TIME_DELTAS(negative, pieceSize);
+      CHECK_TIME_DELTAS(huge, pieceSize);
+   }
+
+   // Small deltas, either way, take 1 byte (zigzag: -1 -> 1, +1 -> 2).
+   CHECK(packPlotMsgTimeDeltas(packed, negative + 3, 2, 1, &prevTimeNs) == sizeof(PLOTTER_UINT_64) + 1);
+   CHECK(packPlotMsgTimeDeltas(packed, negative + 3, 1, 0, &prevTimeNs) == 1 && (unsigned char)packed[0] == 1);
+   CHECK(packPlotMsgTimeDeltas(packed, negative + 4, 1, 0, &prevTimeNs) == 1 && (unsigned char)packed[0] == 2);
+
+   // Deltas of 2^63 or more take the max size.
+   CHECK(packPlotMsgTimeDeltas(packed, huge, 2, 1, &prevTimeNs) == sizeof(PLOTTER_UINT_64) + PLOT_MSG_VARINT_MAX_SIZE);
+   CHECK(getPlotMsgSamplesSize(packed, sizeof(PLOTTER_UINT_64) + PLOT_MSG_VARINT_MAX_SIZE, 2, E_TIME_NS_DELTA, &samplesSize));
+   CHECK(!getPlotMsgSamplesSize(packed, sizeof(PLOTTER_UINT_64) + PLOT_MSG_VARINT_MAX_SIZE - 1, 2, E_TIME_NS_DELTA, &samplesSize));
+}
+
+int main()
+{
+   testHeader();
+   testGoodMsgs();
+   testBadMsgs();
+   testReader();
+   testTimeDeltas();
+
+   printf("%d of %d checks passed\n", g_numChecks - g_numFailures, g_numChecks);
+   return g_numFailures == 0 ? 0 : 1;
+}
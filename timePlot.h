@@ -27,6 +27,16 @@
 
 #include "smartPlotMessage.h"
 
+// Thread local storage (same as PLOT_THREAD_LOCAL, this header doesn't include plotThreading.h).
+#ifndef TIME_PLOT_THREAD_LOCAL
+   #if defined _MSC_VER
+      #define TIME_PLOT_THREAD_LOCAL __declspec(thread)
+   #elif defined __cplusplus && __cplusplus >= 201103L
+      #define TIME_PLOT_THREAD_LOCAL thread_local
+   #else
+      #define TIME_PLOT_THREAD_LOCAL __thread
+   #endif
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +47,8 @@ Function:     timePlot_1D
 
 Description:  Adds a plot point with the current time as the Y Axis point.
               Time is Monotonic / Steady Clock time (i.e. time since boot).
+              The time is stored as E_TIME_STRUCT_AUTO, or as E_TIME_NS_DELTA
+              when the library is built with PLOTTER_COMPACT_TIME_PLOT.
 
               See smartPlot_1D Description in smartPlotMessage.h for more
               info about the input parameters.
@@ -78,9 +90,199 @@ void timePlot_2D_Int(
    const char* plotName,
    const char* curveName);
 
+/**************************************************************************
+Function:     timePlot_2D_batch
+
+Description:  Adds inDataSize plot points that all have the current time as
+              their X Axis point, with the values passed in as the Y Axis
+              points. The clock is read once and the points are written to
+              the curve in one go.
+
+              See smartPlot_2D Description in smartPlotMessage.h for more
+              info about the input parameters.
+*/
+void timePlot_2D_batch(
+   const void* inDataToPlotY,
+   ePlotDataTypes inDataTypeY,
+   int inDataSize,
+   int plotSize,
+   int updateSize,
+   const char* plotName,
+   const char* curveName);
+
+/**************************************************************************
+Function:     timePlot_getTimestamp
+
+Description:  Reads the time the same way the timePlot functions do. When the
+              fast clock is enabled (see smartPlot_enableFastClock) this is a
+              raw Time Stamp Counter value, which is only converted to
+              Monotonic time when it is sent, so only pass these times to
+              timePlot_2D_batchTimes. Use smartPlot_getTime for times that are
+              used for anything else.
+
+Arguments:    pTime (Out) - Pointer to the time struct that will be filled in.
+
+Returns:      None.
+*/
+void timePlot_getTimestamp(tSmartPlotTime* pTime);
+
+/**************************************************************************
+Function:     timePlot_2D_batchTimes
+
+Description:  Adds inDataSize plot points, with the times passed in as the X
+              Axis points (from timePlot_getTimestamp or smartPlot_getTime)
+              and the values passed in as the Y Axis points. The points are
+              written to the curve in one go.
+
+              See smartPlot_2D Description in smartPlotMessage.h for more
+              info about the input parameters.
+*/
+void timePlot_2D_batchTimes(
+   const tSmartPlotTime* inTimes,
+   const void* inDataToPlotY,
+   ePlotDataTypes inDataTypeY,
+   int inDataSize,
+   int plotSize,
+   int updateSize,
+   const char* plotName,
+   const char* curveName);
+
+/**************************************************************************
+Function:     timePlot_getDurationCurve
+
+Description:  Gets a handle to a curve of durations, for timing code sections
+              with timePlot_duration (or the TIME_PLOT_SCOPE macros below).
+              Durations are plotted in seconds (E_FLOAT_64).
+
+Arguments:    plotSize - The number of data points in the entire GUI plot.
+              Ignored if the curve already exists (see smartPlot_getCurve1D).
+
+              plotName - The Plot Name.
+
+              curveName - The Curve Name.
+
+              perThread - If non-zero, each thread gets its own curve. The
+              thread's index (in order of first use) is appended to the Curve
+              Name, e.g. "Process [T2]". The handle must then only be used on
+              the thread that got it.
+
+Returns:      The curve handle. NULL if the curve could not be created (e.g. it
+              already exists and isn't a E_FLOAT_64 1D curve).
+*/
+tSmartPlotCurve timePlot_getDurationCurve(int plotSize, const char* plotName, const char* curveName, int perThread);
+
+/**************************************************************************
+Function:     timePlot_duration
+
+Description:  Adds the time since startTime (read with smartPlot_getTime) to a
+              duration curve. Besides the clock read, this is a single write
+              to the curve's circular buffer (there is no Plot Name / Curve
+              Name lookup).
+
+Arguments:    curve - Handle from timePlot_getDurationCurve. Nothing is plotted
+              if this is NULL.
+
+              startTime - Time the code section started.
+
+              updateSize - See smartPlot_1D. Use -1 to leave sending the
+              durations to the flush thread.
+
+Returns:      None.
+*/
+void timePlot_duration(tSmartPlotCurve curve, const tSmartPlotTime* startTime, int updateSize);
+
 #ifdef __cplusplus
 }
 #endif
 
+//*****************************************************************************
+// Scoped Timers
+//*****************************************************************************
+// Time a code section and plot its duration. The curve is looked up the first time
+// each call site runs (once per thread) and cached, after that a timer costs two clock
+// reads and a write to the curve's circular buffer. Timers can be nested. Define
+// PLOTTER_DISABLE_SCOPED_TIMERS to compile them out.
+//
+// C:
+//    TIME_PLOT_SCOPE_START(process);
+//    ...
+//    TIME_PLOT_SCOPE_END(process, 1000, -1, "Timing", "Process");
+//
+// C++ (the duration is plotted when the scope exits):
+//    {
+//       TIME_PLOT_SCOPE(1000, -1, "Timing", "Process");
+//       ...
+//    }
+//
+// The _PER_THREAD versions plot to a separate curve for each thread.
+
+#define TIME_PLOT_CONCAT_INNER(a, b) a##b
+#define TIME_PLOT_CONCAT(a, b) TIME_PLOT_CONCAT_INNER(a, b)
+
+#ifndef PLOTTER_DISABLE_SCOPED_TIMERS
+
+#define TIME_PLOT_SCOPE_START(timerName) \
+   tSmartPlotTime timerName##_timePlotStart; \
+   smartPlot_getTime(&timerName##_timePlotStart)
+
+#define TIME_PLOT_SCOPE_END_IMPL(timerName, plotSize, updateSize, plotName, curveName, perThread) \
+   do { \
+      static TIME_PLOT_THREAD_LOCAL tSmartPlotCurve timePlot_scopeCurve = NULL; \
+      if(timePlot_scopeCurve == NULL) \
+         timePlot_scopeCurve = timePlot_getDurationCurve(plotSize, plotName, curveName, perThread); \
+      timePlot_duration(timePlot_scopeCurve, &timerName##_timePlotStart, updateSize); \
+   } while(0)
+
+#define TIME_PLOT_SCOPE_END(timerName, plotSize, updateSize, plotName, curveName) \
+   TIME_PLOT_SCOPE_END_IMPL(timerName, plotSize, updateSize, plotName, curveName, 0)
+#define TIME_PLOT_SCOPE_END_PER_THREAD(timerName, plotSize, updateSize, plotName, curveName) \
+   TIME_PLOT_SCOPE_END_IMPL(timerName, plotSize, updateSize, plotName, curveName, 1)
+
+#ifdef __cplusplus
+class ScopedPlotTimer
+{
+public:
+   ScopedPlotTimer(tSmartPlotCurve curve, int updateSize = -1) :
+      m_curve(curve),
+      m_updateSize(updateSize)
+   {
+      smartPlot_getTime(&m_startTime);
+   }
+
+   ~ScopedPlotTimer()
+   {
+      timePlot_duration(m_curve, &m_startTime, m_updateSize);
+   }
+
+private:
+   ScopedPlotTimer(const ScopedPlotTimer&);
+   ScopedPlotTimer& operator=(const ScopedPlotTimer&);
+
+   tSmartPlotCurve m_curve;
+   int m_updateSize;
+   tSmartPlotTime m_startTime;
+};
+
+#define TIME_PLOT_SCOPE_IMPL(plotSize, updateSize, plotName, curveName, perThread) \
+   static TIME_PLOT_THREAD_LOCAL tSmartPlotCurve TIME_PLOT_CONCAT(timePlot_scopeCurve_, __LINE__) = \
+      timePlot_getDurationCurve(plotSize, plotName, curveName, perThread); \
+   ScopedPlotTimer TIME_PLOT_CONCAT(timePlot_scopeTimer_, __LINE__)(TIME_PLOT_CONCAT(timePlot_scopeCurve_, __LINE__), updateSize)
+
+#define TIME_PLOT_SCOPE(plotSize, updateSize, plotName, curveName) \
+   TIME_PLOT_SCOPE_IMPL(plotSize, updateSize, plotName, curveName, 0)
+#define TIME_PLOT_SCOPE_PER_THREAD(plotSize, updateSize, plotName, curveName) \
+   TIME_PLOT_SCOPE_IMPL(plotSize, updateSize, plotName, curveName, 1)
+#endif
+
+#else // PLOTTER_DISABLE_SCOPED_TIMERS
+
+#define TIME_PLOT_SCOPE_START(timerName) do {} while(0)
+#define TIME_PLOT_SCOPE_END(timerName, plotSize, updateSize, plotName, curveName) do {} while(0)
+#define TIME_PLOT_SCOPE_END_PER_THREAD(timerName, plotSize, updateSize, plotName, curveName) do {} while(0)
+#define TIME_PLOT_SCOPE(plotSize, updateSize, plotName, curveName) do {} while(0)
+#define TIME_PLOT_SCOPE_PER_THREAD(plotSize, updateSize, plotName, curveName) do {} while(0)
+
+#endif // PLOTTER_DISABLE_SCOPED_TIMERS
+
 
 #endif /* TIMEPLOT_H_ */